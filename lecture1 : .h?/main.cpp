@@ -1,7 +1,19 @@
 #include "tools.hpp"
+#include <iostream>
 
 int main()  {
     rain();
     shine();
+
+    // A minute of temperature readings, one per second, summarised over 10 s and 1 min
+    WeatherStation station({10000, 60000});
+    for (int second = 0; second < 60; ++second)
+        station.ingest({second * 1000, Measure::Temperature, 15 + (second % 20) * 0.1});
+    station.drain();
+    for (std::size_t window = 0; window < station.windowLengths().size(); ++window) {
+        const WindowStats t = station.stats(Measure::Temperature, window);
+        std::cout << "Last " << station.windowLengths()[window] / 1000 << " s: " << t.count << " readings, mean "
+                  << t.mean << ", min " << t.min << ", max " << t.max << std::endl;
+    }
     return 0;
-}
\ No newline at end of file
+}
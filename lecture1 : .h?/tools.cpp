@@ -1,5 +1,10 @@
 #include "tools.hpp"
+#include <algorithm>
 #include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
 
 void rain()
 {
@@ -9,4 +14,202 @@ void rain()
 void shine()
 {
     std::cout << "It's shining!" << std::endl;
-}
\ No newline at end of file
+}
+
+ReadingQueue::ReadingQueue(std::size_t capacity)
+{
+    if (capacity == 0 || (capacity & (capacity - 1)) != 0)
+        throw std::invalid_argument("ReadingQueue: capacity must be a power of two, not " + std::to_string(capacity));
+    cells_ = std::make_unique<Cell[]>(capacity);
+    mask_ = capacity - 1;
+    for (std::size_t i = 0; i < capacity; ++i)
+        cells_[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+bool ReadingQueue::tryPush(const Reading &reading)
+{
+    std::size_t position = pushPosition_.load(std::memory_order_relaxed);
+    Cell *cell;
+    for (;;)
+    {
+        cell = &cells_[position & mask_];
+        const std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        const auto diff = static_cast<std::ptrdiff_t>(sequence - position);
+        if (diff == 0)
+        {
+            // The cell is free for this position; claim it
+            if (pushPosition_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0)
+            return false; // the cell still holds a reading from one lap ago
+        else
+            position = pushPosition_.load(std::memory_order_relaxed); // another producer got there first
+    }
+    cell->reading = reading;
+    cell->sequence.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+bool ReadingQueue::tryPop(Reading &reading)
+{
+    // Only one consumer, so the position needs no compare-and-swap
+    const std::size_t position = popPosition_.load(std::memory_order_relaxed);
+    Cell &cell = cells_[position & mask_];
+    if (cell.sequence.load(std::memory_order_acquire) != position + 1)
+        return false; // nothing pushed at this position yet, or the push is not finished
+    reading = cell.reading;
+    // Free the cell for the push one lap later
+    cell.sequence.store(position + mask_ + 1, std::memory_order_release);
+    popPosition_.store(position + 1, std::memory_order_relaxed);
+    return true;
+}
+
+void RollingWindows::SampleRing::grow()
+{
+    std::vector<Sample> grown(std::max<std::size_t>(16, 2 * samples_.size()));
+    const std::size_t mask = grown.size() - 1;
+    for (std::size_t position = begin_; position != end_; ++position)
+        grown[position & mask] = (*this)[position];
+    samples_ = std::move(grown);
+    mask_ = mask;
+}
+
+RollingWindows::RollingWindows(const std::vector<std::int64_t> &lengthsMs)
+    : newest_(std::numeric_limits<std::int64_t>::min())
+{
+    for (std::int64_t length : lengthsMs)
+    {
+        if (length <= 0)
+            throw std::invalid_argument("RollingWindows: length must be positive, not " + std::to_string(length));
+        windows_.push_back(Window{length});
+    }
+}
+
+void RollingWindows::add(std::int64_t timestampMs, double value)
+{
+    // Late readings count as arriving now, which keeps every ring in timestamp order
+    const bool later = timestampMs > newest_;
+    if (later)
+        newest_ = timestampMs;
+    const Sample sample{newest_, value};
+
+    samples_.push_back(sample);
+    // A sample that is no smaller than a newer one can never be the minimum again
+    while (!minimums_.empty() && minimums_.back().value >= value)
+        minimums_.pop_back();
+    minimums_.push_back(sample);
+    while (!maximums_.empty() && maximums_.back().value <= value)
+        maximums_.pop_back();
+    maximums_.push_back(sample);
+
+    // If a window's minimum was just removed, every later candidate was too, and the new
+    // sample is now the smallest in the window
+    const std::size_t minimum = minimums_.end() - 1, maximum = maximums_.end() - 1;
+    for (Window &window : windows_)
+    {
+        window.sum += value;
+        window.minimum = std::min(window.minimum, minimum);
+        window.maximum = std::min(window.maximum, maximum);
+    }
+    // Samples only leave the windows when time moves on
+    if (later)
+        expire();
+}
+
+void RollingWindows::advance(std::int64_t nowMs)
+{
+    if (nowMs > newest_)
+    {
+        newest_ = nowMs;
+        expire();
+    }
+}
+
+void RollingWindows::expire()
+{
+    const std::size_t sampleEnd = samples_.end(), minimumEnd = minimums_.end(), maximumEnd = maximums_.end();
+    std::size_t keepSample = sampleEnd, keepMinimum = minimumEnd, keepMaximum = maximumEnd;
+    for (Window &window : windows_)
+    {
+        const std::int64_t oldest = newest_ - window.lengthMs; // samples at or before this are out
+        std::size_t first = window.first;
+        while (first != sampleEnd && samples_[first].timestampMs <= oldest)
+            window.sum -= samples_[first++].value;
+        window.first = first;
+        while (window.minimum != minimumEnd && minimums_[window.minimum].timestampMs <= oldest)
+            ++window.minimum;
+        while (window.maximum != maximumEnd && maximums_[window.maximum].timestampMs <= oldest)
+            ++window.maximum;
+        // Start the running sum afresh whenever the window empties, so rounding errors from
+        // adding and subtracting do not build up forever
+        if (first == sampleEnd)
+            window.sum = 0;
+
+        keepSample = std::min(keepSample, first);
+        keepMinimum = std::min(keepMinimum, window.minimum);
+        keepMaximum = std::min(keepMaximum, window.maximum);
+    }
+    // What no window needs any more
+    samples_.dropBefore(keepSample);
+    minimums_.dropBefore(keepMinimum);
+    maximums_.dropBefore(keepMaximum);
+}
+
+WindowStats RollingWindows::stats(std::size_t window) const
+{
+    if (window >= windows_.size())
+        throw std::out_of_range("RollingWindows: no window " + std::to_string(window));
+    const Window &w = windows_[window];
+    WindowStats stats;
+    stats.count = samples_.end() - w.first;
+    if (stats.count != 0)
+    {
+        stats.mean = w.sum / static_cast<double>(stats.count);
+        stats.min = minimums_[w.minimum].value;
+        stats.max = maximums_[w.maximum].value;
+    }
+    return stats;
+}
+
+WeatherStation::WeatherStation(std::vector<std::int64_t> windowLengthsMs, std::size_t queueCapacity)
+    : queue_(queueCapacity), windowLengths_(std::move(windowLengthsMs)),
+      windows_(measureCount, RollingWindows(windowLengths_))
+{
+    if (windowLengths_.empty())
+        throw std::invalid_argument("WeatherStation: no window lengths");
+}
+
+std::size_t WeatherStation::drain()
+{
+    std::size_t drained = 0;
+    Reading reading;
+    while (queue_.tryPop(reading))
+    {
+        record(reading);
+        ++drained;
+    }
+    return drained;
+}
+
+void WeatherStation::record(const Reading &reading)
+{
+    const auto measure = static_cast<std::size_t>(reading.measure);
+    if (measure >= measureCount)
+        throw std::invalid_argument("WeatherStation: unknown measure " + std::to_string(measure));
+    windows_[measure].add(reading.timestampMs, reading.value);
+}
+
+void WeatherStation::advance(std::int64_t nowMs)
+{
+    for (RollingWindows &windows : windows_)
+        windows.advance(nowMs);
+}
+
+WindowStats WeatherStation::stats(Measure measure, std::size_t window) const
+{
+    const auto index = static_cast<std::size_t>(measure);
+    if (index >= measureCount)
+        throw std::out_of_range("WeatherStation: unknown measure " + std::to_string(index));
+    return windows_[index].stats(window);
+}
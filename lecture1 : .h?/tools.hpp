@@ -1,5 +1,181 @@
 #pragma once
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
 void rain();
 
-void shine();
\ No newline at end of file
+void shine();
+
+// Weather telemetry: readings go in through a lock-free queue and come out as rolling
+// statistics over several window lengths at once
+//
+//     WeatherStation station({1000, 60000, 3600000});   // 1 s, 1 min and 1 h windows
+//     station.ingest({nowMs, Measure::Rain, 0.4});       // from any thread
+//     station.drain();                                   // one thread: update the windows
+//     WindowStats lastMinute = station.stats(Measure::Rain, 1);
+//
+// Each measure keeps its own windows. A window covers (newest - length, newest], where newest
+// is the latest timestamp it has seen; a reading older than that is counted as arriving at
+// newest, so readings from several producers that interleave slightly out of order are still
+// counted. Adding a reading is O(1) amortized per window: a running sum for the mean, and
+// monotonic deques for the minimum and maximum.
+
+enum class Measure : std::uint8_t
+{
+    Rain,       // mm
+    Sun,        // minutes of sunshine
+    Temperature // degrees Celsius
+};
+
+inline constexpr std::size_t measureCount = 3;
+
+struct Reading
+{
+    std::int64_t timestampMs = 0;
+    Measure measure = Measure::Rain;
+    double value = 0;
+};
+
+// Mean, min and max are only meaningful when count > 0
+struct WindowStats
+{
+    std::size_t count = 0;
+    double mean = 0;
+    double min = 0;
+    double max = 0;
+};
+
+// Bounded queue of readings from any number of producer threads to one consumer, without
+// locks: each cell carries a sequence number that tells whether it is free for the next push
+// or holds the next pop (Dmitry Vyukov's bounded queue, with a single consumer)
+class ReadingQueue
+{
+public:
+    // capacity must be a power of two (std::invalid_argument otherwise)
+    explicit ReadingQueue(std::size_t capacity);
+
+    // Any thread; false if the queue is full
+    bool tryPush(const Reading &reading);
+    // One thread at a time; false if the queue is empty
+    bool tryPop(Reading &reading);
+
+    std::size_t capacity() const { return mask_ + 1; }
+
+private:
+    struct Cell
+    {
+        std::atomic<std::size_t> sequence;
+        Reading reading;
+    };
+
+    std::unique_ptr<Cell[]> cells_;
+    std::size_t mask_;
+    // Producers and consumers each get their own cache line
+    alignas(64) std::atomic<std::size_t> pushPosition_{0};
+    alignas(64) std::atomic<std::size_t> popPosition_{0};
+};
+
+// Statistics of one measure over several window lengths: each window covers the values added
+// during its last lengthMs milliseconds. Every window shares one log of samples and one
+// monotonic deque each for the minimum and maximum, since the candidates of a shorter window
+// are a suffix of those of a longer one; a window only keeps its running sum and where it
+// starts in each. Memory grows with the number of readings in the longest window.
+class RollingWindows
+{
+public:
+    // Every length must be positive (std::invalid_argument otherwise)
+    explicit RollingWindows(const std::vector<std::int64_t> &lengthsMs);
+
+    void add(std::int64_t timestampMs, double value);
+    // Drops the samples that have left the windows by nowMs, without adding one
+    void advance(std::int64_t nowMs);
+
+    // std::out_of_range for a bad index
+    WindowStats stats(std::size_t window) const;
+    std::size_t size() const { return windows_.size(); }
+
+private:
+    struct Sample
+    {
+        std::int64_t timestampMs;
+        double value;
+    };
+
+    // Growable ring of samples addressed by positions that only ever increase, so a position
+    // stays valid while the ring grows and while samples are removed from either end
+    class SampleRing
+    {
+    public:
+        std::size_t begin() const { return begin_; }
+        std::size_t end() const { return end_; }
+        bool empty() const { return begin_ == end_; }
+        const Sample &operator[](std::size_t position) const { return samples_[position & mask_]; }
+        const Sample &back() const { return (*this)[end_ - 1]; }
+
+        void push_back(const Sample &sample)
+        {
+            if (end_ - begin_ == samples_.size())
+                grow();
+            samples_[end_++ & mask_] = sample;
+        }
+        void pop_back() { --end_; }
+        void dropBefore(std::size_t position) { begin_ = position; }
+
+    private:
+        void grow();
+
+        std::vector<Sample> samples_;
+        std::size_t mask_ = 0;
+        std::size_t begin_ = 0;
+        std::size_t end_ = 0;
+    };
+
+    struct Window
+    {
+        std::int64_t lengthMs;
+        std::size_t first = 0;   // first sample in the window
+        std::size_t minimum = 0; // position of the minimum in minimums_
+        std::size_t maximum = 0; // position of the maximum in maximums_
+        double sum = 0;
+    };
+
+    void expire();
+
+    std::vector<Window> windows_;
+    std::int64_t newest_;
+    SampleRing samples_;  // oldest first
+    SampleRing minimums_; // values increasing: a window's minimum is its first entry in it
+    SampleRing maximums_; // values decreasing
+};
+
+class WeatherStation
+{
+public:
+    // One rolling window per length for every measure; queueCapacity must be a power of two
+    explicit WeatherStation(std::vector<std::int64_t> windowLengthsMs, std::size_t queueCapacity = 1 << 16);
+
+    // Queues a reading; safe from any number of threads. false if the queue is full (call
+    // drain() more often or use a larger queue)
+    bool ingest(const Reading &reading) { return queue_.tryPush(reading); }
+    // Moves every queued reading into the windows and returns how many there were. Only one
+    // thread may drain at a time, and not while another calls stats() or record().
+    std::size_t drain();
+
+    // Updates the windows directly, bypassing the queue (single-threaded use)
+    void record(const Reading &reading);
+    // Expires old samples in every window when no readings arrive
+    void advance(std::int64_t nowMs);
+
+    // Statistics of one measure over windowLengthsMs[window]; std::out_of_range for a bad index
+    WindowStats stats(Measure measure, std::size_t window) const;
+    const std::vector<std::int64_t> &windowLengths() const { return windowLengths_; }
+
+private:
+    ReadingQueue queue_;
+    std::vector<std::int64_t> windowLengths_;
+    std::vector<RollingWindows> windows_; // one per measure
+};
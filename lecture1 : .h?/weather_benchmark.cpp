@@ -0,0 +1,187 @@
+#include "tools.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Throughput of WeatherStation, and a check of its rolling statistics
+//
+//   weather_benchmark [--events=N] [--producers=N]
+//
+// --events (default 10M) readings arrive 10 us apart, cycling through rain, sun and
+// temperature, and are aggregated over 1 s, 5 s and 30 s windows. Three runs:
+//   record            windows updated directly on one thread
+//   ingest + drain    through the queue, producing and draining on the same thread
+//   N producers       --producers threads (default 4) ingest while the main thread drains
+// The target is 10M events/s on one core. The statistics must match a recomputation from
+// the raw readings, and with several producers every reading must be counted.
+
+namespace
+{
+    const std::vector<std::int64_t> windowLengths = {1000, 5000, 30000};
+
+    // Resembles real telemetry: temperature drifts, rain comes in showers, and the sun either
+    // shines for the whole reading or not
+    std::vector<Reading> makeReadings(std::size_t count)
+    {
+        std::mt19937 rng(42);
+        std::normal_distribution<double> drift(0, 0.02);
+        std::exponential_distribution<double> rainfall(4);
+        double temperature = 12;
+        bool showering = false, sunny = true;
+        std::vector<Reading> readings(count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            Reading &r = readings[i];
+            r.timestampMs = static_cast<std::int64_t>(i / 100);
+            r.measure = static_cast<Measure>(i % measureCount);
+            if (r.measure == Measure::Rain)
+            {
+                if (rng() % 5000 == 0)
+                    showering = !showering;
+                r.value = showering ? rainfall(rng) : 0;
+            }
+            else if (r.measure == Measure::Sun)
+            {
+                if (rng() % 2000 == 0)
+                    sunny = !sunny;
+                r.value = sunny ? 1 : 0;
+            }
+            else
+                r.value = temperature += drift(rng);
+        }
+        return readings;
+    }
+
+    // The statistics of one window after readings[0, end), computed from scratch
+    WindowStats recompute(const std::vector<Reading> &readings, std::size_t end, Measure measure, std::int64_t lengthMs)
+    {
+        const std::int64_t newest = readings[end - 1].timestampMs;
+        WindowStats stats;
+        double sum = 0;
+        for (std::size_t i = end; i-- > 0 && readings[i].timestampMs > newest - lengthMs;)
+        {
+            if (readings[i].measure != measure)
+                continue;
+            const double value = readings[i].value;
+            stats.min = stats.count == 0 ? value : std::min(stats.min, value);
+            stats.max = stats.count == 0 ? value : std::max(stats.max, value);
+            sum += value;
+            ++stats.count;
+        }
+        if (stats.count != 0)
+            stats.mean = sum / static_cast<double>(stats.count);
+        return stats;
+    }
+
+    bool close(const WindowStats &a, const WindowStats &b)
+    {
+        return a.count == b.count && a.min == b.min && a.max == b.max &&
+               std::abs(a.mean - b.mean) <= 1e-9 * std::max(1.0, std::abs(b.mean));
+    }
+
+    double secondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void printRate(const char *name, std::size_t events, double seconds)
+    {
+        const double rate = static_cast<double>(events) / seconds;
+        std::printf("%-28s %12.1f %10.1f  %s\n", name, rate / 1e6, seconds * 1e9 / static_cast<double>(events),
+                    rate >= 10e6 ? "" : "(below 10M/s)");
+    }
+}
+
+int main(int argc, char **argv)
+{
+    std::size_t eventCount = 10000000;
+    unsigned producers = 4;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strncmp(argv[i], "--events=", 9) == 0)
+            eventCount = std::max<std::size_t>(1000, std::strtoull(argv[i] + 9, nullptr, 10));
+        else if (std::strncmp(argv[i], "--producers=", 12) == 0)
+            producers = static_cast<unsigned>(std::clamp<unsigned long>(std::strtoul(argv[i] + 12, nullptr, 10), 1, 64));
+    }
+
+    const std::vector<Reading> readings = makeReadings(eventCount);
+    bool same = true;
+    std::printf("%zu events, windows of 1 s, 5 s and 30 s\n%-28s %12s %10s\n", eventCount, "run", "M events/s",
+                "ns/event");
+
+    // Checked against a recomputation at a few points along the way
+    {
+        WeatherStation station(windowLengths);
+        const std::size_t checkEvery = eventCount / 4;
+        double seconds = 0;
+        for (std::size_t first = 0; first < eventCount; first += checkEvery)
+        {
+            const std::size_t end = std::min(eventCount, first + checkEvery);
+            const auto start = std::chrono::steady_clock::now();
+            for (std::size_t i = first; i < end; ++i)
+                station.record(readings[i]);
+            seconds += secondsSince(start);
+
+            for (std::size_t m = 0; m < measureCount; ++m)
+                for (std::size_t w = 0; w < windowLengths.size(); ++w)
+                    same = same && close(station.stats(static_cast<Measure>(m), w),
+                                         recompute(readings, end, static_cast<Measure>(m), windowLengths[w]));
+        }
+        printRate("record", eventCount, seconds);
+    }
+
+    // The queue drained every 1024 readings, as an event loop might
+    {
+        WeatherStation station(windowLengths);
+        const auto start = std::chrono::steady_clock::now();
+        for (std::size_t first = 0; first < eventCount; first += 1024)
+        {
+            const std::size_t end = std::min(eventCount, first + 1024);
+            for (std::size_t i = first; i < end; ++i)
+                station.ingest(readings[i]);
+            station.drain();
+        }
+        printRate("ingest + drain", eventCount, secondsSince(start));
+        for (std::size_t w = 0; w < windowLengths.size(); ++w)
+            same = same && close(station.stats(Measure::Temperature, w),
+                                 recompute(readings, eventCount, Measure::Temperature, windowLengths[w]));
+    }
+
+    // Producers interleave, so readings arrive slightly out of order; a window longer than
+    // the whole run must still see every one of them
+    {
+        WeatherStation station({1000, 1000000000});
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (unsigned p = 0; p < producers; ++p)
+            threads.emplace_back([&, p]
+                                 {
+                for (std::size_t i = p; i < eventCount; i += producers)
+                    while (!station.ingest(readings[i]))
+                        std::this_thread::yield(); });
+        std::size_t drained = 0;
+        while (drained < eventCount)
+            if (const std::size_t n = station.drain())
+                drained += n;
+            else
+                std::this_thread::yield();
+        for (std::thread &thread : threads)
+            thread.join();
+        char name[32];
+        std::snprintf(name, sizeof name, "%u producers, %u cores", producers, std::thread::hardware_concurrency());
+        printRate(name, eventCount, secondsSince(start));
+
+        const WindowStats expected = recompute(readings, eventCount, Measure::Rain, 1000000000);
+        same = same && close(station.stats(Measure::Rain, 1), expected);
+    }
+
+    std::printf("results %s\n", same ? "match" : "DO NOT MATCH");
+    return same ? 0 : 1;
+}
@@ -0,0 +1,357 @@
+#include "array_kernels.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ARRAY_KERNELS_X86 1
+#endif
+
+namespace ArrayKernels
+{
+    namespace
+    {
+        // Scalar versions, also used for the tails of the SIMD loops. They follow the
+        // InlineCandidates helpers operation for operation so that every ISA agrees.
+        inline double fahrenheit(double celsius) { return celsius * 9.0 / 5.0 + 32.0; }
+        inline std::uint8_t even(int x) { return (x & 1) == 0; }
+        inline int absWrapping(int x) { return x < 0 ? static_cast<int>(0u - static_cast<unsigned>(x)) : x; }
+        inline double squared(double x) { return x * x; }
+
+        void celsiusScalar(const double *in, double *out, std::size_t n)
+        {
+            for (std::size_t k = 0; k < n; ++k)
+                out[k] = fahrenheit(in[k]);
+        }
+
+        void evenScalar(const int *in, std::uint8_t *out, std::size_t n)
+        {
+            for (std::size_t k = 0; k < n; ++k)
+                out[k] = even(in[k]);
+        }
+
+        void absScalar(const int *in, int *out, std::size_t n)
+        {
+            for (std::size_t k = 0; k < n; ++k)
+                out[k] = absWrapping(in[k]);
+        }
+
+        void squareScalar(const double *in, double *out, std::size_t n)
+        {
+            for (std::size_t k = 0; k < n; ++k)
+                out[k] = squared(in[k]);
+        }
+
+#ifdef ARRAY_KERNELS_X86
+        // SSE2 is part of x86-64, so these need no target attribute
+
+        void celsiusSse2(const double *in, double *out, std::size_t n)
+        {
+            const __m128d nine = _mm_set1_pd(9.0), five = _mm_set1_pd(5.0), offset = _mm_set1_pd(32.0);
+            std::size_t k = 0;
+            for (; k + 2 <= n; k += 2)
+            {
+                __m128d c = _mm_loadu_pd(in + k);
+                _mm_storeu_pd(out + k, _mm_add_pd(_mm_div_pd(_mm_mul_pd(c, nine), five), offset));
+            }
+            celsiusScalar(in + k, out + k, n - k);
+        }
+
+        void evenSse2(const int *in, std::uint8_t *out, std::size_t n)
+        {
+            const __m128i one = _mm_set1_epi32(1), ones8 = _mm_set1_epi8(1);
+            std::size_t k = 0;
+            for (; k + 16 <= n; k += 16)
+            {
+                const __m128i *source = reinterpret_cast<const __m128i *>(in + k);
+                // Low bits, narrowed 32 -> 16 -> 8 bits, then flipped: 1 for even
+                __m128i low = _mm_packs_epi32(_mm_and_si128(_mm_loadu_si128(source), one),
+                                              _mm_and_si128(_mm_loadu_si128(source + 1), one));
+                __m128i high = _mm_packs_epi32(_mm_and_si128(_mm_loadu_si128(source + 2), one),
+                                               _mm_and_si128(_mm_loadu_si128(source + 3), one));
+                __m128i bytes = _mm_xor_si128(_mm_packs_epi16(low, high), ones8);
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(out + k), bytes);
+            }
+            evenScalar(in + k, out + k, n - k);
+        }
+
+        void absSse2(const int *in, int *out, std::size_t n)
+        {
+            std::size_t k = 0;
+            for (; k + 4 <= n; k += 4)
+            {
+                // SSE2 has no pabsd: (x ^ sign) - sign
+                __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + k));
+                __m128i sign = _mm_srai_epi32(x, 31);
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(out + k), _mm_sub_epi32(_mm_xor_si128(x, sign), sign));
+            }
+            absScalar(in + k, out + k, n - k);
+        }
+
+        void squareSse2(const double *in, double *out, std::size_t n)
+        {
+            std::size_t k = 0;
+            for (; k + 2 <= n; k += 2)
+            {
+                __m128d x = _mm_loadu_pd(in + k);
+                _mm_storeu_pd(out + k, _mm_mul_pd(x, x));
+            }
+            squareScalar(in + k, out + k, n - k);
+        }
+
+        __attribute__((target("avx2"))) void celsiusAvx2(const double *in, double *out, std::size_t n)
+        {
+            const __m256d nine = _mm256_set1_pd(9.0), five = _mm256_set1_pd(5.0), offset = _mm256_set1_pd(32.0);
+            std::size_t k = 0;
+            for (; k + 4 <= n; k += 4)
+            {
+                __m256d c = _mm256_loadu_pd(in + k);
+                _mm256_storeu_pd(out + k, _mm256_add_pd(_mm256_div_pd(_mm256_mul_pd(c, nine), five), offset));
+            }
+            celsiusScalar(in + k, out + k, n - k);
+        }
+
+        __attribute__((target("avx2"))) void evenAvx2(const int *in, std::uint8_t *out, std::size_t n)
+        {
+            const __m256i one = _mm256_set1_epi32(1), ones8 = _mm256_set1_epi8(1);
+            // The packs work within 128-bit lanes; this puts the 4-byte groups back in order
+            const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+            std::size_t k = 0;
+            for (; k + 32 <= n; k += 32)
+            {
+                // Lambdas do not inherit the target attribute, so the loads are spelled out
+                const __m256i *source = reinterpret_cast<const __m256i *>(in + k);
+                __m256i low = _mm256_packs_epi32(_mm256_and_si256(_mm256_loadu_si256(source), one),
+                                                 _mm256_and_si256(_mm256_loadu_si256(source + 1), one));
+                __m256i high = _mm256_packs_epi32(_mm256_and_si256(_mm256_loadu_si256(source + 2), one),
+                                                  _mm256_and_si256(_mm256_loadu_si256(source + 3), one));
+                __m256i bytes = _mm256_permutevar8x32_epi32(_mm256_packs_epi16(low, high), order);
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + k), _mm256_xor_si256(bytes, ones8));
+            }
+            evenScalar(in + k, out + k, n - k);
+        }
+
+        __attribute__((target("avx2"))) void absAvx2(const int *in, int *out, std::size_t n)
+        {
+            std::size_t k = 0;
+            for (; k + 8 <= n; k += 8)
+            {
+                __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + k));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + k), _mm256_abs_epi32(x));
+            }
+            absScalar(in + k, out + k, n - k);
+        }
+
+        __attribute__((target("avx2"))) void squareAvx2(const double *in, double *out, std::size_t n)
+        {
+            std::size_t k = 0;
+            for (; k + 4 <= n; k += 4)
+            {
+                __m256d x = _mm256_loadu_pd(in + k);
+                _mm256_storeu_pd(out + k, _mm256_mul_pd(x, x));
+            }
+            squareScalar(in + k, out + k, n - k);
+        }
+
+// _mm512_cvtepi32_epi8 and _mm512_abs_epi32 pass an _mm*_undefined_* value as their unused
+// merge source, and GCC 12 reports it as maybe-uninitialized once they are inlined below
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+        __attribute__((target("avx512f"))) void celsiusAvx512(const double *in, double *out, std::size_t n)
+        {
+            const __m512d nine = _mm512_set1_pd(9.0), five = _mm512_set1_pd(5.0), offset = _mm512_set1_pd(32.0);
+            std::size_t k = 0;
+            for (; k + 8 <= n; k += 8)
+            {
+                __m512d c = _mm512_loadu_pd(in + k);
+                _mm512_storeu_pd(out + k, _mm512_add_pd(_mm512_div_pd(_mm512_mul_pd(c, nine), five), offset));
+            }
+            celsiusScalar(in + k, out + k, n - k);
+        }
+
+        __attribute__((target("avx512f"))) void evenAvx512(const int *in, std::uint8_t *out, std::size_t n)
+        {
+            const __m512i one = _mm512_set1_epi32(1);
+            std::size_t k = 0;
+            for (; k + 16 <= n; k += 16)
+            {
+                // vpmovdb narrows 16 x 32 bits to 16 bytes in order
+                __m512i flags = _mm512_xor_si512(_mm512_and_si512(_mm512_loadu_si512(in + k), one), one);
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(out + k), _mm512_cvtepi32_epi8(flags));
+            }
+            evenScalar(in + k, out + k, n - k);
+        }
+
+        __attribute__((target("avx512f"))) void absAvx512(const int *in, int *out, std::size_t n)
+        {
+            std::size_t k = 0;
+            for (; k + 16 <= n; k += 16)
+                _mm512_storeu_si512(out + k, _mm512_abs_epi32(_mm512_loadu_si512(in + k)));
+            absScalar(in + k, out + k, n - k);
+        }
+
+        __attribute__((target("avx512f"))) void squareAvx512(const double *in, double *out, std::size_t n)
+        {
+            std::size_t k = 0;
+            for (; k + 8 <= n; k += 8)
+            {
+                __m512d x = _mm512_loadu_pd(in + k);
+                _mm512_storeu_pd(out + k, _mm512_mul_pd(x, x));
+            }
+            squareScalar(in + k, out + k, n - k);
+        }
+#pragma GCC diagnostic pop
+#endif
+
+        struct KernelTable
+        {
+            Isa isa;
+            void (*celsius)(const double *, double *, std::size_t);
+            void (*even)(const int *, std::uint8_t *, std::size_t);
+            void (*abs)(const int *, int *, std::size_t);
+            void (*square)(const double *, double *, std::size_t);
+        };
+
+        constexpr KernelTable scalarTable{Isa::Scalar, celsiusScalar, evenScalar, absScalar, squareScalar};
+#ifdef ARRAY_KERNELS_X86
+        constexpr KernelTable sse2Table{Isa::SSE2, celsiusSse2, evenSse2, absSse2, squareSse2};
+        constexpr KernelTable avx2Table{Isa::AVX2, celsiusAvx2, evenAvx2, absAvx2, squareAvx2};
+        constexpr KernelTable avx512Table{Isa::AVX512, celsiusAvx512, evenAvx512, absAvx512, squareAvx512};
+#endif
+
+        const KernelTable &tableFor(Isa isa)
+        {
+#ifdef ARRAY_KERNELS_X86
+            switch (isa)
+            {
+            case Isa::SSE2:
+                return sse2Table;
+            case Isa::AVX2:
+                return avx2Table;
+            case Isa::AVX512:
+                return avx512Table;
+            case Isa::Scalar:
+                break;
+            }
+#else
+            (void)isa;
+#endif
+            return scalarTable;
+        }
+
+        Isa bestIsa()
+        {
+            for (Isa isa : {Isa::AVX512, Isa::AVX2, Isa::SSE2})
+                if (isSupported(isa))
+                    return isa;
+            return Isa::Scalar;
+        }
+
+        // ARRAY_KERNELS_ISA=scalar|sse2|avx2|avx512 overrides the choice for a whole run
+        Isa initialIsa()
+        {
+            const char *forced = std::getenv("ARRAY_KERNELS_ISA");
+            if (forced)
+            {
+                for (Isa isa : allIsas)
+                {
+                    std::string name = isaName(isa);
+                    if (name == forced && isSupported(isa))
+                        return isa;
+                }
+            }
+            return bestIsa();
+        }
+
+        // Resolved on first use; forceIsa() may swap it at any time
+        std::atomic<const KernelTable *> &active()
+        {
+            static std::atomic<const KernelTable *> table{&tableFor(initialIsa())};
+            return table;
+        }
+
+        const KernelTable &kernels() { return *active().load(std::memory_order_acquire); }
+
+        void checkSizes(std::size_t in, std::size_t out)
+        {
+            if (out < in)
+                throw std::invalid_argument("ArrayKernels: output has " + std::to_string(out) +
+                                            " elements, input has " + std::to_string(in));
+        }
+    }
+
+    const char *isaName(Isa isa)
+    {
+        switch (isa)
+        {
+        case Isa::Scalar:
+            return "scalar";
+        case Isa::SSE2:
+            return "sse2";
+        case Isa::AVX2:
+            return "avx2";
+        case Isa::AVX512:
+            return "avx512";
+        }
+        return "unknown";
+    }
+
+    bool isSupported(Isa isa)
+    {
+#ifdef ARRAY_KERNELS_X86
+        __builtin_cpu_init();
+        switch (isa)
+        {
+        case Isa::Scalar:
+            return true;
+        case Isa::SSE2:
+            return __builtin_cpu_supports("sse2");
+        case Isa::AVX2:
+            return __builtin_cpu_supports("avx2");
+        case Isa::AVX512:
+            return __builtin_cpu_supports("avx512f");
+        }
+        return false;
+#else
+        return isa == Isa::Scalar;
+#endif
+    }
+
+    Isa activeIsa() { return kernels().isa; }
+
+    void forceIsa(Isa isa)
+    {
+        if (!isSupported(isa))
+            throw std::invalid_argument(std::string("ArrayKernels: ") + isaName(isa) + " is not supported on this CPU");
+        active().store(&tableFor(isa), std::memory_order_release);
+    }
+
+    void resetIsa() { active().store(&tableFor(initialIsa()), std::memory_order_release); }
+
+    void celsiusToFahrenheit(std::span<const double> in, std::span<double> out)
+    {
+        checkSizes(in.size(), out.size());
+        kernels().celsius(in.data(), out.data(), in.size());
+    }
+
+    void isEven(std::span<const int> in, std::span<std::uint8_t> out)
+    {
+        checkSizes(in.size(), out.size());
+        kernels().even(in.data(), out.data(), in.size());
+    }
+
+    void absValue(std::span<const int> in, std::span<int> out)
+    {
+        checkSizes(in.size(), out.size());
+        kernels().abs(in.data(), out.data(), in.size());
+    }
+
+    void squareDouble(std::span<const double> in, std::span<double> out)
+    {
+        checkSizes(in.size(), out.size());
+        kernels().square(in.data(), out.data(), in.size());
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// Array versions of the InlineCandidates helpers from inline_examples.hpp
+//
+// One call processes a whole array, so the call overhead that inlining saves for the scalar
+// helpers is paid once per array instead of once per value. Each kernel has a scalar, SSE2,
+// AVX2 and AVX-512 implementation. The first call picks the best one the CPU supports and
+// caches it in a function-pointer table; later calls are a single indirect call.
+//
+// All implementations give bit-identical results (the same operations in the same order),
+// so forcing an ISA only changes the speed. To force one:
+//     ArrayKernels::forceIsa(ArrayKernels::Isa::SSE2);     // in code
+//     ARRAY_KERNELS_ISA=sse2 ./inline_examples              // for a whole run
+//
+// Output spans must be at least as long as the input (std::invalid_argument otherwise);
+// only in.size() values are written.
+
+namespace ArrayKernels
+{
+    enum class Isa
+    {
+        Scalar,
+        SSE2,
+        AVX2,
+        AVX512
+    };
+
+    inline constexpr Isa allIsas[] = {Isa::Scalar, Isa::SSE2, Isa::AVX2, Isa::AVX512};
+
+    const char *isaName(Isa isa);
+
+    // Whether this CPU (and this build) can run the given implementation
+    bool isSupported(Isa isa);
+
+    // The implementation currently used by the kernels below
+    Isa activeIsa();
+
+    // Switches every kernel to `isa`; throws std::invalid_argument if it is not supported
+    void forceIsa(Isa isa);
+
+    // Goes back to the implementation chosen at startup: the one ARRAY_KERNELS_ISA selects, or
+    // else the best supported one
+    void resetIsa();
+
+    // out[k] = celsius_to_fahrenheit(in[k])
+    void celsiusToFahrenheit(std::span<const double> in, std::span<double> out);
+
+    // out[k] = is_even(in[k]) ? 1 : 0
+    void isEven(std::span<const int> in, std::span<std::uint8_t> out);
+
+    // out[k] = abs_value(in[k]); abs_value(INT_MIN) wraps to INT_MIN, as the SIMD instructions do
+    void absValue(std::span<const int> in, std::span<int> out);
+
+    // out[k] = square_double(in[k])
+    void squareDouble(std::span<const double> in, std::span<double> out);
+}
@@ -6,6 +6,11 @@
 #include <algorithm>
 #include <tuple>
 
+#include "parallel_algorithms.hpp"
+#include "ref_counted.hpp"
+#include "string_builder.hpp"
+#include "string_interner.hpp"
+
 // Example 1: Basic auto usage
 void basicAutoExamples()
 {
@@ -42,6 +47,19 @@ void complexTypeExamples()
 
     std::cout << "First element via iterator: " << *it << std::endl;
     std::cout << "Alice's age: " << mapCopy["Alice"] << std::endl;
+
+    // mapCopy["Alice"] builds a std::string for the key; a map with std::less<> can find a
+    // string_view directly
+    StringMap<int> transparentMap(ageMap.begin(), ageMap.end());
+    auto bob = transparentMap.find(std::string_view("Bob"));
+    std::cout << "Bob's age (string_view lookup): " << bob->second << std::endl;
+
+    // Or store each name once and use its 32-bit symbol as the key
+    StringInterner names;
+    Symbol alice = names.intern("Alice");
+    SymbolMap<int> ageBySymbol;
+    ageBySymbol[alice] = 25;
+    std::cout << names.name(alice) << "'s age (symbol " << alice.id << "): " << ageBySymbol[alice] << std::endl;
     std::cout << std::endl;
 }
 
@@ -129,6 +147,11 @@ void lambdaExamples()
     { return n % 2 == 0; };
     auto evenCount = std::count_if(numbers.begin(), numbers.end(), isEven);
     std::cout << "Even numbers count: " << evenCount << std::endl;
+
+    // The same lambda and iterators, split across a thread pool for large inputs
+    // (five elements are below Parallel::serialCutoff and simply run std::count_if)
+    auto parallelEvenCount = Parallel::count_if(numbers.begin(), numbers.end(), isEven);
+    std::cout << "Even numbers count (Parallel::count_if): " << parallelEvenCount << std::endl;
     std::cout << std::endl;
 }
 
@@ -151,6 +174,19 @@ void smartPointerExamples()
     {
         std::cout << "Weak ptr locked value: " << *locked << std::endl;
     }
+
+    // auto with single-threaded reference counting (ref_counted.hpp): no atomics
+    auto localPtr = make_local_shared<std::string>("Hello local_shared_ptr!");
+    auto localCopy = localPtr;
+    std::cout << "Local shared ptr value: " << *localCopy << " (use_count " << localPtr.use_count() << ")" << std::endl;
+
+    struct Counted : ref_counted
+    {
+        int value = 7;
+    };
+    auto intrusive = make_intrusive<Counted>();
+    auto intrusiveCopy = intrusive;
+    std::cout << "Intrusive ptr value: " << intrusiveCopy->value << " (use_count " << intrusive.use_count() << ")" << std::endl;
     std::cout << std::endl;
 }
 
@@ -196,6 +232,13 @@ void templateExamples()
     std::cout << "Int result: " << intResult << std::endl;
     std::cout << "Double result: " << doubleResult << std::endl;
     std::cout << "String result: " << stringResult << std::endl;
+
+    // With StringBuilder expressions, a + b only records the pieces; the string is built in
+    // one allocation when it is printed or converted
+    auto builtResult = templateFunction(StringBuilder::cat("Hello "), StringBuilder::cat("World"));
+    std::string key = StringBuilder::cat("user:", 42, ":score:", 97.5, '/', stringResult);
+    std::cout << "Built result: " << builtResult << " (" << builtResult.size() << " chars)" << std::endl;
+    std::cout << "Built key: " << key << std::endl;
     std::cout << std::endl;
 }
 // Example 10: Returning multiple values with tuple
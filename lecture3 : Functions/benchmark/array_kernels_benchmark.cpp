@@ -0,0 +1,74 @@
+#include "microbench.hpp"
+#include "../array_kernels.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+// Array kernels from array_kernels.hpp, once per ISA the CPU supports
+//
+//   array_kernels_benchmark [--count=N] [--isa=scalar|sse2|avx2|avx512] [--samples=N] [--cpu=N] [--json=path] [--csv=path]
+
+int main(int argc, char **argv)
+{
+    std::size_t count = 1 << 16;
+    std::string onlyIsa;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strncmp(argv[i], "--count=", 8) == 0)
+            count = std::max<std::size_t>(1, std::strtoul(argv[i] + 8, nullptr, 10));
+        else if (std::strncmp(argv[i], "--isa=", 6) == 0)
+            onlyIsa = argv[i] + 6;
+    }
+
+    std::vector<double> temperatures(count), doubles(count);
+    std::vector<int> readings(count), ints(count);
+    std::vector<std::uint8_t> flags(count);
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> celsius(-40.0, 60.0);
+    for (std::size_t k = 0; k < count; ++k)
+    {
+        temperatures[k] = celsius(rng);
+        readings[k] = static_cast<int>(rng());
+    }
+
+    std::printf("%zu values, default implementation: %s\n", count, ArrayKernels::isaName(ArrayKernels::activeIsa()));
+    bench::Runner runner(bench::Options::fromArgs(argc, argv));
+
+    for (ArrayKernels::Isa isa : ArrayKernels::allIsas)
+    {
+        std::string name = ArrayKernels::isaName(isa);
+        if (!ArrayKernels::isSupported(isa) || (!onlyIsa.empty() && onlyIsa != name))
+            continue;
+        ArrayKernels::forceIsa(isa);
+
+        runner.run("celsiusToFahrenheit [" + name + "]", [&]
+                   {
+            ArrayKernels::celsiusToFahrenheit(temperatures, doubles);
+            bench::clobberMemory(); });
+        runner.run("isEven [" + name + "]", [&]
+                   {
+            ArrayKernels::isEven(readings, flags);
+            bench::clobberMemory(); });
+        runner.run("absValue [" + name + "]", [&]
+                   {
+            ArrayKernels::absValue(readings, ints);
+            bench::clobberMemory(); });
+        runner.run("squareDouble [" + name + "]", [&]
+                   {
+            ArrayKernels::squareDouble(temperatures, doubles);
+            bench::clobberMemory(); });
+    }
+    ArrayKernels::resetIsa();
+
+    std::printf("\n%-36s %12s\n", "kernel", "ns / value");
+    for (const bench::Stats &stats : runner.results())
+        std::printf("%-36s %12.3f\n", stats.name.c_str(), stats.median / static_cast<double>(count));
+
+    runner.finish();
+    return 0;
+}
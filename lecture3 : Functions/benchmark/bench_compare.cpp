@@ -0,0 +1,50 @@
+#include "microbench.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+// Compares two benchmark runs (JSON or CSV written by microbench) and flags regressions
+//
+//   bench_compare baseline.json current.json [threshold-percent]
+//
+// Exits with 1 when at least one benchmark got significantly slower.
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        std::cerr << "usage: " << argv[0] << " baseline.(json|csv) current.(json|csv) [threshold-percent]" << std::endl;
+        return 2;
+    }
+    double threshold = argc > 3 ? std::strtod(argv[3], nullptr) : 5.0;
+
+    auto changes = bench::compare(bench::readResults(argv[1]), bench::readResults(argv[2]), threshold);
+
+    int regressions = 0;
+    double logRatios = 0;
+    int timed = 0;
+    std::printf("%-36s %14s %14s %9s\n", "benchmark", "baseline ns", "current ns", "change");
+    for (const auto &change : changes)
+    {
+        const char *verdict = "";
+        if (change.significant)
+        {
+            verdict = change.percent > 0 ? "  REGRESSION" : "  improvement";
+            regressions += change.percent > 0;
+        }
+        std::printf("%-36s %14.3f %14.3f %+8.1f%%%s\n", change.name.c_str(), change.baseline, change.current, change.percent, verdict);
+        if (change.baseline > 0 && change.current > 0)
+        {
+            logRatios += std::log(change.current / change.baseline);
+            ++timed;
+        }
+    }
+    // One number for the whole file: the geometric mean of current / baseline
+    if (timed > 0)
+        std::printf("geometric mean change: %+.1f%%\n", (std::exp(logRatios / timed) - 1) * 100);
+    std::printf("%d regression(s) above %.1f%% and 3 x MAD\n", regressions, threshold);
+    return regressions > 0 ? 1 : 0;
+}
@@ -0,0 +1,113 @@
+#include "microbench.hpp"
+#include "../char_class.hpp"
+#include "../inline_examples.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+
+// CharClass counting vs InlineCandidates::is_vowel per character
+//
+//   char_class_benchmark [--mib=N] [--threads=T] [--samples=N] [--cpu=N] [--json=path] [--csv=path]
+//
+// The text (default 64 MiB) is English-like words with digits, punctuation, whitespace and
+// the odd UTF-8 character. Reports GB/s; every variant must produce the same counts.
+
+namespace
+{
+    std::string makeText(std::size_t bytes, std::mt19937 &rng)
+    {
+        const char *pieces[] = {"the", "Quick", "BROWN", "fox", "42", "jumps", "over", "Lazy", "dogs", "2024", "a", "queue"};
+        const char *separators[] = {" ", " ", " ", ", ", ". ", "\n", "\t", "!", " \xc3\xa9 "};
+        std::uniform_int_distribution<std::size_t> piece(0, std::size(pieces) - 1), separator(0, std::size(separators) - 1);
+        std::string text;
+        text.reserve(bytes + 16);
+        while (text.size() < bytes)
+        {
+            text += pieces[piece(rng)];
+            text += separators[separator(rng)];
+        }
+        text.resize(bytes);
+        return text;
+    }
+
+    // The per-character baseline: the inline helper plus <cctype> for the other classes
+    CharClass::Counts countPerCharacter(const std::string &text)
+    {
+        CharClass::Counts counts;
+        counts.bytes = text.size();
+        for (char c : text)
+        {
+            const auto u = static_cast<unsigned char>(c);
+            const bool alpha = u < 128 && std::isalpha(u);
+            const bool vowel = InlineCandidates::is_vowel(c);
+            counts.vowels += vowel;
+            counts.consonants += alpha && !vowel;
+            counts.digits += u < 128 && std::isdigit(u);
+            counts.alphabetic += alpha;
+            counts.whitespace += u < 128 && std::isspace(u);
+        }
+        return counts;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    std::size_t mib = 64;
+    unsigned threads = 0;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strncmp(argv[i], "--mib=", 6) == 0)
+            mib = std::max<std::size_t>(1, std::strtoul(argv[i] + 6, nullptr, 10));
+        else if (std::strncmp(argv[i], "--threads=", 10) == 0)
+            threads = static_cast<unsigned>(std::strtoul(argv[i] + 10, nullptr, 10));
+    }
+
+    std::mt19937 rng(42);
+    const std::string text = makeText(mib << 20, rng);
+    const double bytes = static_cast<double>(text.size());
+
+    bench::Options options = bench::Options::fromArgs(argc, argv);
+    options.quiet = true;
+    bench::Runner runner(options);
+
+    std::size_t vowelsOnly = 0;
+    bench::Stats isVowel = runner.run("is_vowel per character", [&]
+                                      {
+        std::size_t n = 0;
+        for (char c : text)
+            n += InlineCandidates::is_vowel(c);
+        vowelsOnly = n;
+        bench::doNotOptimize(n); });
+
+    CharClass::Counts expected, scalar, simd, threaded;
+    bench::Stats perCharacter = runner.run("all classes per character", [&]
+                                           { expected = countPerCharacter(text); bench::clobberMemory(); });
+    bench::Stats table = runner.run("countScalar (table)", [&]
+                                    { scalar = CharClass::countScalar(text); bench::clobberMemory(); });
+    const std::string simdName = std::string("countSimd (") + CharClass::simdIsa() + ")";
+    bench::Stats nibble = runner.run(simdName, [&]
+                                     { simd = CharClass::countSimd(text); bench::clobberMemory(); });
+    bench::Stats parallel = runner.run("count (threaded)", [&]
+                                       { threaded = CharClass::count(text, threads); bench::clobberMemory(); });
+
+    std::printf("%zu MiB: %zu vowels, %zu consonants, %zu digits, %zu whitespace\n", mib, expected.vowels,
+                expected.consonants, expected.digits, expected.whitespace);
+    std::printf("%-28s %8s %9s\n", "variant", "GB/s", "speedup");
+    auto row = [&](const char *name, const bench::Stats &stats)
+    { std::printf("%-28s %8.2f %8.1fx\n", name, bytes / stats.median, isVowel.median / stats.median); };
+    row("is_vowel per character", isVowel);
+    row("all classes per character", perCharacter);
+    row("countScalar (table)", table);
+    row(simdName.c_str(), nibble);
+    row("count (threaded)", parallel);
+
+    const bool same = scalar == expected && simd == expected && threaded == expected && vowelsOnly == expected.vowels;
+    std::printf("results %s\n", same ? "match" : "DO NOT MATCH");
+
+    runner.finish();
+    return same ? 0 : 1;
+}
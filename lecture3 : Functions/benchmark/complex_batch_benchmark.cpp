@@ -0,0 +1,127 @@
+#include "microbench.hpp"
+#include "../complex_batch.hpp"
+#include "../inline_examples.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+// Scalar complexCalculation() vs the batch kernels in complex_batch.hpp
+//
+//   complex_batch_benchmark [--count=N] [--samples=N] [--cpu=N] [--json=path] [--csv=path]
+//
+// Prints ns per value for each variant, then the error of the approximations:
+// sin/cos ULP error against std::sin/std::cos and the end-to-end error against complexCalculation.
+
+using ComplexBatch::TrigPrecision;
+
+static std::int64_t orderedBits(double value)
+{
+    std::int64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits < 0 ? INT64_MIN - bits : bits; // monotonic over all doubles
+}
+
+static double ulpDistance(double a, double b)
+{
+    return std::abs(static_cast<double>(orderedBits(a) - orderedBits(b)));
+}
+
+struct TrigError
+{
+    double maxUlp = 0;
+    double maxAbs = 0;
+};
+
+static TrigError trigError(double (*approx)(double, TrigPrecision), double (*exact)(double), TrigPrecision precision, double range)
+{
+    TrigError error;
+    std::mt19937_64 rng(7);
+    std::uniform_real_distribution<double> dist(-range, range);
+    for (int k = 0; k < 1000000; ++k)
+    {
+        double x = dist(rng);
+        double got = approx(x, precision), want = exact(x);
+        error.maxAbs = std::max(error.maxAbs, std::abs(got - want));
+        // ULP error is only meaningful away from the zeros, where the result itself is tiny
+        if (std::abs(want) > 1e-3)
+            error.maxUlp = std::max(error.maxUlp, ulpDistance(got, want));
+    }
+    return error;
+}
+
+int main(int argc, char **argv)
+{
+    std::size_t count = 4096;
+    for (int i = 1; i < argc; ++i)
+        if (std::strncmp(argv[i], "--count=", 8) == 0)
+            count = std::max<std::size_t>(1, std::strtoul(argv[i] + 8, nullptr, 10));
+
+    std::vector<double> in(count), out(count), expected(count);
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> dist(-100.0, 100.0);
+    for (double &x : in)
+        x = dist(rng);
+
+    std::printf("%zu values, batch kernel: %s\n", count, ComplexBatch::selectedIsa());
+    bench::Runner runner(bench::Options::fromArgs(argc, argv));
+
+    bench::Stats scalar = runner.run("complexCalculation (scalar)", [&]
+                                    {
+        for (std::size_t k = 0; k < count; ++k)
+            expected[k] = complexCalculation(in[k]);
+        bench::clobberMemory(); });
+
+    bench::Stats accurate = runner.run("complexCalculationBatch (accurate)", [&]
+                                      {
+        ComplexBatch::complexCalculationBatch(in, out, TrigPrecision::Accurate);
+        bench::clobberMemory(); });
+
+    bench::Stats fast = runner.run("complexCalculationBatch (fast)", [&]
+                                  {
+        ComplexBatch::complexCalculationBatch(in, out, TrigPrecision::Fast);
+        bench::clobberMemory(); });
+
+    bench::Stats parallel = runner.run("complexCalculationParallel (accurate)", [&]
+                                      {
+        ComplexBatch::complexCalculationParallel(in, out, TrigPrecision::Accurate);
+        bench::clobberMemory(); });
+
+    double n = static_cast<double>(count);
+    std::printf("\n%-40s %12s %9s\n", "variant", "ns / value", "speedup");
+    for (const bench::Stats *stats : {&scalar, &accurate, &fast, &parallel})
+        std::printf("%-40s %12.2f %8.1fx\n", stats->name.c_str(), stats->median / n, scalar.median / stats->median);
+
+    std::printf("\n%-40s %12s %12s\n", "approximation, |x| <= 1e4", "max ULP", "max abs");
+    for (TrigPrecision precision : {TrigPrecision::Accurate, TrigPrecision::Fast})
+    {
+        const char *label = precision == TrigPrecision::Accurate ? "accurate" : "fast";
+        TrigError sinError = trigError(ComplexBatch::sinApprox, std::sin, precision, 1e4);
+        TrigError cosError = trigError(ComplexBatch::cosApprox, std::cos, precision, 1e4);
+        std::printf("sin (%s)%*s %12.0f %12.3g\n", label, static_cast<int>(34 - std::strlen(label)), "", sinError.maxUlp, sinError.maxAbs);
+        std::printf("cos (%s)%*s %12.0f %12.3g\n", label, static_cast<int>(34 - std::strlen(label)), "", cosError.maxUlp, cosError.maxAbs);
+    }
+
+    std::printf("\n%-40s %12s %12s\n", "complexCalculation, |x| <= 100", "max abs", "max rel");
+    for (TrigPrecision precision : {TrigPrecision::Accurate, TrigPrecision::Fast})
+    {
+        ComplexBatch::complexCalculationBatch(in, out, precision);
+        double maxAbs = 0, maxRel = 0;
+        for (std::size_t k = 0; k < count; ++k)
+        {
+            double difference = std::abs(out[k] - expected[k]);
+            maxAbs = std::max(maxAbs, difference);
+            if (std::abs(expected[k]) > 1e-6)
+                maxRel = std::max(maxRel, difference / std::abs(expected[k]));
+        }
+        std::printf("batch (%s)%*s %12.3g %12.3g\n", precision == TrigPrecision::Accurate ? "accurate" : "fast",
+                    precision == TrigPrecision::Accurate ? 24 : 28, "", maxAbs, maxRel);
+    }
+
+    runner.finish();
+    return 0;
+}
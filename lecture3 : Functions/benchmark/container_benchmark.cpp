@@ -0,0 +1,105 @@
+#include "microbench.hpp"
+#include "../container.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <numeric>
+#include <vector>
+
+// Container::at per element vs the bulk interface from container.hpp
+//
+//   container_benchmark [--count=N] [--samples=N] [--cpu=N] [--json=path] [--csv=path]
+//
+// Two loops over the first n of N ints (default 1M): a sum, and an in-place x = x * 3 + 1.
+// Each is run with at() on every element, through range() in blocks of 4096, and through
+// range(0, n) / transform(). n is hidden from the optimizer, as a count read from input would be,
+// so it cannot prove the at() checks redundant.
+
+int main(int argc, char **argv)
+{
+    std::size_t count = 1 << 20;
+    for (int i = 1; i < argc; ++i)
+        if (std::strncmp(argv[i], "--count=", 8) == 0)
+            count = std::max<std::size_t>(1, std::strtoul(argv[i] + 8, nullptr, 10));
+
+    std::vector<int> values(count);
+    std::iota(values.begin(), values.end(), 0);
+    Container container(values);
+    constexpr std::size_t block = 4096;
+    std::size_t n = count;
+    bench::doNotOptimize(n);
+
+    bench::Options options = bench::Options::fromArgs(argc, argv);
+    options.quiet = true;
+    bench::Runner runner(options);
+
+    long long sums[3] = {};
+    bench::Stats sumAt = runner.run("sum, at() per element", [&]
+                                    {
+        long long sum = 0;
+        for (std::size_t i = 0; i < n; ++i)
+            sum += container.at(i);
+        sums[0] = sum;
+        bench::doNotOptimize(sum); });
+    bench::Stats sumRange = runner.run("sum, range() per block", [&]
+                                       {
+        long long sum = 0;
+        for (std::size_t first = 0; first < n; first += block)
+            for (int x : container.range(first, std::min(block, n - first)))
+                sum += x;
+        sums[1] = sum;
+        bench::doNotOptimize(sum); });
+    bench::Stats sumView = runner.run("sum, range(0, n)", [&]
+                                      {
+        long long sum = 0;
+        for (int x : container.range(0, n))
+            sum += x;
+        sums[2] = sum;
+        bench::doNotOptimize(sum); });
+
+    // The update loops run on copies that start from the same values
+    Container atCopy(values), rangeCopy(values), transformCopy(values);
+    bench::Stats updateAt = runner.run("x = 3x + 1, at() per element", [&]
+                                       {
+        for (std::size_t i = 0; i < n; ++i)
+            atCopy.at(i) = atCopy.at(i) * 3 + 1;
+        bench::clobberMemory(); });
+    bench::Stats updateRange = runner.run("x = 3x + 1, range() per block", [&]
+                                          {
+        for (std::size_t first = 0; first < n; first += block)
+            for (int &x : rangeCopy.range(first, std::min(block, n - first)))
+                x = x * 3 + 1;
+        bench::clobberMemory(); });
+    bench::Stats updateTransform = runner.run("x = 3x + 1, transform()", [&]
+                                              {
+        transformCopy.transform([](int x)
+                                { return x * 3 + 1; });
+        bench::clobberMemory(); });
+
+    std::printf("%zu ints\n%-32s %10s %9s\n", count, "loop", "ns/elem", "speedup");
+    auto row = [&](const char *name, const bench::Stats &stats, const bench::Stats &baseline)
+    { std::printf("%-32s %10.3f %8.1fx\n", name, stats.median / count, baseline.median / stats.median); };
+    row("sum, at() per element", sumAt, sumAt);
+    row("sum, range() per block", sumRange, sumAt);
+    row("sum, range(0, n)", sumView, sumAt);
+    row("x = 3x + 1, at() per element", updateAt, updateAt);
+    row("x = 3x + 1, range() per block", updateRange, updateAt);
+    row("x = 3x + 1, transform()", updateTransform, updateAt);
+
+    // The runner repeats each loop a different number of times, so check one update of each by hand
+    bool same = sums[0] == sums[1] && sums[1] == sums[2];
+    Container a(values), b(values), c(values);
+    for (std::size_t i = 0; i < a.size(); ++i)
+        a.at(i) = a.at(i) * 3 + 1;
+    for (std::size_t first = 0; first < b.size(); first += block)
+        for (int &x : b.range(first, std::min(block, b.size() - first)))
+            x = x * 3 + 1;
+    c.transform([](int x)
+                { return x * 3 + 1; });
+    same = same && std::equal(a.begin(), a.end(), b.begin()) && std::equal(a.begin(), a.end(), c.begin());
+    std::printf("results %s\n", same ? "match" : "DO NOT MATCH");
+
+    runner.finish();
+    return same ? 0 : 1;
+}
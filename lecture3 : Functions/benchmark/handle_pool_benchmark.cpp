@@ -0,0 +1,148 @@
+#include "microbench.hpp"
+#include "../handle_pool.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <vector>
+
+// HandlePool vs one heap allocation per object (std::make_unique / std::make_shared)
+//
+//   handle_pool_benchmark [--count=N] [--samples=N] [--cpu=N] [--json=path] [--csv=path]
+//
+// For N objects (default 1M): creating and destroying all of them, destroying and recreating
+// a random half (as a long-running program does, which scatters individually allocated
+// objects across the heap), and updating every live object afterwards.
+
+namespace
+{
+    struct Particle
+    {
+        float x, y, z;
+        float vx, vy, vz;
+
+        Particle(float px, float py) : x(px), y(py), z(0), vx(1), vy(0.5f), vz(0.25f) {}
+        void step(float dt)
+        {
+            x += vx * dt;
+            y += vy * dt;
+            z += vz * dt;
+        }
+    };
+
+    // Every pass leaves the objects as it found them, so the runner can repeat it freely
+    struct Times
+    {
+        double lifetime = 0, churn = 0, iterate = 0;
+    };
+
+    template <typename Pointer, typename Make>
+    Times runPointers(bench::Runner &runner, const std::string &name, std::size_t count, const std::vector<std::uint32_t> &order, Make make, double &checksum)
+    {
+        Times times;
+        std::vector<Pointer> objects;
+        objects.reserve(count);
+        times.lifetime = runner.run(name + " create + destroy", [&]
+                                    {
+            for (std::size_t i = 0; i < count; ++i)
+                objects.push_back(make(float(i), 1.0f));
+            objects.clear();
+            bench::clobberMemory(); }).median;
+
+        for (std::size_t i = 0; i < count; ++i)
+            objects.push_back(make(float(i), 1.0f));
+        times.churn = runner.run(name + " destroy + recreate half", [&]
+                                 {
+            for (std::size_t k = 0; k < count / 2; ++k)
+                objects[order[k]].reset();
+            for (std::size_t k = 0; k < count / 2; ++k)
+                objects[order[k]] = make(float(order[k]), 1.0f);
+            bench::clobberMemory(); }).median;
+        times.iterate = runner.run(name + " iterate", [&]
+                                   {
+            for (auto &object : objects)
+                object->step(0.01f);
+            bench::clobberMemory(); }).median;
+        checksum = 0;
+        for (auto &object : objects)
+            checksum += object->vx;
+        return times;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    std::size_t count = 1 << 20;
+    for (int i = 1; i < argc; ++i)
+        if (std::strncmp(argv[i], "--count=", 8) == 0)
+            count = std::max<std::size_t>(2, std::strtoul(argv[i] + 8, nullptr, 10));
+
+    std::vector<std::uint32_t> order(count);
+    std::iota(order.begin(), order.end(), 0u);
+    std::shuffle(order.begin(), order.end(), std::mt19937(42));
+
+    bench::Options options = bench::Options::fromArgs(argc, argv);
+    options.quiet = true;
+    bench::Runner runner(options);
+
+    double uniqueSum = 0, sharedSum = 0, poolSum = 0;
+    Times unique = runPointers<std::unique_ptr<Particle>>(runner, std::string("make_unique"), count, order, [](float x, float y)
+                                                          { return std::make_unique<Particle>(x, y); }, uniqueSum);
+    Times shared = runPointers<std::shared_ptr<Particle>>(runner, std::string("make_shared"), count, order, [](float x, float y)
+                                                          { return std::make_shared<Particle>(x, y); }, sharedSum);
+
+    Times pool;
+    HandlePool<Particle> particles;
+    std::vector<HandlePool<Particle>::Handle> handles(count);
+    pool.lifetime = runner.run("HandlePool create + destroy", [&]
+                               {
+        for (std::size_t i = 0; i < count; ++i)
+            handles[i] = particles.create(float(i), 1.0f);
+        for (std::size_t i = 0; i < count; ++i)
+            particles.destroy(handles[i]);
+        bench::clobberMemory(); }).median;
+
+    // Every handle of the last pass is stale now, though the slots have been reused many times
+    bool stale = particles.empty();
+    for (std::size_t i = 0; i < count; ++i)
+        stale = stale && particles.get(handles[i]) == nullptr;
+
+    for (std::size_t i = 0; i < count; ++i)
+        handles[i] = particles.create(float(i), 1.0f);
+    pool.churn = runner.run("HandlePool destroy + recreate half", [&]
+                            {
+        for (std::size_t k = 0; k < count / 2; ++k)
+            particles.destroy(handles[order[k]]);
+        for (std::size_t k = 0; k < count / 2; ++k)
+            handles[order[k]] = particles.create(float(order[k]), 1.0f);
+        bench::clobberMemory(); }).median;
+    pool.iterate = runner.run("HandlePool iterate", [&]
+                              {
+        for (Particle &p : particles)
+            p.step(0.01f);
+        bench::clobberMemory(); }).median;
+    for (const Particle &p : particles)
+        poolSum += p.vx;
+
+    // Each handle still finds the object it was created for
+    bool found = particles.size() == count;
+    for (std::size_t i = 0; i < count; ++i)
+        found = found && particles.at(handles[i]).vx == 1.0f;
+
+    std::printf("%zu objects of %zu bytes, ns per object\n%-22s %12s %12s %12s\n", count, sizeof(Particle), "operation",
+                "make_unique", "make_shared", "HandlePool");
+    auto row = [](const char *name, double per, double a, double b, double c)
+    { std::printf("%-22s %12.2f %12.2f %12.2f\n", name, a / per, b / per, c / per); };
+    row("create + destroy", double(count), unique.lifetime, shared.lifetime, pool.lifetime);
+    row("destroy + recreate", double(count / 2), unique.churn, shared.churn, pool.churn);
+    row("iterate", double(count), unique.iterate, shared.iterate, pool.iterate);
+
+    const bool same = stale && found && uniqueSum == double(count) && sharedSum == double(count) && poolSum == double(count);
+    std::printf("stale handles %s, live handles %s\n", stale ? "rejected" : "NOT REJECTED", found ? "found" : "NOT FOUND");
+
+    runner.finish();
+    return same ? 0 : 1;
+}
@@ -0,0 +1,52 @@
+#include "microbench.hpp"
+#include "../inline_examples.hpp"
+
+// Inline vs non-inline candidates from inline_examples.hpp on the microbench harness
+//
+//   inline_benchmark [--samples=N] [--cpu=N] [--json=path] [--csv=path]
+
+int main(int argc, char **argv)
+{
+    bench::Runner runner(bench::Options::fromArgs(argc, argv));
+
+    int i = 0;
+    runner.run("square (inline)", [&]
+               {
+        int x = i++ % 1000;
+        bench::doNotOptimize(x);
+        bench::doNotOptimize(square(x)); });
+
+    i = 0;
+    runner.run("squareNotInline", [&]
+               {
+        int x = i++ % 1000;
+        bench::doNotOptimize(x);
+        bench::doNotOptimize(squareNotInline(x)); });
+
+    double radius = 3.0;
+    runner.run("calculateCircleArea", [&]
+               {
+        bench::doNotOptimize(radius);
+        bench::doNotOptimize(calculateCircleArea(radius)); });
+
+    double x = 1.5;
+    runner.run("complexCalculation", [&]
+               {
+        bench::doNotOptimize(x);
+        bench::doNotOptimize(complexCalculation(x)); });
+
+    Point p1(3.0, 4.0), p2(6.0, 8.0);
+    runner.run("Point::distanceTo", [&]
+               {
+        bench::doNotOptimize(p1);
+        bench::doNotOptimize(p1.distanceTo(p2)); });
+
+    int n = 20;
+    runner.run("PoorInlineCandidates::fibonacci(20)", [&]
+               {
+        bench::doNotOptimize(n);
+        bench::doNotOptimize(PoorInlineCandidates::fibonacci(n)); });
+
+    runner.finish();
+    return 0;
+}
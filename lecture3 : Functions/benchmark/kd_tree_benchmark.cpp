@@ -0,0 +1,117 @@
+#include "microbench.hpp"
+#include "../kd_tree.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+// KdTree build time and query throughput vs brute force over PointCloud::distancesTo
+//
+//   kd_tree_benchmark [--max=N] [--k=K] [--threads=T] [--samples=N] [--cpu=N] [--json=path] [--csv=path]
+//
+// Runs 10K, 100K, 1M, ... points up to --max (default 1M; pass --max=10000000 for 10M).
+// Note that --cpu pins every thread to that CPU, which serializes the parallel build and batch.
+
+static std::vector<KdTree::Neighbor> bruteForce(const PointCloud &cloud, const PointCloud::Coordinates &query, std::size_t k, std::vector<double> &distances)
+{
+    cloud.distancesTo(query, distances);
+    std::vector<std::uint32_t> order(cloud.size());
+    std::iota(order.begin(), order.end(), 0u);
+    k = std::min(k, order.size());
+    std::partial_sort(order.begin(), order.begin() + k, order.end(), [&](std::uint32_t a, std::uint32_t b)
+                      { return distances[a] < distances[b]; });
+    std::vector<KdTree::Neighbor> neighbors;
+    for (std::size_t j = 0; j < k; ++j)
+        neighbors.push_back({order[j], distances[order[j]]});
+    return neighbors;
+}
+
+static PointCloud randomCloud(std::size_t count, std::mt19937 &rng)
+{
+    std::uniform_real_distribution<double> coordinate(0.0, 1000.0);
+    PointCloud cloud;
+    cloud.reserve(count);
+    for (std::size_t i = 0; i < count; ++i)
+        cloud.push_back(coordinate(rng), coordinate(rng));
+    return cloud;
+}
+
+int main(int argc, char **argv)
+{
+    std::size_t maxPoints = 1000000, k = 8;
+    unsigned threads = 0;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strncmp(argv[i], "--max=", 6) == 0)
+            maxPoints = std::strtoul(argv[i] + 6, nullptr, 10);
+        else if (std::strncmp(argv[i], "--k=", 4) == 0)
+            k = std::max<std::size_t>(1, std::strtoul(argv[i] + 4, nullptr, 10));
+        else if (std::strncmp(argv[i], "--threads=", 10) == 0)
+            threads = static_cast<unsigned>(std::strtoul(argv[i] + 10, nullptr, 10));
+    }
+
+    bench::Runner runner(bench::Options::fromArgs(argc, argv));
+    std::mt19937 rng(42);
+    const std::size_t queryCount = 1000, bruteQueryCount = 20;
+    PointCloud queries = randomCloud(queryCount, rng);
+
+    struct Row
+    {
+        std::size_t points;
+        double buildMs, treeQps, batchQps, bruteQps;
+    };
+    std::vector<Row> rows;
+    bool allMatch = true;
+
+    for (std::size_t points = 10000; points <= maxPoints; points *= 10)
+    {
+        PointCloud cloud = randomCloud(points, rng);
+        std::string suffix = " n=" + std::to_string(points);
+
+        bench::Stats build = runner.run("build" + suffix, [&]
+                                        {
+            KdTree tree(cloud, threads);
+            bench::doNotOptimize(tree); });
+
+        KdTree tree(cloud, threads);
+        bench::Stats single = runner.run("knn 1000 queries" + suffix, [&]
+                                         {
+            for (std::size_t q = 0; q < queryCount; ++q)
+                bench::doNotOptimize(tree.nearest(queries.coordinates(q), k)); });
+
+        bench::Stats batch = runner.run("knn batch 1000 queries" + suffix, [&]
+                                        { bench::doNotOptimize(tree.nearestBatch(queries, k, threads)); });
+
+        std::vector<double> distances(points);
+        bench::Stats brute = runner.run("brute force 20 queries" + suffix, [&]
+                                        {
+            for (std::size_t q = 0; q < bruteQueryCount; ++q)
+                bench::doNotOptimize(bruteForce(cloud, queries.coordinates(q), k, distances)); });
+
+        // The tree must find the same distances as the scan (indices may differ on ties)
+        for (std::size_t q = 0; q < bruteQueryCount; ++q)
+        {
+            auto expected = bruteForce(cloud, queries.coordinates(q), k, distances);
+            auto found = tree.nearest(queries.coordinates(q), k);
+            for (std::size_t j = 0; j < expected.size(); ++j)
+                allMatch = allMatch && found.size() == expected.size() && found[j].distance == expected[j].distance;
+        }
+
+        rows.push_back({points, build.median / 1e6, queryCount / (single.median / 1e9),
+                        queryCount / (batch.median / 1e9), bruteQueryCount / (brute.median / 1e9)});
+    }
+
+    std::printf("\n%10s %12s %16s %16s %16s %9s\n", "points", "build ms", "tree queries/s", "batch queries/s",
+                "brute queries/s", "speedup");
+    for (const Row &row : rows)
+        std::printf("%10zu %12.2f %16.0f %16.0f %16.1f %8.0fx\n", row.points, row.buildMs, row.treeQps, row.batchQps,
+                    row.bruteQps, row.treeQps / row.bruteQps);
+    std::printf("\nk = %zu; tree results %s brute force\n", k, allMatch ? "match" : "DO NOT MATCH");
+
+    runner.finish();
+    return allMatch ? 0 : 1;
+}
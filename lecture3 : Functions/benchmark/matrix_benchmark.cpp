@@ -0,0 +1,132 @@
+#include "microbench.hpp"
+#include "../matrix.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+// gemm() and transpose() from matrix.hpp vs the naive loops
+//
+//   matrix_benchmark [--max=N] [--threads=T] [--samples=N] [--cpu=N] [--json=path] [--csv=path]
+//
+// Multiplies n x n matrices for n = 256, 512, ... up to --max (default 2048) and reports
+// GFLOP/s (2 n^3 floating-point operations per product). The naive triple loop only runs up
+// to n = 512, where it already takes a while.
+
+namespace
+{
+    template <typename T>
+    void naiveMultiply(const Matrix<T> &a, const Matrix<T> &b, Matrix<T> &c)
+    {
+        for (std::size_t i = 0; i < a.rows(); ++i)
+            for (std::size_t j = 0; j < b.cols(); ++j)
+            {
+                T sum = 0;
+                for (std::size_t k = 0; k < a.cols(); ++k)
+                    sum += a(i, k) * b(k, j);
+                c(i, j) = sum;
+            }
+    }
+
+    template <typename T>
+    Matrix<T> randomMatrix(std::size_t rows, std::size_t cols, std::mt19937 &rng)
+    {
+        std::uniform_real_distribution<T> value(-1, 1);
+        Matrix<T> m(rows, cols);
+        for (std::size_t i = 0; i < rows * cols; ++i)
+            m.data()[i] = value(rng);
+        return m;
+    }
+
+    template <typename T>
+    bool benchmarkType(const char *type, bench::Runner &runner, std::size_t maxSize, unsigned threads, std::mt19937 &rng)
+    {
+        bool same = true;
+        std::printf("\n%s\n%8s %14s %14s\n", type, "n", "naive GFLOP/s", "gemm GFLOP/s");
+        for (std::size_t n = 256; n <= maxSize; n *= 2)
+        {
+            Matrix<T> a = randomMatrix<T>(n, n, rng), b = randomMatrix<T>(n, n, rng), c(n, n), reference(n, n);
+            const double flops = 2.0 * n * n * n;
+            const std::string suffix = std::string(" ") + type + " n=" + std::to_string(n);
+
+            double naiveGflops = 0;
+            if (n <= 512)
+            {
+                bench::Stats naive = runner.run("naive" + suffix, [&]
+                                                {
+                    naiveMultiply(a, b, reference);
+                    bench::clobberMemory(); });
+                naiveGflops = flops / naive.median;
+
+                // Different summation order and fused multiply-adds: compare relative to the magnitude
+                gemm(a, b, c, threads);
+                double worst = 0;
+                for (std::size_t i = 0; i < n * n; ++i)
+                    worst = std::max(worst, std::abs(double(c.data()[i]) - double(reference.data()[i])) / std::sqrt(double(n)));
+                if (worst > (sizeof(T) == 4 ? 1e-4 : 1e-12))
+                {
+                    std::printf("gemm differs from the naive product by %g\n", worst);
+                    same = false;
+                }
+            }
+
+            bench::Stats blocked = runner.run("gemm" + suffix, [&]
+                                              {
+                gemm(a, b, c, threads);
+                bench::clobberMemory(); });
+
+            if (naiveGflops > 0)
+                std::printf("%8zu %14.2f %14.2f\n", n, naiveGflops, flops / blocked.median);
+            else
+                std::printf("%8zu %14s %14.2f\n", n, "-", flops / blocked.median);
+        }
+        return same;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    std::size_t maxSize = 2048;
+    unsigned threads = 0;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strncmp(argv[i], "--max=", 6) == 0)
+            maxSize = std::strtoul(argv[i] + 6, nullptr, 10);
+        else if (std::strncmp(argv[i], "--threads=", 10) == 0)
+            threads = static_cast<unsigned>(std::strtoul(argv[i] + 10, nullptr, 10));
+    }
+
+    bench::Options options = bench::Options::fromArgs(argc, argv);
+    options.quiet = true;
+    bench::Runner runner(options);
+    std::mt19937 rng(42);
+
+    bool same = benchmarkType<float>("float", runner, maxSize, threads, rng);
+    same = benchmarkType<double>("double", runner, maxSize, threads, rng) && same;
+
+    // Transpose: bytes read plus bytes written
+    const std::size_t rows = 4096, cols = 4096;
+    Matrix<double> in = randomMatrix<double>(rows, cols, rng), out(cols, rows);
+    bench::Stats naive = runner.run("transpose naive 4096", [&]
+                                    {
+        for (std::size_t r = 0; r < rows; ++r)
+            for (std::size_t c = 0; c < cols; ++c)
+                out(c, r) = in(r, c);
+        bench::clobberMemory(); });
+    bench::Stats oblivious = runner.run("transpose cache-oblivious 4096", [&]
+                                        {
+        transpose(in, out);
+        bench::clobberMemory(); });
+    const double bytes = 2.0 * rows * cols * sizeof(double);
+    std::printf("\ntranspose 4096 x 4096 double: naive %.2f GB/s, cache-oblivious %.2f GB/s\n", bytes / naive.median,
+                bytes / oblivious.median);
+
+    std::printf("results %s\n", same ? "match" : "DO NOT MATCH");
+
+    runner.finish();
+    return same ? 0 : 1;
+}
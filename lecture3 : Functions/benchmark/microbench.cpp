@@ -0,0 +1,289 @@
+#include "microbench.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+namespace bench
+{
+    bool pinToCpu(int cpu)
+    {
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+        (void)cpu;
+        return false;
+#endif
+    }
+
+    Options Options::fromArgs(int argc, char **argv)
+    {
+        Options options;
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            auto value = [&](const char *prefix) -> const char *
+            {
+                std::size_t length = std::char_traits<char>::length(prefix);
+                return arg.compare(0, length, prefix) == 0 ? arg.c_str() + length : nullptr;
+            };
+            if (const char *v = value("--samples="))
+                options.samples = std::max<std::size_t>(1, std::strtoul(v, nullptr, 10));
+            else if (const char *v = value("--warmup-ms="))
+                options.warmup = std::chrono::milliseconds(std::strtol(v, nullptr, 10));
+            else if (const char *v = value("--min-sample-us="))
+                options.minSampleTime = std::chrono::microseconds(std::strtol(v, nullptr, 10));
+            else if (const char *v = value("--cpu="))
+                options.cpu = static_cast<int>(std::strtol(v, nullptr, 10));
+            else if (const char *v = value("--json="))
+                options.jsonPath = v;
+            else if (const char *v = value("--csv="))
+                options.csvPath = v;
+            else if (arg == "--quiet")
+                options.quiet = true;
+        }
+        return options;
+    }
+
+    // Nearest-rank percentile of sorted values
+    static double percentile(const std::vector<double> &sorted, double p)
+    {
+        std::size_t rank = static_cast<std::size_t>(std::ceil(p * static_cast<double>(sorted.size())));
+        return sorted[std::min(sorted.size() - 1, rank == 0 ? 0 : rank - 1)];
+    }
+
+    static double median(std::vector<double> sorted)
+    {
+        std::size_t n = sorted.size();
+        return n % 2 ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2.0;
+    }
+
+    Stats summarize(std::string name, std::size_t iterations, std::vector<double> nsPerIteration)
+    {
+        Stats stats;
+        stats.name = std::move(name);
+        stats.iterations = iterations;
+        stats.samples = nsPerIteration.size();
+        if (nsPerIteration.empty())
+            return stats;
+
+        std::sort(nsPerIteration.begin(), nsPerIteration.end());
+        stats.median = median(nsPerIteration);
+        stats.p99 = percentile(nsPerIteration, 0.99);
+        stats.min = nsPerIteration.front();
+        stats.max = nsPerIteration.back();
+        double sum = 0;
+        for (double value : nsPerIteration)
+            sum += value;
+        stats.mean = sum / static_cast<double>(nsPerIteration.size());
+
+        std::vector<double> deviations;
+        deviations.reserve(nsPerIteration.size());
+        for (double value : nsPerIteration)
+            deviations.push_back(std::abs(value - stats.median));
+        std::sort(deviations.begin(), deviations.end());
+        stats.mad = median(deviations);
+        return stats;
+    }
+
+    Runner::Runner(Options options) : options_(std::move(options))
+    {
+        if (options_.cpu >= 0 && !pinToCpu(options_.cpu))
+            std::cerr << "microbench: could not pin to CPU " << options_.cpu << std::endl;
+    }
+
+    const Stats &Runner::record(Stats stats)
+    {
+        results_.push_back(std::move(stats));
+        const Stats &last = results_.back();
+        if (!options_.quiet)
+        {
+            std::cout << std::left << std::setw(36) << last.name << std::right << std::fixed << std::setprecision(3)
+                      << " median " << std::setw(10) << last.median << " ns"
+                      << "  MAD " << std::setw(8) << last.mad
+                      << "  p99 " << std::setw(10) << last.p99
+                      << "  (" << last.samples << " x " << last.iterations << " iterations)" << std::endl;
+            std::cout.unsetf(std::ios::floatfield);
+        }
+        return last;
+    }
+
+    void Runner::finish() const
+    {
+        if (!options_.jsonPath.empty())
+        {
+            std::ofstream out(options_.jsonPath);
+            writeJson(out, results_);
+        }
+        if (!options_.csvPath.empty())
+        {
+            std::ofstream out(options_.csvPath);
+            writeCsv(out, results_);
+        }
+    }
+
+    void printTable(std::ostream &out, const std::vector<Stats> &results)
+    {
+        out << std::left << std::setw(36) << "benchmark" << std::right
+            << std::setw(14) << "median ns" << std::setw(12) << "MAD ns" << std::setw(14) << "p99 ns" << std::endl;
+        for (const Stats &stats : results)
+        {
+            out << std::left << std::setw(36) << stats.name << std::right << std::fixed << std::setprecision(3)
+                << std::setw(14) << stats.median << std::setw(12) << stats.mad << std::setw(14) << stats.p99 << std::endl;
+        }
+        out.unsetf(std::ios::floatfield);
+    }
+
+    static std::string escapeJson(const std::string &text)
+    {
+        std::string escaped;
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\')
+                escaped += '\\';
+            escaped += c;
+        }
+        return escaped;
+    }
+
+    // A quoted CSV field, with embedded quotes doubled (RFC 4180)
+    static std::string quoteCsv(const std::string &text)
+    {
+        std::string quoted = "\"";
+        for (char c : text)
+        {
+            if (c == '"')
+                quoted += '"';
+            quoted += c;
+        }
+        return quoted + '"';
+    }
+
+    void writeJson(std::ostream &out, const std::vector<Stats> &results)
+    {
+        out << std::setprecision(17) << "{\n  \"benchmarks\": [\n";
+        for (std::size_t i = 0; i < results.size(); ++i)
+        {
+            const Stats &s = results[i];
+            out << "    {\"name\": \"" << escapeJson(s.name) << "\", \"iterations\": " << s.iterations
+                << ", \"samples\": " << s.samples << ", \"median_ns\": " << s.median << ", \"mad_ns\": " << s.mad
+                << ", \"p99_ns\": " << s.p99 << ", \"min_ns\": " << s.min << ", \"max_ns\": " << s.max
+                << ", \"mean_ns\": " << s.mean << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        out << "  ]\n}\n";
+    }
+
+    void writeCsv(std::ostream &out, const std::vector<Stats> &results)
+    {
+        out << std::setprecision(17) << "name,iterations,samples,median_ns,mad_ns,p99_ns,min_ns,max_ns,mean_ns\n";
+        for (const Stats &s : results)
+        {
+            // Names are quoted because they may contain commas
+            out << quoteCsv(s.name) << ',' << s.iterations << ',' << s.samples << ',' << s.median << ',' << s.mad
+                << ',' << s.p99 << ',' << s.min << ',' << s.max << ',' << s.mean << '\n';
+        }
+    }
+
+    // Finds "key": in a JSON object line and parses the number after it
+    static double jsonNumber(const std::string &line, const std::string &key)
+    {
+        std::size_t at = line.find("\"" + key + "\":");
+        if (at == std::string::npos)
+            throw std::runtime_error("microbench: missing \"" + key + "\" in " + line);
+        return std::strtod(line.c_str() + at + key.size() + 3, nullptr);
+    }
+
+    std::vector<Stats> readResults(const std::string &path)
+    {
+        std::ifstream in(path);
+        if (!in.is_open())
+            throw std::runtime_error("microbench: cannot open " + path);
+
+        std::vector<Stats> results;
+        std::string line;
+        bool csv = path.size() >= 4 && path.compare(path.size() - 4, 4, ".csv") == 0;
+        if (csv)
+            std::getline(in, line); // header
+
+        while (std::getline(in, line))
+        {
+            Stats s;
+            if (csv)
+            {
+                std::size_t close = line.find("\",");
+                if (line.empty() || line[0] != '"' || close == std::string::npos)
+                    continue;
+                s.name = line.substr(1, close - 1);
+                std::istringstream fields(line.substr(close + 2));
+                char comma;
+                fields >> s.iterations >> comma >> s.samples >> comma >> s.median >> comma >> s.mad >> comma >> s.p99 >> comma >> s.min >> comma >> s.max >> comma >> s.mean;
+            }
+            else
+            {
+                // writeJson() puts one benchmark object per line
+                std::size_t at = line.find("\"name\": \"");
+                if (at == std::string::npos)
+                    continue;
+                std::size_t begin = at + 9;
+                std::string name;
+                for (std::size_t i = begin; i < line.size() && line[i] != '"'; ++i)
+                {
+                    if (line[i] == '\\' && i + 1 < line.size())
+                        ++i;
+                    name += line[i];
+                }
+                s.name = name;
+                s.iterations = static_cast<std::size_t>(jsonNumber(line, "iterations"));
+                s.samples = static_cast<std::size_t>(jsonNumber(line, "samples"));
+                s.median = jsonNumber(line, "median_ns");
+                s.mad = jsonNumber(line, "mad_ns");
+                s.p99 = jsonNumber(line, "p99_ns");
+                s.min = jsonNumber(line, "min_ns");
+                s.max = jsonNumber(line, "max_ns");
+                s.mean = jsonNumber(line, "mean_ns");
+            }
+            results.push_back(s);
+        }
+        return results;
+    }
+
+    bool isSignificant(const Stats &a, const Stats &b, double thresholdPercent)
+    {
+        double difference = std::abs(b.median - a.median);
+        double noise = 3.0 * std::max(a.mad, b.mad);
+        return difference > noise && difference > a.median * thresholdPercent / 100.0;
+    }
+
+    std::vector<Change> compare(const std::vector<Stats> &baseline, const std::vector<Stats> &current, double thresholdPercent)
+    {
+        std::vector<Change> changes;
+        for (const Stats &now : current)
+        {
+            auto before = std::find_if(baseline.begin(), baseline.end(), [&](const Stats &s)
+                                       { return s.name == now.name; });
+            if (before == baseline.end())
+                continue;
+            Change change;
+            change.name = now.name;
+            change.baseline = before->median;
+            change.current = now.median;
+            change.percent = before->median > 0 ? (now.median - before->median) / before->median * 100.0 : 0.0;
+            change.significant = isSignificant(*before, now, thresholdPercent);
+            changes.push_back(change);
+        }
+        return changes;
+    }
+}
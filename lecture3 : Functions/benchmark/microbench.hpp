@@ -0,0 +1,154 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// microbench: a small, statistically careful micro-benchmark library
+//
+// performanceTest() used to time each variant once with high_resolution_clock. A single
+// sample cannot tell a real difference from noise, the loop could be deleted by the
+// optimizer, and the first variant paid for cold caches. Runner::run() instead:
+//   1. warms up the body for a fixed time
+//   2. calibrates how many iterations make one sample long enough to time reliably
+//   3. collects many samples and reports median, MAD (median absolute deviation) and p99
+// Results can be written as JSON or CSV and compared between two runs.
+
+namespace bench
+{
+    // Forces the compiler to assume `value` is read, so the computation producing it is kept
+    template <typename T>
+    inline void doNotOptimize(const T &value)
+    {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    // Forces the compiler to assume `value` is read and modified (hides constants from the optimizer).
+    // GCC can reject the "+r,m" alternative as an impossible constraint once profile feedback
+    // changes what gets inlined, so it gets one constraint chosen from the type
+    template <typename T>
+    inline void doNotOptimize(T &value)
+    {
+#if defined(__clang__)
+        asm volatile("" : "+r,m"(value) : : "memory");
+#else
+        if constexpr (std::is_trivially_copyable_v<T> && sizeof(T) <= sizeof(void *))
+            asm volatile("" : "+r"(value) : : "memory");
+        else
+            asm volatile("" : "+m"(value) : : "memory");
+#endif
+    }
+
+    // Forces pending memory writes to be treated as observable
+    inline void clobberMemory()
+    {
+        asm volatile("" : : : "memory");
+    }
+
+    // Pins the calling thread to one CPU so samples do not migrate between cores; false if not possible
+    bool pinToCpu(int cpu);
+
+    struct Options
+    {
+        std::chrono::milliseconds warmup{50};
+        std::chrono::microseconds minSampleTime{2000}; // calibration target for one sample
+        std::size_t samples = 31;
+        int cpu = -1; // -1: do not pin
+        bool quiet = false;
+        std::string jsonPath; // written by Runner::finish() when not empty
+        std::string csvPath;
+
+        // --samples=N --warmup-ms=N --min-sample-us=N --cpu=N --json=path --csv=path --quiet
+        static Options fromArgs(int argc, char **argv);
+    };
+
+    // All times are nanoseconds per iteration
+    struct Stats
+    {
+        std::string name;
+        std::size_t iterations = 0; // per sample
+        std::size_t samples = 0;
+        double median = 0;
+        double mad = 0;
+        double p99 = 0;
+        double min = 0;
+        double max = 0;
+        double mean = 0;
+    };
+
+    Stats summarize(std::string name, std::size_t iterations, std::vector<double> nsPerIteration);
+
+    class Runner
+    {
+    public:
+        explicit Runner(Options options = {});
+
+        // Benchmarks body(), one call per iteration. Returns a copy: results() grows with
+        // every run, so references into it do not survive the next one.
+        template <typename Body>
+        Stats run(const std::string &name, Body &&body)
+        {
+            using Clock = std::chrono::steady_clock;
+            auto batch = [&](std::size_t iterations)
+            {
+                auto start = Clock::now();
+                for (std::size_t i = 0; i < iterations; ++i)
+                    body();
+                return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+            };
+
+            auto warmupEnd = Clock::now() + options_.warmup;
+            while (Clock::now() < warmupEnd)
+                batch(16);
+
+            std::size_t iterations = 1;
+            const double target = std::chrono::duration<double, std::nano>(options_.minSampleTime).count();
+            while (batch(iterations) < target && iterations < (std::size_t{1} << 40))
+                iterations *= 2;
+
+            std::vector<double> samples;
+            samples.reserve(options_.samples);
+            for (std::size_t s = 0; s < options_.samples; ++s)
+                samples.push_back(batch(iterations) / static_cast<double>(iterations));
+
+            return record(summarize(name, iterations, std::move(samples)));
+        }
+
+        const std::vector<Stats> &results() const { return results_; }
+        const Options &options() const { return options_; }
+
+        // Writes the JSON / CSV files named in the options
+        void finish() const;
+
+    private:
+        const Stats &record(Stats stats);
+
+        Options options_;
+        std::vector<Stats> results_;
+    };
+
+    void printTable(std::ostream &out, const std::vector<Stats> &results);
+    void writeJson(std::ostream &out, const std::vector<Stats> &results);
+    void writeCsv(std::ostream &out, const std::vector<Stats> &results);
+
+    // Reads a file written by writeJson() or writeCsv() (chosen by extension)
+    std::vector<Stats> readResults(const std::string &path);
+
+    // A change is significant when the medians differ by more than `thresholdPercent`
+    // and by more than three times the larger of the two MADs
+    struct Change
+    {
+        std::string name;
+        double baseline = 0;
+        double current = 0;
+        double percent = 0;
+        bool significant = false;
+    };
+
+    std::vector<Change> compare(const std::vector<Stats> &baseline, const std::vector<Stats> &current, double thresholdPercent = 5.0);
+    bool isSignificant(const Stats &a, const Stats &b, double thresholdPercent = 5.0);
+}
@@ -0,0 +1,151 @@
+#include "microbench.hpp"
+#include "../parallel_algorithms.hpp"
+#include "../parallel_chunks.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Parallel:: algorithms on 1..N threads vs the serial std:: calls with the same lambdas
+//
+//   parallel_algorithms_benchmark [--count=N] [--max=T] [--samples=N] [--cpu=N] [--json=path] [--csv=path]
+//
+// Runs count_if, transform, for_each, reduce and transform_reduce over --count ints (default
+// 16M) with pools of 1, 2, 4, ... up to --max threads (default: hardware threads) and reports
+// the speedup over std::. With more threads than cores the extra threads only add overhead.
+// Note that --cpu pins the process to one core, so scaling needs --cpu=-1.
+
+namespace
+{
+    struct Results
+    {
+        std::ptrdiff_t evens = 0;
+        long long sum = 0;
+        long long squares = 0;
+        int transformed = 0;
+
+        bool operator==(const Results &) const = default;
+    };
+}
+
+int main(int argc, char **argv)
+{
+    std::size_t count = std::size_t{1} << 24;
+    unsigned maxThreads = 0;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strncmp(argv[i], "--count=", 8) == 0)
+            count = std::max<std::size_t>(1, std::strtoull(argv[i] + 8, nullptr, 10));
+        else if (std::strncmp(argv[i], "--max=", 6) == 0)
+            maxThreads = static_cast<unsigned>(std::strtoul(argv[i] + 6, nullptr, 10));
+    }
+    maxThreads = resolveThreads(maxThreads);
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> value(0, 1 << 20);
+    std::vector<int> numbers(count), out(count), scratch(count);
+    for (int &x : numbers)
+        x = value(rng);
+
+    // The lambdas from lambdaExamples, and a few like them
+    auto isEven = [](int n)
+    { return n % 2 == 0; };
+    auto scale = [](int x)
+    { return x * 3 + 1; };
+    auto flip = [](int &x)
+    { x ^= 0x55; };
+    auto square = [](int x)
+    { return static_cast<long long>(x) * x; };
+
+    bench::Options options = bench::Options::fromArgs(argc, argv);
+    options.quiet = true;
+    bench::Runner runner(options);
+
+    // for_each is checked once here; in the benchmark it flips scratch back and forth
+    Results expected;
+    scratch = numbers;
+    std::for_each(scratch.begin(), scratch.end(), flip);
+    std::vector<int> flipped = scratch;
+
+    const char *names[] = {"count_if", "transform", "for_each", "reduce", "transform_reduce"};
+    double serial[5];
+    serial[0] = runner.run("std::count_if", [&]
+                           { expected.evens = std::count_if(numbers.begin(), numbers.end(), isEven); bench::clobberMemory(); })
+                    .median;
+    serial[1] = runner.run("std::transform", [&]
+                           { std::transform(numbers.begin(), numbers.end(), out.begin(), scale); bench::clobberMemory(); })
+                    .median;
+    expected.transformed = out[count / 2];
+    serial[2] = runner.run("std::for_each", [&]
+                           { std::for_each(scratch.begin(), scratch.end(), flip); bench::clobberMemory(); })
+                    .median;
+    serial[3] = runner.run("std::reduce", [&]
+                           { expected.sum = std::reduce(numbers.begin(), numbers.end(), 0LL); bench::clobberMemory(); })
+                    .median;
+    serial[4] = runner.run("std::transform_reduce", [&]
+                           { expected.squares = std::transform_reduce(numbers.begin(), numbers.end(), 0LL, std::plus<>(), square); bench::clobberMemory(); })
+                    .median;
+
+    std::printf("%zu ints, %u hardware threads\n%-18s %10s", count, std::thread::hardware_concurrency(), "algorithm", "std:: ms");
+    std::vector<unsigned> threadCounts;
+    for (unsigned t = 1; t <= maxThreads; t *= 2)
+        threadCounts.push_back(t);
+    if (threadCounts.back() != maxThreads)
+        threadCounts.push_back(maxThreads);
+    for (unsigned t : threadCounts)
+        std::printf(" %7ux", t);
+    std::printf("\n");
+
+    bool same = true;
+    std::vector<std::vector<double>> speedups(5);
+    for (unsigned t : threadCounts)
+    {
+        Parallel::ThreadPool pool(t);
+        const std::string suffix = " x" + std::to_string(t);
+        Results got;
+        double times[5];
+        times[0] = runner.run("Parallel::count_if" + suffix, [&]
+                              { got.evens = Parallel::count_if(pool, numbers.begin(), numbers.end(), isEven); bench::clobberMemory(); })
+                       .median;
+        std::fill(out.begin(), out.end(), 0);
+        times[1] = runner.run("Parallel::transform" + suffix, [&]
+                              { Parallel::transform(pool, numbers.begin(), numbers.end(), out.begin(), scale); bench::clobberMemory(); })
+                       .median;
+        got.transformed = out[count / 2];
+        same = same && std::equal(out.begin(), out.end(), numbers.begin(), [&](int y, int x)
+                                  { return y == scale(x); });
+
+        scratch = numbers;
+        Parallel::for_each(pool, scratch.begin(), scratch.end(), flip);
+        same = same && scratch == flipped;
+        times[2] = runner.run("Parallel::for_each" + suffix, [&]
+                              { Parallel::for_each(pool, scratch.begin(), scratch.end(), flip); bench::clobberMemory(); })
+                       .median;
+        times[3] = runner.run("Parallel::reduce" + suffix, [&]
+                              { got.sum = Parallel::reduce(pool, numbers.begin(), numbers.end(), 0LL); bench::clobberMemory(); })
+                       .median;
+        times[4] = runner.run("Parallel::transform_reduce" + suffix, [&]
+                              { got.squares = Parallel::transform_reduce(pool, numbers.begin(), numbers.end(), 0LL, std::plus<>(), square); bench::clobberMemory(); })
+                       .median;
+        same = same && got == expected;
+        for (int a = 0; a < 5; ++a)
+            speedups[a].push_back(serial[a] / times[a]);
+    }
+
+    for (int a = 0; a < 5; ++a)
+    {
+        std::printf("%-18s %10.2f", names[a], serial[a] / 1e6);
+        for (double speedup : speedups[a])
+            std::printf(" %7.2fx", speedup);
+        std::printf("\n");
+    }
+    std::printf("results %s\n", same ? "match" : "DO NOT MATCH");
+
+    runner.finish();
+    return same ? 0 : 1;
+}
@@ -0,0 +1,117 @@
+#include "microbench.hpp"
+#include "../point_cloud.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+// PointCloud batch kernels vs looping over std::vector<Point>
+//
+//   point_cloud_benchmark [--count=N] [--matrix=M] [--samples=N] [--cpu=N] [--json=path] [--csv=path]
+//
+// --count is the number of points for the per-point operations, --matrix the side of the
+// distance matrix (M x M distances).
+
+int main(int argc, char **argv)
+{
+    std::size_t count = 1 << 20, side = 2048;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strncmp(argv[i], "--count=", 8) == 0)
+            count = std::max<std::size_t>(1, std::strtoul(argv[i] + 8, nullptr, 10));
+        else if (std::strncmp(argv[i], "--matrix=", 9) == 0)
+            side = std::max<std::size_t>(1, std::strtoul(argv[i] + 9, nullptr, 10));
+    }
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> coordinate(-1000.0, 1000.0);
+    std::vector<Point> points;
+    points.reserve(count);
+    for (std::size_t i = 0; i < count; ++i)
+        points.emplace_back(coordinate(rng), coordinate(rng));
+    PointCloud cloud = PointCloud::fromPoints(points);
+
+    std::vector<Point> matrixPoints(points.begin(), points.begin() + std::min(side, count));
+    PointCloud matrixCloud = PointCloud::fromPoints(matrixPoints);
+    side = matrixPoints.size();
+
+    const Point query(12.5, -7.25);
+    std::vector<double> loopDistances(count), cloudDistances(count);
+    std::vector<double> loopMatrix(side * side), cloudMatrix(side * side);
+
+    std::printf("%zu points, %zu x %zu distance matrix\n", count, side, side);
+    bench::Runner runner(bench::Options::fromArgs(argc, argv));
+
+    bench::Stats loopQuery = runner.run("distances (Point::distanceTo loop)", [&]
+                                        {
+        for (std::size_t i = 0; i < count; ++i)
+            loopDistances[i] = points[i].distanceTo(query);
+        bench::clobberMemory(); });
+    bench::Stats cloudQuery = runner.run("distances (PointCloud)", [&]
+                                         {
+        cloud.distancesTo({query.getX(), query.getY(), 0.0}, cloudDistances);
+        bench::clobberMemory(); });
+
+    bench::Stats loopAllPairs = runner.run("distance matrix (Point loop)", [&]
+                                           {
+        for (std::size_t i = 0; i < side; ++i)
+            for (std::size_t j = 0; j < side; ++j)
+                loopMatrix[i * side + j] = matrixPoints[i].distanceTo(matrixPoints[j]);
+        bench::clobberMemory(); });
+    bench::Stats cloudAllPairs = runner.run("distance matrix (PointCloud)", [&]
+                                            {
+        matrixCloud.distanceMatrix(matrixCloud, cloudMatrix);
+        bench::clobberMemory(); });
+
+    bench::Stats loopCentroid = runner.run("centroid (Point loop)", [&]
+                                           {
+        double sx = 0, sy = 0;
+        for (const Point &p : points)
+        {
+            sx += p.getX();
+            sy += p.getY();
+        }
+        bench::doNotOptimize(sx);
+        bench::doNotOptimize(sy); });
+    bench::Stats cloudCentroid = runner.run("centroid (PointCloud)", [&]
+                                            { bench::doNotOptimize(cloud.centroid()); });
+
+    bench::Stats loopBox = runner.run("bounding box (Point loop)", [&]
+                                      {
+        double minX = points[0].getX(), maxX = minX, minY = points[0].getY(), maxY = minY;
+        for (const Point &p : points)
+        {
+            minX = std::min(minX, p.getX());
+            maxX = std::max(maxX, p.getX());
+            minY = std::min(minY, p.getY());
+            maxY = std::max(maxY, p.getY());
+        }
+        bench::doNotOptimize(minX);
+        bench::doNotOptimize(maxX);
+        bench::doNotOptimize(minY);
+        bench::doNotOptimize(maxY); });
+    bench::Stats cloudBox = runner.run("bounding box (PointCloud)", [&]
+                                       { bench::doNotOptimize(cloud.boundingBox()); });
+
+    std::printf("\n%-24s %14s %14s %9s\n", "operation", "Point ns", "PointCloud ns", "speedup");
+    auto row = [](const char *name, const bench::Stats &loop, const bench::Stats &batch)
+    { std::printf("%-24s %14.0f %14.0f %8.1fx\n", name, loop.median, batch.median, loop.median / batch.median); };
+    row("distances", loopQuery, cloudQuery);
+    row("distance matrix", loopAllPairs, cloudAllPairs);
+    row("centroid", loopCentroid, cloudCentroid);
+    row("bounding box", loopBox, cloudBox);
+
+    // Both sides compute sqrt(dx*dx + dy*dy) in the same order, so this should print 0
+    double maxDifference = 0;
+    for (std::size_t i = 0; i < count; ++i)
+        maxDifference = std::max(maxDifference, std::abs(loopDistances[i] - cloudDistances[i]));
+    for (std::size_t i = 0; i < side * side; ++i)
+        maxDifference = std::max(maxDifference, std::abs(loopMatrix[i] - cloudMatrix[i]));
+    std::printf("\nmax |Point - PointCloud| distance difference: %g\n", maxDifference);
+
+    runner.finish();
+    return 0;
+}
@@ -0,0 +1,72 @@
+#include "microbench.hpp"
+#include "../ref_counted.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// intrusive_ptr and local_shared_ptr vs std::shared_ptr
+//
+//   ref_counted_benchmark [--samples=N] [--cpu=N] [--json=path] [--csv=path]
+//
+// Per pointer type: copy-assigning one pointer into 1000 slots that hold another (one count
+// up, one count down), moving a pointer back and forth, and creating and destroying an object.
+// Build with NDEBUG (a Release build) to measure without the thread checks.
+
+namespace
+{
+    struct Payload
+    {
+        int value = 0;
+    };
+
+    struct IntrusivePayload : ref_counted
+    {
+        int value = 0;
+    };
+
+    template <typename Pointer, typename Make>
+    void benchmarkPointer(bench::Runner &runner, const std::string &name, Make make)
+    {
+        Pointer first = make(), second = make();
+        std::vector<Pointer> slots(1000, first);
+
+        runner.run(name + " copy x1000", [&]
+                   {
+            // Alternating between the two objects so that every assignment changes both counts
+            for (auto &slot : slots)
+                slot = second;
+            for (auto &slot : slots)
+                slot = first;
+            bench::clobberMemory(); });
+
+        Pointer a = make(), b;
+        runner.run(name + " move x2", [&]
+                   {
+            b = std::move(a);
+            a = std::move(b);
+            bench::doNotOptimize(a); });
+
+        runner.run(name + " create + destroy", [&]
+                   {
+            Pointer created = make();
+            bench::doNotOptimize(created); });
+    }
+}
+
+int main(int argc, char **argv)
+{
+    bench::Runner runner(bench::Options::fromArgs(argc, argv));
+
+    benchmarkPointer<std::shared_ptr<Payload>>(runner, "shared_ptr (make_shared)", []
+                                               { return std::make_shared<Payload>(); });
+    benchmarkPointer<std::shared_ptr<Payload>>(runner, "shared_ptr (new)", []
+                                               { return std::shared_ptr<Payload>(new Payload()); });
+    benchmarkPointer<local_shared_ptr<Payload>>(runner, "local_shared_ptr", []
+                                                { return make_local_shared<Payload>(); });
+    benchmarkPointer<intrusive_ptr<IntrusivePayload>>(runner, "intrusive_ptr", []
+                                                      { return make_intrusive<IntrusivePayload>(); });
+
+    runner.finish();
+    return 0;
+}
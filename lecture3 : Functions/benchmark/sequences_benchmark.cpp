@@ -0,0 +1,124 @@
+#include "microbench.hpp"
+#include "../inline_examples.hpp"
+#include "../sequences.hpp"
+
+#include <cstdio>
+
+// Lookup tables and O(log n) Fibonacci from sequences.hpp vs the straightforward versions
+//
+//   sequences_benchmark [--samples=N] [--cpu=N] [--json=path] [--csv=path]
+//
+// Past the 64-bit table, fast doubling is compared with a linear loop and with the other
+// O(log n) method, raising [[1, 1], [1, 0]] to the n-th power.
+
+namespace
+{
+    using Sequences::uint128;
+
+    std::uint64_t loopFactorial(int n)
+    {
+        std::uint64_t value = 1;
+        for (int i = 2; i <= n; ++i)
+            value *= static_cast<std::uint64_t>(i);
+        return value;
+    }
+
+    uint128 loopFibonacci(int n)
+    {
+        uint128 previous = 0, current = 1;
+        if (n == 0)
+            return 0;
+        for (int i = 1; i < n; ++i)
+        {
+            uint128 next = previous + current;
+            previous = current;
+            current = next;
+        }
+        return current;
+    }
+
+    // [[F(n + 1), F(n)], [F(n), F(n - 1)]] = [[1, 1], [1, 0]]^n, by repeated squaring mod m
+    std::uint64_t matrixFibonacciMod(std::uint64_t n, std::uint64_t m)
+    {
+        uint128 result[2][2] = {{1 % m, 0}, {0, 1 % m}}, base[2][2] = {{1, 1}, {1, 0}};
+        auto multiply = [m](uint128 (&x)[2][2], const uint128 (&y)[2][2])
+        {
+            uint128 product[2][2];
+            for (int i = 0; i < 2; ++i)
+                for (int j = 0; j < 2; ++j)
+                    product[i][j] = (x[i][0] * y[0][j] % m + x[i][1] * y[1][j] % m) % m;
+            for (int i = 0; i < 2; ++i)
+                for (int j = 0; j < 2; ++j)
+                    x[i][j] = product[i][j];
+        };
+        for (; n != 0; n >>= 1)
+        {
+            if (n & 1)
+                multiply(result, base);
+            multiply(base, base);
+        }
+        return static_cast<std::uint64_t>(result[0][1]);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    bench::Runner runner(bench::Options::fromArgs(argc, argv));
+
+    int small = 20, large = 180;
+    std::uint64_t huge = 1000000000000000000ULL, modulus = 1000000007ULL;
+
+    runner.run("factorial(20) loop", [&]
+               {
+        bench::doNotOptimize(small);
+        bench::doNotOptimize(loopFactorial(small)); });
+    runner.run("factorial(20) table", [&]
+               {
+        bench::doNotOptimize(small);
+        bench::doNotOptimize(Sequences::factorial(small)); });
+
+    runner.run("fibonacci(20) recursive", [&]
+               {
+        bench::doNotOptimize(small);
+        bench::doNotOptimize(PoorInlineCandidates::fibonacci(small)); });
+    runner.run("fibonacci(20) table", [&]
+               {
+        bench::doNotOptimize(small);
+        bench::doNotOptimize(Sequences::fibonacci(small)); });
+
+    runner.run("fibonacci(180) loop", [&]
+               {
+        bench::doNotOptimize(large);
+        bench::doNotOptimize(loopFibonacci(large)); });
+    runner.run("fibonacci(180) fast doubling", [&]
+               {
+        bench::doNotOptimize(large);
+        bench::doNotOptimize(Sequences::fibonacci128(large)); });
+
+    runner.run("fibonacci(1e18) mod p, matrix power", [&]
+               {
+        bench::doNotOptimize(huge);
+        bench::doNotOptimize(matrixFibonacciMod(huge, modulus)); });
+    runner.run("fibonacci(1e18) mod p, fast doubling", [&]
+               {
+        bench::doNotOptimize(huge);
+        bench::doNotOptimize(Sequences::fibonacciMod(huge, modulus)); });
+
+    runner.finish();
+
+    // Every method must agree wherever they overlap
+    bool same = true;
+    for (int n = 0; n <= 20; ++n)
+        same = same && Sequences::factorial(n) == loopFactorial(n);
+    for (int n = 0; n <= 30; ++n)
+        same = same && Sequences::fibonacci(n) == static_cast<std::uint64_t>(PoorInlineCandidates::fibonacci(n));
+    for (int n = 0; n <= 186; ++n)
+        same = same && Sequences::fibonacci128(n) == loopFibonacci(n) &&
+               Sequences::fibonacciMod(n, modulus) == static_cast<std::uint64_t>(loopFibonacci(n) % modulus);
+    for (std::uint64_t n = huge; n < huge + 100; ++n)
+        same = same && Sequences::fibonacciMod(n, modulus) == matrixFibonacciMod(n, modulus);
+
+    std::printf("\nF(186) = %s\nF(1e18) mod 1e9+7 = %llu\nresults %s\n", Sequences::toString(Sequences::fibonacci128(186)).c_str(),
+                static_cast<unsigned long long>(Sequences::fibonacciMod(huge, modulus)), same ? "match" : "DO NOT MATCH");
+    return same ? 0 : 1;
+}
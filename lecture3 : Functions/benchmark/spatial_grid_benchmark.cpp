@@ -0,0 +1,160 @@
+#include "microbench.hpp"
+#include "../spatial_grid.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+// SpatialGrid vs a std::unordered_map keyed on cell coordinates
+//
+//   spatial_grid_benchmark [--count=N] [--cell=SIZE] [--threads=T] [--samples=N] [--cpu=N] [--json=path] [--csv=path]
+//
+// Points are 3D, uniform in a 100 x 100 x 10 box. Compares building the buckets, neighbour-cell
+// queries (3 x 3 x 3 cells) and voxel downsampling.
+
+namespace
+{
+    // The baseline: one heap-allocated vector of point indices per occupied cell
+    struct MapGrid
+    {
+        double cellSize;
+        std::unordered_map<std::uint64_t, std::vector<std::uint32_t>> cells;
+
+        static std::uint64_t key(std::int64_t x, std::int64_t y, std::int64_t z)
+        {
+            // 21 bits per axis with an offset, enough for the benchmark's coordinates
+            const std::int64_t bias = 1 << 20;
+            return static_cast<std::uint64_t>(x + bias) | static_cast<std::uint64_t>(y + bias) << 21 |
+                   static_cast<std::uint64_t>(z + bias) << 42;
+        }
+
+        std::int64_t cell(double value) const { return static_cast<std::int64_t>(std::floor(value / cellSize)); }
+
+        MapGrid(const PointCloud &cloud, double size) : cellSize(size)
+        {
+            auto xs = cloud.xs(), ys = cloud.ys(), zs = cloud.zs();
+            for (std::size_t i = 0; i < cloud.size(); ++i)
+                cells[key(cell(xs[i]), cell(ys[i]), cell(zs[i]))].push_back(static_cast<std::uint32_t>(i));
+        }
+
+        std::vector<std::uint32_t> neighborhood(const PointCloud::Coordinates &p) const
+        {
+            std::vector<std::uint32_t> found;
+            std::int64_t cx = cell(p[0]), cy = cell(p[1]), cz = cell(p[2]);
+            for (std::int64_t z = cz - 1; z <= cz + 1; ++z)
+                for (std::int64_t y = cy - 1; y <= cy + 1; ++y)
+                    for (std::int64_t x = cx - 1; x <= cx + 1; ++x)
+                        if (auto it = cells.find(key(x, y, z)); it != cells.end())
+                            found.insert(found.end(), it->second.begin(), it->second.end());
+            return found;
+        }
+    };
+
+    PointCloud mapDownsample(const PointCloud &cloud, double cellSize)
+    {
+        struct Sum
+        {
+            double x = 0, y = 0, z = 0;
+            std::size_t n = 0;
+        };
+        std::unordered_map<std::uint64_t, Sum> sums;
+        auto xs = cloud.xs(), ys = cloud.ys(), zs = cloud.zs();
+        auto cell = [cellSize](double v)
+        { return static_cast<std::int64_t>(std::floor(v / cellSize)); };
+        for (std::size_t i = 0; i < cloud.size(); ++i)
+        {
+            Sum &sum = sums[MapGrid::key(cell(xs[i]), cell(ys[i]), cell(zs[i]))];
+            sum.x += xs[i];
+            sum.y += ys[i];
+            sum.z += zs[i];
+            ++sum.n;
+        }
+        PointCloud thinned(3);
+        thinned.reserve(sums.size());
+        for (const auto &[key, sum] : sums)
+            thinned.push_back(sum.x / sum.n, sum.y / sum.n, sum.z / sum.n);
+        return thinned;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    std::size_t count = 1 << 20;
+    double cellSize = 0.5;
+    unsigned threads = 0;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strncmp(argv[i], "--count=", 8) == 0)
+            count = std::max<std::size_t>(1, std::strtoul(argv[i] + 8, nullptr, 10));
+        else if (std::strncmp(argv[i], "--cell=", 7) == 0)
+            cellSize = std::strtod(argv[i] + 7, nullptr);
+        else if (std::strncmp(argv[i], "--threads=", 10) == 0)
+            threads = static_cast<unsigned>(std::strtoul(argv[i] + 10, nullptr, 10));
+    }
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> wide(0.0, 100.0), flat(0.0, 10.0);
+    PointCloud cloud(3);
+    cloud.reserve(count);
+    for (std::size_t i = 0; i < count; ++i)
+        cloud.push_back(wide(rng), wide(rng), flat(rng));
+
+    std::vector<PointCloud::Coordinates> queries(1000);
+    for (auto &q : queries)
+        q = {wide(rng), wide(rng), flat(rng)};
+
+    bench::Runner runner(bench::Options::fromArgs(argc, argv));
+
+    bench::Stats gridBuild = runner.run("build (SpatialGrid)", [&]
+                                        {
+        SpatialGrid grid(cloud, cellSize, threads);
+        bench::doNotOptimize(grid); });
+    bench::Stats mapBuild = runner.run("build (unordered_map)", [&]
+                                       {
+        MapGrid grid(cloud, cellSize);
+        bench::doNotOptimize(grid); });
+
+    SpatialGrid grid(cloud, cellSize, threads);
+    MapGrid map(cloud, cellSize);
+
+    bench::Stats gridQuery = runner.run("1000 neighborhoods (SpatialGrid)", [&]
+                                        {
+        for (const auto &q : queries)
+            bench::doNotOptimize(grid.neighborhood(q).size()); });
+    bench::Stats mapQuery = runner.run("1000 neighborhoods (unordered_map)", [&]
+                                       {
+        for (const auto &q : queries)
+            bench::doNotOptimize(map.neighborhood(q).size()); });
+
+    bench::Stats gridThin = runner.run("downsample (SpatialGrid)", [&]
+                                       { bench::doNotOptimize(SpatialGrid::voxelDownsample(cloud, cellSize, threads)); });
+    bench::Stats mapThin = runner.run("downsample (unordered_map)", [&]
+                                      { bench::doNotOptimize(mapDownsample(cloud, cellSize)); });
+
+    // Both must see the same buckets
+    bool same = grid.cellCount() == map.cells.size() && grid.downsample(threads).size() == mapDownsample(cloud, cellSize).size();
+    for (const auto &q : queries)
+    {
+        auto fromGrid = grid.neighborhood(q), fromMap = map.neighborhood(q);
+        std::sort(fromGrid.begin(), fromGrid.end());
+        std::sort(fromMap.begin(), fromMap.end());
+        same = same && fromGrid == fromMap;
+    }
+
+    std::printf("\n%zu points, cell %.3g: %zu occupied cells, grid uses %.1f MiB\n", count, cellSize,
+                grid.cellCount(), grid.memoryBytes() / 1048576.0);
+    std::printf("%-22s %14s %16s %9s\n", "operation", "SpatialGrid ms", "unordered_map ms", "speedup");
+    auto row = [](const char *name, const bench::Stats &fast, const bench::Stats &slow)
+    { std::printf("%-22s %14.3f %16.3f %8.1fx\n", name, fast.median / 1e6, slow.median / 1e6, slow.median / fast.median); };
+    row("build", gridBuild, mapBuild);
+    row("1000 neighborhoods", gridQuery, mapQuery);
+    row("downsample", gridThin, mapThin);
+    std::printf("results %s\n", same ? "match" : "DO NOT MATCH");
+
+    runner.finish();
+    return same ? 0 : 1;
+}
@@ -0,0 +1,135 @@
+#include "microbench.hpp"
+#include "../string_builder.hpp"
+
+#include <cstdio>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// StringBuilder::cat vs chained operator+ and std::ostringstream
+//
+//   string_builder_benchmark [--samples=N] [--cpu=N] [--json=path] [--csv=path]
+//
+// Builds a 5-piece cache key and a 20-piece log line for each of 1024 records and reports
+// ns per string. Every variant must produce the same strings.
+
+namespace
+{
+    using StringBuilder::cat;
+
+    struct Record
+    {
+        std::string user;
+        std::string service;
+        std::string path;
+        long long id;
+        int status;
+        unsigned bytes;
+        int ms;
+    };
+
+    constexpr std::size_t recordCount = 1024;
+
+    std::vector<Record> makeRecords()
+    {
+        const char *users[] = {"alice", "bob", "carol_the_administrator", "dave"};
+        const char *services[] = {"auth", "billing", "search-frontend"};
+        const char *paths[] = {"/", "/api/v2/users/profile/settings", "/static/app.js", "/health"};
+        std::mt19937 rng(42);
+        std::vector<Record> records;
+        for (std::size_t i = 0; i < recordCount; ++i)
+            records.push_back(Record{users[rng() % 4], services[rng() % 3], paths[rng() % 4],
+                                     static_cast<long long>(rng()) * 1000 - 5000000000LL, static_cast<int>(200 + rng() % 400),
+                                     static_cast<unsigned>(rng() % 100000), static_cast<int>(rng() % 2000)});
+        return records;
+    }
+
+    // Cache key, 5 pieces
+    std::string keyPlus(const Record &r) { return r.service + ":" + r.user + ":" + std::to_string(r.id); }
+    std::string keyStream(const Record &r)
+    {
+        std::ostringstream os;
+        os << r.service << ':' << r.user << ':' << r.id;
+        return os.str();
+    }
+    std::string keyCat(const Record &r) { return cat(r.service, ':', r.user, ':', r.id); }
+
+    // Log line, 20 pieces
+    std::string linePlus(const Record &r)
+    {
+        return "[" + r.service + "] user=" + r.user + " id=" + std::to_string(r.id) + " path=\"" + r.path +
+               "\" status=" + std::to_string(r.status) + " bytes=" + std::to_string(r.bytes) + " time=" +
+               std::to_string(r.ms) + "ms" + " slow=" + (r.ms > 1000 ? "yes" : "no") + " done";
+    }
+    std::string lineStream(const Record &r)
+    {
+        std::ostringstream os;
+        os << '[' << r.service << "] user=" << r.user << " id=" << r.id << " path=\"" << r.path
+           << "\" status=" << r.status << " bytes=" << r.bytes << " time=" << r.ms << "ms"
+           << " slow=" << (r.ms > 1000 ? "yes" : "no") << " done";
+        return os.str();
+    }
+    std::string lineCat(const Record &r)
+    {
+        return cat('[', r.service, "] user=", r.user, " id=", r.id, " path=\"", r.path, "\" status=", r.status,
+                   " bytes=", r.bytes, " time=", r.ms, "ms", " slow=", r.ms > 1000 ? "yes" : "no", " done");
+    }
+    // The same with + on an expression, as in templateFunction
+    std::string lineExpression(const Record &r)
+    {
+        return cat('[') + r.service + "] user=" + r.user + " id=" + r.id + " path=\"" + r.path + "\" status=" +
+               r.status + " bytes=" + r.bytes + " time=" + r.ms + "ms" + " slow=" + (r.ms > 1000 ? "yes" : "no") +
+               " done";
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const std::vector<Record> records = makeRecords();
+
+    bench::Options options = bench::Options::fromArgs(argc, argv);
+    options.quiet = true;
+    bench::Runner runner(options);
+
+    using Builder = std::string (*)(const Record &);
+    struct Variant
+    {
+        const char *name;
+        Builder build;
+    };
+    const Variant keys[] = {{"key operator+", keyPlus}, {"key ostringstream", keyStream}, {"key cat()", keyCat}};
+    const Variant lines[] = {{"line operator+", linePlus},
+                             {"line ostringstream", lineStream},
+                             {"line cat()", lineCat},
+                             {"line cat() + ...", lineExpression}};
+
+    bool same = true;
+    auto measure = [&](const char *title, const auto &variants)
+    {
+        std::printf("%s\n%-24s %10s %9s\n", title, "variant", "ns/string", "speedup");
+        double baseline = 0;
+        for (const Variant &variant : variants)
+        {
+            for (const Record &r : records)
+                same = same && variant.build(r) == variants[0].build(r);
+            bench::Stats stats = runner.run(variant.name, [&]
+                                            {
+                for (const Record &r : records)
+                {
+                    std::string s = variant.build(r);
+                    bench::doNotOptimize(s);
+                } });
+            const double ns = stats.median / recordCount;
+            if (baseline == 0)
+                baseline = ns;
+            std::printf("%-24s %10.1f %8.1fx\n", variant.name, ns, baseline / ns);
+        }
+    };
+    measure("cache key, 5 pieces", keys);
+    measure("log line, 20 pieces", lines);
+    std::printf("results %s\n", same ? "match" : "DO NOT MATCH");
+
+    runner.finish();
+    return same ? 0 : 1;
+}
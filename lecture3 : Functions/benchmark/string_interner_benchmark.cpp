@@ -0,0 +1,176 @@
+#include "microbench.hpp"
+#include "../string_interner.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <new>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Interned symbols and transparent lookup vs std::string-keyed maps
+//
+//   string_interner_benchmark [--count=N] [--names=N] [--samples=N] [--cpu=N] [--json=path] [--csv=path]
+//
+// --names (default 500) metric-style names of 5-40 characters are looked up --count times
+// (default 1M), drawn with a Zipf-like distribution so a few names dominate, as field and
+// metric names do. Reports ns and heap allocations per lookup, and the memory of keeping one
+// key per record as std::string vs Symbol. Every variant must find the same values.
+
+namespace
+{
+    std::size_t allocations = 0;
+}
+
+// Counts heap allocations, to show which lookups allocate. Kept out of line: once inlined,
+// GCC sees the malloc and free behind new and delete and reports them as mismatched
+[[gnu::noinline]] void *operator new(std::size_t size)
+{
+    ++allocations;
+    if (void *p = std::malloc(size != 0 ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+[[gnu::noinline]] void operator delete(void *p) noexcept { std::free(p); }
+[[gnu::noinline]] void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+namespace
+{
+    std::vector<std::string> makeNames(std::size_t count, std::mt19937 &rng)
+    {
+        const char *services[] = {"auth", "db", "search", "billing_gateway", "frontend", "queue"};
+        const char *subjects[] = {"request", "connection", "cache", "disk", "cpu", "session_store"};
+        const char *measures[] = {"count", "errors", "latency_p99", "bytes_in", "retries", "ms"};
+        std::vector<std::string> names;
+        std::map<std::string, bool> seen;
+        while (names.size() < count)
+        {
+            std::string name;
+            name.reserve(48);
+            name.append(services[rng() % 6]).append(".").append(subjects[rng() % 6]).append(".");
+            name.append(measures[rng() % 6]);
+            if (rng() % 4 == 0)
+                name.append(".").append(std::to_string(rng() % 64));
+            if (!seen[name])
+            {
+                seen[name] = true;
+                names.push_back(std::move(name));
+            }
+        }
+        return names;
+    }
+
+    // P(rank k) proportional to 1 / k^1.1
+    std::vector<std::size_t> zipfIndices(std::size_t names, std::size_t count, std::mt19937 &rng)
+    {
+        std::vector<double> weights(names);
+        for (std::size_t k = 0; k < names; ++k)
+            weights[k] = 1.0 / std::pow(double(k + 1), 1.1);
+        std::discrete_distribution<std::size_t> rank(weights.begin(), weights.end());
+        std::vector<std::size_t> indices(count);
+        for (std::size_t &i : indices)
+            i = rank(rng);
+        return indices;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    std::size_t count = 1000000, nameCount = 500;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strncmp(argv[i], "--count=", 8) == 0)
+            count = std::max<std::size_t>(1, std::strtoull(argv[i] + 8, nullptr, 10));
+        else if (std::strncmp(argv[i], "--names=", 8) == 0)
+            nameCount = std::clamp<std::size_t>(std::strtoull(argv[i] + 8, nullptr, 10), 1, 10000);
+    }
+
+    std::mt19937 rng(42);
+    const std::vector<std::string> names = makeNames(nameCount, rng);
+    const std::vector<std::size_t> indices = zipfIndices(names.size(), count, rng);
+
+    // The keys as they arrive, e.g. parsed out of a text buffer
+    std::vector<std::string_view> keys(count);
+    for (std::size_t i = 0; i < count; ++i)
+        keys[i] = names[indices[i]];
+
+    std::map<std::string, int> plainMap;
+    StringMap<int> transparentMap;
+    std::unordered_map<std::string, int> plainHash;
+    StringHashMap<int> transparentHash;
+    StringInterner interner;
+    SymbolMap<int> symbolMap;
+    for (std::size_t k = 0; k < names.size(); ++k)
+    {
+        const int value = static_cast<int>(k) + 1;
+        plainMap[names[k]] = transparentMap[names[k]] = plainHash[names[k]] = transparentHash[names[k]] = value;
+        symbolMap[interner.intern(names[k])] = value;
+    }
+    // Records that keep their key as a symbol
+    std::vector<Symbol> symbols(count);
+    for (std::size_t i = 0; i < count; ++i)
+        symbols[i] = *interner.find(keys[i]);
+
+    bench::Options options = bench::Options::fromArgs(argc, argv);
+    options.quiet = true;
+    bench::Runner runner(options);
+
+    long long expected = -1;
+    bool same = true;
+    std::printf("%zu lookups of %zu names\n%-42s %10s %12s %9s\n", count, names.size(), "lookup", "ns/lookup",
+                "allocs/lookup", "speedup");
+    double baseline = 0;
+    auto measure = [&](const char *name, auto lookup)
+    {
+        allocations = 0;
+        long long sum = 0;
+        for (std::size_t i = 0; i < count; ++i)
+            sum += lookup(i);
+        const double allocsPerLookup = double(allocations) / double(count);
+        if (expected < 0)
+            expected = sum;
+        same = same && sum == expected;
+
+        bench::Stats stats = runner.run(name, [&]
+                                        {
+            long long total = 0;
+            for (std::size_t i = 0; i < count; ++i)
+                total += lookup(i);
+            bench::doNotOptimize(total); });
+        const double ns = stats.median / double(count);
+        if (baseline == 0)
+            baseline = ns;
+        std::printf("%-42s %10.1f %12.2f %8.1fx\n", name, ns, allocsPerLookup, baseline / ns);
+    };
+
+    measure("std::map find(std::string(key))", [&](std::size_t i)
+            { return plainMap.find(std::string(keys[i]))->second; });
+    measure("StringMap find(key)", [&](std::size_t i)
+            { return transparentMap.find(keys[i])->second; });
+    measure("std::unordered_map find(std::string(key))", [&](std::size_t i)
+            { return plainHash.find(std::string(keys[i]))->second; });
+    measure("StringHashMap find(key)", [&](std::size_t i)
+            { return transparentHash.find(keys[i])->second; });
+    measure("interner.find(key) + SymbolMap", [&](std::size_t i)
+            { return *symbolMap.find(*interner.find(keys[i])); });
+    measure("SymbolMap find(symbol)", [&](std::size_t i)
+            { return *symbolMap.find(symbols[i]); });
+
+    // One key per record: a std::string (plus its heap buffer past 15 characters) vs a Symbol
+    // and, once, the interner
+    std::size_t stringBytes = 0;
+    for (std::string_view key : keys)
+        stringBytes += sizeof(std::string) + (key.size() > 15 ? key.size() + 1 : 0);
+    const std::size_t symbolBytes = count * sizeof(Symbol) + interner.memoryUsage();
+    std::printf("keys as std::string: %.1f MiB, as Symbol + interner: %.1f MiB (%.1fx less)\n",
+                stringBytes / 1048576.0, symbolBytes / 1048576.0, double(stringBytes) / double(symbolBytes));
+    std::printf("results %s\n", same ? "match" : "DO NOT MATCH");
+
+    runner.finish();
+    return same ? 0 : 1;
+}
@@ -0,0 +1,105 @@
+#include "microbench.hpp"
+#include "../inline_examples.hpp"
+#include "../string_transform.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+// StringTransform vs PoorInlineCandidates::process_string
+//
+//   string_transform_benchmark [--mib=N] [--samples=N] [--cpu=N] [--json=path] [--csv=path]
+//
+// The text (default 16 MiB) is mostly words, digits, spaces and punctuation, with a UTF-8
+// character every few hundred bytes so the scalar fallback is exercised too. Reports GB/s of
+// input for each implementation and for a batch of short lines, and checks that every output
+// is byte-identical to process_string.
+
+namespace
+{
+    std::string makeText(std::size_t bytes, std::mt19937 &rng)
+    {
+        const char *pieces[] = {"the", "Quick", "BROWN", "fox", "42", "jumps", "over", "Lazy", "dogs", "2024", "x", "MiXeD"};
+        const char *separators[] = {" ", " ", " ", ", ", ". ", "\n", " - ", "!"};
+        std::uniform_int_distribution<std::size_t> piece(0, std::size(pieces) - 1), separator(0, std::size(separators) - 1);
+        std::uniform_int_distribution<int> rare(0, 63);
+        std::string text;
+        text.reserve(bytes + 16);
+        while (text.size() < bytes)
+        {
+            text += pieces[piece(rng)];
+            text += rare(rng) == 0 ? "\xc3\xa9" : separators[separator(rng)]; // é
+        }
+        text.resize(bytes);
+        return text;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    std::size_t mib = 16;
+    for (int i = 1; i < argc; ++i)
+        if (std::strncmp(argv[i], "--mib=", 6) == 0)
+            mib = std::max<std::size_t>(1, std::strtoul(argv[i] + 6, nullptr, 10));
+
+    std::mt19937 rng(42);
+    const std::string text = makeText(mib << 20, rng);
+    const std::string expected = PoorInlineCandidates::process_string(text);
+
+    // Short lines for the batch API
+    std::vector<std::string_view> lines;
+    for (std::size_t start = 0; start < text.size();)
+    {
+        std::size_t length = std::min<std::size_t>(std::uniform_int_distribution<std::size_t>(8, 200)(rng), text.size() - start);
+        lines.push_back(std::string_view(text).substr(start, length));
+        start += length;
+    }
+
+    bench::Options options = bench::Options::fromArgs(argc, argv);
+    options.quiet = true;
+    bench::Runner runner(options);
+    const double bytes = static_cast<double>(text.size());
+    bool same = true;
+
+    std::printf("%zu MiB of text, %zu lines\n%-28s %10s %9s\n", mib, lines.size(), "implementation", "GB/s", "speedup");
+    bench::Stats baseline = runner.run("process_string", [&]
+                                       { bench::doNotOptimize(PoorInlineCandidates::process_string(text)); });
+    std::printf("%-28s %10.3f %8.1fx\n", "process_string", bytes / baseline.median, 1.0);
+
+    std::string out(text.size(), '\0');
+    for (StringTransform::Isa isa : StringTransform::allIsas)
+    {
+        if (!StringTransform::isSupported(isa))
+            continue;
+        const std::string name = std::string("processInto (") + StringTransform::isaName(isa) + ")";
+        std::size_t length = 0;
+        bench::Stats stats = runner.run(name, [&]
+                                        {
+            length = StringTransform::processInto(text, out.data(), isa);
+            bench::clobberMemory(); });
+        same = same && std::string_view(out).substr(0, length) == expected;
+        std::printf("%-28s %10.3f %8.1fx\n", name.c_str(), bytes / stats.median, baseline.median / stats.median);
+    }
+
+    bench::Stats perLine = runner.run("process_string per line", [&]
+                                      {
+        for (std::string_view line : lines)
+            bench::doNotOptimize(PoorInlineCandidates::process_string(std::string(line))); });
+    StringTransform::Batch batch;
+    bench::Stats batched = runner.run("processBatch", [&]
+                                      {
+        StringTransform::processBatch(lines, batch);
+        bench::clobberMemory(); });
+    std::printf("%-28s %10.3f %8.1fx\n", "process_string per line", bytes / perLine.median, 1.0);
+    std::printf("%-28s %10.3f %8.1fx\n", "processBatch", bytes / batched.median, perLine.median / batched.median);
+
+    for (std::size_t i = 0; i < lines.size(); ++i)
+        same = same && batch[i] == PoorInlineCandidates::process_string(std::string(lines[i]));
+    std::printf("results %s\n", same ? "match" : "DO NOT MATCH");
+
+    runner.finish();
+    return same ? 0 : 1;
+}
@@ -0,0 +1,279 @@
+#include "char_class.hpp"
+#include "parallel_chunks.hpp"
+
+#include <bit>
+#include <mutex>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CHAR_CLASS_X86 1
+#endif
+
+namespace CharClass
+{
+    Counts &Counts::operator+=(const Counts &other)
+    {
+        bytes += other.bytes;
+        vowels += other.vowels;
+        consonants += other.consonants;
+        digits += other.digits;
+        alphabetic += other.alphabetic;
+        whitespace += other.whitespace;
+        return *this;
+    }
+
+    Counts countScalar(std::string_view text)
+    {
+        // How often each combination of class bits occurs; the classes are summed up at the
+        // end. Four histograms so that runs of the same byte do not wait on one counter.
+        std::size_t histogram[4][32] = {};
+        const auto *bytes = reinterpret_cast<const unsigned char *>(text.data());
+        std::size_t k = 0;
+        for (; k + 4 <= text.size(); k += 4)
+        {
+            ++histogram[0][table[bytes[k]]];
+            ++histogram[1][table[bytes[k + 1]]];
+            ++histogram[2][table[bytes[k + 2]]];
+            ++histogram[3][table[bytes[k + 3]]];
+        }
+        for (; k < text.size(); ++k)
+            ++histogram[0][table[bytes[k]]];
+
+        Counts counts;
+        counts.bytes = text.size();
+        for (unsigned bits = 0; bits < 32; ++bits)
+        {
+            std::size_t n = histogram[0][bits] + histogram[1][bits] + histogram[2][bits] + histogram[3][bits];
+            counts.vowels += bits & Vowel ? n : 0;
+            counts.consonants += bits & Consonant ? n : 0;
+            counts.digits += bits & Digit ? n : 0;
+            counts.alphabetic += bits & Alpha ? n : 0;
+            counts.whitespace += bits & Whitespace ? n : 0;
+        }
+        return counts;
+    }
+
+    namespace
+    {
+#ifdef CHAR_CLASS_X86
+        // Nibble tables. Each class is split into parts of the form "high nibble in H and low
+        // nibble in L", one bit per part; a byte's bits are lowNibble[lo] & highNibble[hi].
+        //   bit 0: vowels  a e i o (and upper case): high 4 or 6, low 1 5 9 F
+        //   bit 1: vowel   u (and U):                high 5 or 7, low 5
+        //   bit 2: letters a-o, A-O:                 high 4 or 6, low 1-F
+        //   bit 3: letters p-z, P-Z:                 high 5 or 7, low 0-A
+        //   bit 4: digits:                           high 3,      low 0-9
+        //   bit 5: \t \n \v \f \r:                   high 0,      low 9-D
+        //   bit 6: space:                            high 2,      low 0
+        // High nibbles 8-F have no bits, so bytes >= 0x80 are in no class.
+        constexpr std::uint8_t vowelBits = 0x03, alphaBits = 0x0C, digitBits = 0x10, spaceBits = 0x60;
+
+        constexpr std::array<std::uint8_t, 16> makeLowNibble()
+        {
+            std::array<std::uint8_t, 16> low{};
+            for (int n = 0; n < 16; ++n)
+                low[n] = static_cast<std::uint8_t>((n == 1 || n == 5 || n == 9 || n == 0xF ? 0x01 : 0) | (n == 5 ? 0x02 : 0) |
+                                                   (n >= 1 ? 0x04 : 0) | (n <= 0xA ? 0x08 : 0) | (n <= 9 ? 0x10 : 0) |
+                                                   (n >= 9 && n <= 0xD ? 0x20 : 0) | (n == 0 ? 0x40 : 0));
+            return low;
+        }
+
+        constexpr std::array<std::uint8_t, 16> makeHighNibble()
+        {
+            std::array<std::uint8_t, 16> high{};
+            high[0x0] = 0x20;
+            high[0x2] = 0x40;
+            high[0x3] = 0x10;
+            high[0x4] = high[0x6] = 0x01 | 0x04;
+            high[0x5] = high[0x7] = 0x02 | 0x08;
+            return high;
+        }
+
+        constexpr std::array<std::uint8_t, 16> lowNibble = makeLowNibble(), highNibble = makeHighNibble();
+
+        // The table and the nibble tables must agree on every byte
+        constexpr bool nibbleTablesMatch()
+        {
+            for (int c = 0; c < 256; ++c)
+            {
+                const std::uint8_t bits = lowNibble[c & 0xF] & highNibble[c >> 4];
+                if (bool(bits & vowelBits) != bool(table[c] & Vowel) || bool(bits & alphaBits) != bool(table[c] & Alpha) ||
+                    bool(bits & digitBits) != bool(table[c] & Digit) || bool(bits & spaceBits) != bool(table[c] & Whitespace))
+                    return false;
+            }
+            return true;
+        }
+        static_assert(nibbleTablesMatch());
+
+        // Per-lane byte counters (+1 per member) can take 255 blocks before they must be
+        // widened; _mm_sad_epu8 against zero sums 8 bytes into one 64-bit lane.
+
+        __attribute__((target("ssse3"))) Counts countSsse3(const char *text, std::size_t n)
+        {
+            const __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lowNibble.data()));
+            const __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i *>(highNibble.data()));
+            const __m128i nibble = _mm_set1_epi8(0x0F), one = _mm_set1_epi8(1), zero = _mm_setzero_si128();
+            const __m128i masks[4] = {_mm_set1_epi8(vowelBits), _mm_set1_epi8(alphaBits), _mm_set1_epi8(digitBits), _mm_set1_epi8(spaceBits)};
+            __m128i totals[4] = {zero, zero, zero, zero};
+
+            std::size_t k = 0;
+            while (k + 16 <= n)
+            {
+                __m128i lanes[4] = {zero, zero, zero, zero};
+                for (int step = 0; step < 255 && k + 16 <= n; ++step, k += 16)
+                {
+                    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text + k));
+                    // Bytes >= 0x80 shift to a high nibble of 8-F, whose entries are 0
+                    __m128i bits = _mm_and_si128(_mm_shuffle_epi8(low, _mm_and_si128(v, nibble)),
+                                                 _mm_shuffle_epi8(high, _mm_and_si128(_mm_srli_epi16(v, 4), nibble)));
+                    for (int c = 0; c < 4; ++c)
+                        lanes[c] = _mm_add_epi8(lanes[c], _mm_min_epu8(_mm_and_si128(bits, masks[c]), one));
+                }
+                for (int c = 0; c < 4; ++c)
+                    totals[c] = _mm_add_epi64(totals[c], _mm_sad_epu8(lanes[c], zero));
+            }
+
+            std::size_t sums[4];
+            for (int c = 0; c < 4; ++c)
+                sums[c] = static_cast<std::size_t>(_mm_cvtsi128_si64(totals[c]) + _mm_cvtsi128_si64(_mm_unpackhi_epi64(totals[c], totals[c])));
+            Counts counts = countScalar(std::string_view(text + k, n - k));
+            counts.bytes += k;
+            counts.vowels += sums[0];
+            counts.alphabetic += sums[1];
+            counts.consonants += sums[1] - sums[0];
+            counts.digits += sums[2];
+            counts.whitespace += sums[3];
+            return counts;
+        }
+
+        __attribute__((target("avx2"))) Counts countAvx2(const char *text, std::size_t n)
+        {
+            const __m256i low = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(lowNibble.data())));
+            const __m256i high = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(highNibble.data())));
+            const __m256i nibble = _mm256_set1_epi8(0x0F), one = _mm256_set1_epi8(1), zero = _mm256_setzero_si256();
+            const __m256i masks[4] = {_mm256_set1_epi8(vowelBits), _mm256_set1_epi8(alphaBits), _mm256_set1_epi8(digitBits), _mm256_set1_epi8(spaceBits)};
+            __m256i totals[4] = {zero, zero, zero, zero};
+
+            std::size_t k = 0;
+            while (k + 32 <= n)
+            {
+                __m256i lanes[4] = {zero, zero, zero, zero};
+                for (int step = 0; step < 255 && k + 32 <= n; ++step, k += 32)
+                {
+                    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(text + k));
+                    __m256i bits = _mm256_and_si256(_mm256_shuffle_epi8(low, _mm256_and_si256(v, nibble)),
+                                                    _mm256_shuffle_epi8(high, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble)));
+                    for (int c = 0; c < 4; ++c)
+                        lanes[c] = _mm256_add_epi8(lanes[c], _mm256_min_epu8(_mm256_and_si256(bits, masks[c]), one));
+                }
+                for (int c = 0; c < 4; ++c)
+                    totals[c] = _mm256_add_epi64(totals[c], _mm256_sad_epu8(lanes[c], zero));
+            }
+
+            std::size_t sums[4];
+            for (int c = 0; c < 4; ++c)
+            {
+                __m128i pair = _mm_add_epi64(_mm256_castsi256_si128(totals[c]), _mm256_extracti128_si256(totals[c], 1));
+                sums[c] = static_cast<std::size_t>(_mm_cvtsi128_si64(pair) + _mm_cvtsi128_si64(_mm_unpackhi_epi64(pair, pair)));
+            }
+            Counts counts = countScalar(std::string_view(text + k, n - k));
+            counts.bytes += k;
+            counts.vowels += sums[0];
+            counts.alphabetic += sums[1];
+            counts.consonants += sums[1] - sums[0];
+            counts.digits += sums[2];
+            counts.whitespace += sums[3];
+            return counts;
+        }
+
+// The merge source of _mm512_broadcast_i32x4 is a deliberately uninitialized vector that the
+// instruction never reads, but GCC 12 reports it once the intrinsic is inlined here
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+        // With mask registers, each class is one test and one popcount per 64 bytes
+        __attribute__((target("avx512bw,popcnt"))) Counts countAvx512(const char *text, std::size_t n)
+        {
+            const __m512i low = _mm512_broadcast_i32x4(_mm_loadu_si128(reinterpret_cast<const __m128i *>(lowNibble.data())));
+            const __m512i high = _mm512_broadcast_i32x4(_mm_loadu_si128(reinterpret_cast<const __m128i *>(highNibble.data())));
+            const __m512i nibble = _mm512_set1_epi8(0x0F);
+            const __m512i vowelMask = _mm512_set1_epi8(vowelBits), alphaMask = _mm512_set1_epi8(alphaBits);
+            const __m512i digitMask = _mm512_set1_epi8(digitBits), spaceMask = _mm512_set1_epi8(spaceBits);
+            std::size_t sums[4] = {};
+
+            std::size_t k = 0;
+            for (; k + 64 <= n; k += 64)
+            {
+                __m512i v = _mm512_loadu_si512(text + k);
+                __m512i bits = _mm512_and_si512(_mm512_shuffle_epi8(low, _mm512_and_si512(v, nibble)),
+                                                _mm512_shuffle_epi8(high, _mm512_and_si512(_mm512_srli_epi16(v, 4), nibble)));
+                sums[0] += std::popcount(_mm512_test_epi8_mask(bits, vowelMask));
+                sums[1] += std::popcount(_mm512_test_epi8_mask(bits, alphaMask));
+                sums[2] += std::popcount(_mm512_test_epi8_mask(bits, digitMask));
+                sums[3] += std::popcount(_mm512_test_epi8_mask(bits, spaceMask));
+            }
+
+            Counts counts = countScalar(std::string_view(text + k, n - k));
+            counts.bytes += k;
+            counts.vowels += sums[0];
+            counts.alphabetic += sums[1];
+            counts.consonants += sums[1] - sums[0];
+            counts.digits += sums[2];
+            counts.whitespace += sums[3];
+            return counts;
+        }
+#pragma GCC diagnostic pop
+#endif
+
+        Counts countTable(const char *text, std::size_t n) { return countScalar(std::string_view(text, n)); }
+
+        using Kernel = Counts (*)(const char *, std::size_t);
+
+        struct Choice
+        {
+            Kernel kernel;
+            const char *name;
+        };
+
+        const Choice &choice()
+        {
+            static const Choice chosen = []() -> Choice
+            {
+#ifdef CHAR_CLASS_X86
+                __builtin_cpu_init();
+                if (__builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("popcnt"))
+                    return {countAvx512, "avx512"};
+                if (__builtin_cpu_supports("avx2"))
+                    return {countAvx2, "avx2"};
+                if (__builtin_cpu_supports("ssse3"))
+                    return {countSsse3, "ssse3"};
+#endif
+                return {countTable, "scalar"};
+            }();
+            return chosen;
+        }
+
+        // Below this a buffer is not worth splitting across threads
+        constexpr std::size_t parallelChunk = 1 << 20;
+    }
+
+    Counts countSimd(std::string_view text) { return choice().kernel(text.data(), text.size()); }
+
+    const char *simdIsa() { return choice().name; }
+
+    Counts count(std::string_view text, unsigned threads)
+    {
+        const std::size_t chunks = (text.size() + parallelChunk - 1) / parallelChunk;
+        if (chunks <= 1)
+            return countSimd(text);
+
+        Counts total;
+        std::mutex merge;
+        parallelChunks(chunks, threads, [&](std::size_t first, std::size_t last)
+                       {
+            const std::size_t begin = first * parallelChunk, end = std::min(text.size(), last * parallelChunk);
+            Counts part = countSimd(text.substr(begin, end - begin));
+            std::lock_guard<std::mutex> lock(merge);
+            total += part; });
+        return total;
+    }
+}
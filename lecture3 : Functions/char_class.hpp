@@ -0,0 +1,78 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Character-class statistics over large buffers
+//
+// InlineCandidates::is_vowel compares a character with ten literals. For counting classes
+// over a whole corpus, CharClass looks each byte up once in a 256-entry table of class bits
+// and counts every class in the same pass. count() goes further: it classifies 16, 32 or 64
+// bytes per step with two pshufb lookups (one on the low nibble, one on the high nibble, the
+// class bits being the AND of both) and splits large buffers across threads.
+//
+//     CharClass::Counts c = CharClass::count(text);
+//     std::printf("%zu vowels, %zu digits\n", c.vowels, c.digits);
+//
+// The classes are ASCII, as in the "C" locale: alphabetic is A-Z and a-z, whitespace is
+// " \t\n\v\f\r", and bytes >= 0x80 belong to no class.
+
+namespace CharClass
+{
+    enum Class : std::uint8_t
+    {
+        Vowel = 1,
+        Consonant = 2,
+        Digit = 4,
+        Alpha = 8,
+        Whitespace = 16
+    };
+
+    constexpr std::array<std::uint8_t, 256> makeTable()
+    {
+        std::array<std::uint8_t, 256> table{};
+        for (int c = 0; c < 128; ++c)
+        {
+            const bool alpha = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+            const int lower = alpha ? (c | 0x20) : 0;
+            const bool vowel = lower == 'a' || lower == 'e' || lower == 'i' || lower == 'o' || lower == 'u';
+            table[c] = static_cast<std::uint8_t>((vowel ? Vowel : 0) | (alpha && !vowel ? Consonant : 0) |
+                                                 (c >= '0' && c <= '9' ? Digit : 0) | (alpha ? Alpha : 0) |
+                                                 (c == ' ' || (c >= '\t' && c <= '\r') ? Whitespace : 0));
+        }
+        return table;
+    }
+
+    // Class bits of every byte value
+    inline constexpr std::array<std::uint8_t, 256> table = makeTable();
+
+    // Same answers as InlineCandidates::is_vowel, one load instead of up to ten compares
+    inline bool isVowel(char c) { return table[static_cast<unsigned char>(c)] & Vowel; }
+    inline bool is(char c, Class cls) { return table[static_cast<unsigned char>(c)] & cls; }
+
+    struct Counts
+    {
+        std::size_t bytes = 0;
+        std::size_t vowels = 0;
+        std::size_t consonants = 0;
+        std::size_t digits = 0;
+        std::size_t alphabetic = 0;
+        std::size_t whitespace = 0;
+
+        Counts &operator+=(const Counts &other);
+        bool operator==(const Counts &other) const = default;
+    };
+
+    // One table lookup per byte
+    Counts countScalar(std::string_view text);
+
+    // Nibble-shuffle version on one thread, for the best of SSSE3/AVX2/AVX-512BW the CPU has
+    Counts countSimd(std::string_view text);
+    const char *simdIsa();
+
+    // countSimd over chunks of `text` on several threads (threads == 0: one per hardware
+    // thread); small inputs stay on the calling thread
+    Counts count(std::string_view text, unsigned threads = 0);
+}
@@ -0,0 +1,100 @@
+# Runtime comparison of build modes, run by the optimization_report target (cmake -P)
+#
+# Builds the benchmarks in BUILD_DIR/<mode> for
+#   O2      the default Release build
+#   O3      -O3
+#   LTO     -O2 with link-time optimization
+#   PGO     -O2 with profile-guided optimization (two-stage, see pgo.cmake)
+#   NATIVE  -O2 -march=native, when NATIVE is ON
+# runs each benchmark pinned to CPU 0 and compares every mode with O2 using bench_compare.
+#
+# Inputs: SOURCE_DIR BUILD_DIR COMPILER GENERATOR BENCHMARKS (comma-separated) NATIVE
+
+function(run)
+    execute_process(COMMAND ${ARGN} RESULT_VARIABLE result)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "optimization_report: failed (${result}): ${ARGN}")
+    endif()
+endfunction()
+
+string(REPLACE "," ";" benchmarks "${BENCHMARKS}")
+set(modes O2 O3 LTO PGO)
+set(O2_settings -DOPT_LEVEL=O2)
+set(O3_settings -DOPT_LEVEL=O3)
+set(LTO_settings -DOPT_LEVEL=O2 -DENABLE_LTO=ON)
+set(NATIVE_settings -DOPT_LEVEL=O2 -DENABLE_NATIVE=ON)
+if(NATIVE)
+    list(APPEND modes NATIVE)
+endif()
+
+foreach(mode IN LISTS modes)
+    set(dir "${BUILD_DIR}/${mode}")
+    message(STATUS "optimization_report: building ${mode}")
+    if(mode STREQUAL "PGO")
+        run(${CMAKE_COMMAND} "-DSOURCE_DIR=${SOURCE_DIR}" "-DBUILD_DIR=${dir}" "-DCOMPILER=${COMPILER}"
+            "-DGENERATOR=${GENERATOR}" -DOPT_LEVEL=O2 -DENABLE_LTO=OFF -DENABLE_NATIVE=OFF
+            -P "${CMAKE_CURRENT_LIST_DIR}/pgo.cmake")
+    else()
+        # Every other setting is given explicitly, so a reused directory cannot keep an old one
+        run(${CMAKE_COMMAND} -S "${SOURCE_DIR}" -B "${dir}" -G "${GENERATOR}" -DCMAKE_BUILD_TYPE=Release
+            "-DCMAKE_CXX_COMPILER=${COMPILER}" -DENABLE_LTO=OFF -DENABLE_NATIVE=OFF -DPGO=OFF ${${mode}_settings})
+        run(${CMAKE_COMMAND} --build "${dir}" --target ${benchmarks} bench_compare)
+    endif()
+
+    foreach(benchmark IN LISTS benchmarks)
+        message(STATUS "optimization_report: ${mode} ${benchmark}")
+        execute_process(COMMAND "${dir}/${benchmark}" --cpu=0 --quiet "--json=${benchmark}.json"
+                        WORKING_DIRECTORY "${dir}" OUTPUT_QUIET RESULT_VARIABLE result)
+        if(NOT result EQUAL 0)
+            message(WARNING "optimization_report: ${mode} ${benchmark} exited with ${result}")
+        endif()
+    endforeach()
+endforeach()
+
+function(pad text width out)
+    string(LENGTH "${text}" length)
+    while(length LESS width)
+        string(PREPEND text " ")
+        math(EXPR length "${length} + 1")
+    endwhile()
+    set(${out} "${text}" PARENT_SCOPE)
+endfunction()
+
+# bench_compare exits with 1 on regressions, which here are results, not errors
+foreach(mode IN LISTS modes)
+    if(NOT mode STREQUAL "O2")
+        foreach(benchmark IN LISTS benchmarks)
+            message("\n=== ${benchmark}: ${mode} vs O2 ===")
+            execute_process(COMMAND "${BUILD_DIR}/O2/bench_compare" "${BUILD_DIR}/O2/${benchmark}.json"
+                                    "${BUILD_DIR}/${mode}/${benchmark}.json"
+                            OUTPUT_VARIABLE comparison)
+            message("${comparison}")
+            if(comparison MATCHES "geometric mean change: ([-+0-9.]+%)")
+                set(${mode}_${benchmark} "${CMAKE_MATCH_1}")
+            else()
+                set(${mode}_${benchmark} "n/a")
+            endif()
+        endforeach()
+    endif()
+endforeach()
+
+message("\n=== Geometric mean of time per benchmark, change vs O2 (negative is faster) ===")
+set(header "                              ")
+foreach(mode IN LISTS modes)
+    if(NOT mode STREQUAL "O2")
+        pad("${mode}" 10 cell)
+        string(APPEND header "${cell}")
+    endif()
+endforeach()
+message("${header}")
+foreach(benchmark IN LISTS benchmarks)
+    set(line "${benchmark}                              ")
+    string(SUBSTRING "${line}" 0 30 line)
+    foreach(mode IN LISTS modes)
+        if(NOT mode STREQUAL "O2")
+            pad("${${mode}_${benchmark}}" 10 cell)
+            string(APPEND line "${cell}")
+        endif()
+    endforeach()
+    message("${line}")
+endforeach()
@@ -0,0 +1,41 @@
+# Two-stage profile-guided build, run by the pgo target (cmake -P):
+#   1. configure BUILD_DIR with PGO=GENERATE and build everything instrumented
+#   2. run the training workload there: run_all_examples, then the train target
+#   3. reconfigure the same directory with PGO=USE and rebuild, so every object file finds
+#      the profile recorded under its own path
+#
+# Inputs: SOURCE_DIR BUILD_DIR COMPILER GENERATOR OPT_LEVEL ENABLE_LTO ENABLE_NATIVE
+
+function(run)
+    execute_process(COMMAND ${ARGN} RESULT_VARIABLE result)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "pgo: failed (${result}): ${ARGN}")
+    endif()
+endfunction()
+
+set(profiles "${BUILD_DIR}/profiles")
+set(settings -DCMAKE_BUILD_TYPE=Release "-DCMAKE_CXX_COMPILER=${COMPILER}" -DOPT_LEVEL=${OPT_LEVEL}
+    -DENABLE_LTO=${ENABLE_LTO} -DENABLE_NATIVE=${ENABLE_NATIVE} "-DPGO_PROFILE_DIR=${profiles}")
+
+# Stale counts from an earlier run would be added to the new ones
+file(REMOVE_RECURSE "${profiles}")
+
+message(STATUS "pgo: instrumented build in ${BUILD_DIR}")
+run(${CMAKE_COMMAND} -S "${SOURCE_DIR}" -B "${BUILD_DIR}" -G "${GENERATOR}" ${settings} -DPGO=GENERATE)
+run(${CMAKE_COMMAND} --build "${BUILD_DIR}")
+
+message(STATUS "pgo: training")
+run(${CMAKE_COMMAND} --build "${BUILD_DIR}" --target run_all_examples)
+run(${CMAKE_COMMAND} --build "${BUILD_DIR}" --target train)
+
+# Clang writes raw profiles that must be merged first
+if(COMPILER MATCHES "clang")
+    find_program(LLVM_PROFDATA NAMES llvm-profdata REQUIRED)
+    file(GLOB raw "${profiles}/*.profraw")
+    run(${LLVM_PROFDATA} merge "-output=${profiles}/default.profdata" ${raw})
+endif()
+
+message(STATUS "pgo: optimized build with the profiles")
+run(${CMAKE_COMMAND} -S "${SOURCE_DIR}" -B "${BUILD_DIR}" ${settings} -DPGO=USE)
+run(${CMAKE_COMMAND} --build "${BUILD_DIR}")
+message(STATUS "pgo: done, binaries in ${BUILD_DIR}")
@@ -0,0 +1,185 @@
+#include "complex_batch.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace ComplexBatch
+{
+    namespace
+    {
+        // GCC vector extensions: written once, compiled to SSE2, AVX2 or AVX-512 per clone
+        typedef double Doubles __attribute__((vector_size(32)));
+        typedef std::int64_t Int64s __attribute__((vector_size(32)));
+
+        constexpr int lanes = sizeof(Doubles) / sizeof(double); // 4
+        constexpr int block = 2 * lanes;                         // two independent vectors per step
+
+        // pi/2 split into three parts: n * pio2_1 is exact for the n we reduce with (fdlibm)
+        constexpr double twoOverPi = 6.36619772367581382433e-01;
+        constexpr double pio2_1 = 1.57079632673412561417e+00;
+        constexpr double pio2_2 = 6.07710050630396597660e-11;
+        constexpr double pio2_3 = 2.02226624871116645580e-21;
+        constexpr double roundShifter = 0x1.8p52; // adding it rounds to an integer in the low mantissa bits
+
+        // Minimax polynomials on [-pi/4, pi/4] (fdlibm __kernel_sin / __kernel_cos)
+        constexpr double S1 = -1.66666666666666324348e-01, S2 = 8.33333333332248946124e-03,
+                         S3 = -1.98412698298579493134e-04, S4 = 2.75573137070700676789e-06,
+                         S5 = -2.50507602534068634195e-08, S6 = 1.58969099521155010221e-10;
+        constexpr double C1 = 4.16666666666666019037e-02, C2 = -1.38888888888741095749e-03,
+                         C3 = 2.48015872894767294178e-05, C4 = -2.75573143513906633035e-07,
+                         C5 = 2.08757232129817482790e-09, C6 = -1.13596475577881948265e-11;
+
+        // sinQuadrant takes and returns 4-double vectors by value, which GCC flags as an ABI
+        // change at the calls in kernelBody's baseline clone; both are always inlined, so no
+        // such call is ever made
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+        // sin(x + quadrantShift * pi/2) without branches: quadrantShift 0 is sin, 1 is cos
+        template <TrigPrecision Precision, typename V, typename I>
+        __attribute__((always_inline)) inline V sinQuadrant(V x, std::int64_t quadrantShift)
+        {
+            V shifted = x * twoOverPi + roundShifter;
+            V n = shifted - roundShifter;
+            I quadrant;
+            std::memcpy(&quadrant, &shifted, sizeof(quadrant)); // n modulo 2^51 in the low bits
+            quadrant += quadrantShift;
+
+            V r = ((x - n * pio2_1) - n * pio2_2) - n * pio2_3;
+            V z = r * r;
+            V sinR, cosR;
+            if constexpr (Precision == TrigPrecision::Accurate)
+            {
+                sinR = r + r * z * (S1 + z * (S2 + z * (S3 + z * (S4 + z * (S5 + z * S6)))));
+                cosR = 1.0 - 0.5 * z + z * z * (C1 + z * (C2 + z * (C3 + z * (C4 + z * (C5 + z * C6)))));
+            }
+            else
+            {
+                sinR = r + r * z * (S1 + z * (S2 + z * (S3 + z * S4)));
+                cosR = 1.0 - 0.5 * z + z * z * (C1 + z * (C2 + z * C3));
+            }
+
+            // Odd quadrants use the cosine polynomial, quadrants 2 and 3 flip the sign
+            V result;
+            if constexpr (std::is_same_v<V, double>)
+                result = (quadrant & 1) ? cosR : sinR;
+            else
+                result = (quadrant & 1) != 0 ? cosR : sinR;
+            I sign = (quadrant & 2) << 62;
+            I bits;
+            std::memcpy(&bits, &result, sizeof(bits));
+            bits ^= sign;
+            std::memcpy(&result, &bits, sizeof(result));
+            return result;
+        }
+
+        template <TrigPrecision Precision>
+        __attribute__((always_inline)) inline void kernelBody(const double *in, double *out, std::size_t count)
+        {
+            std::size_t k = 0;
+            for (; k + block <= count; k += block)
+            {
+                Doubles x0, x1;
+                std::memcpy(&x0, in + k, sizeof(x0));
+                std::memcpy(&x1, in + k + lanes, sizeof(x1));
+                Doubles r0 = {}, r1 = {};
+                for (int i = 1; i <= iterations; ++i)
+                {
+                    const double index = i;
+                    r0 = (r0 + sinQuadrant<Precision, Doubles, Int64s>(x0 * reciprocalTable[i], 0) *
+                                   sinQuadrant<Precision, Doubles, Int64s>(x0 * index, 1)) *
+                         scaleTable[i];
+                    r1 = (r1 + sinQuadrant<Precision, Doubles, Int64s>(x1 * reciprocalTable[i], 0) *
+                                   sinQuadrant<Precision, Doubles, Int64s>(x1 * index, 1)) *
+                         scaleTable[i];
+                }
+                std::memcpy(out + k, &r0, sizeof(r0));
+                std::memcpy(out + k + lanes, &r1, sizeof(r1));
+            }
+            for (; k < count; ++k)
+            {
+                double x = in[k];
+                double result = 0.0;
+                for (int i = 1; i <= iterations; ++i)
+                {
+                    result = (result + sinQuadrant<Precision, double, std::int64_t>(x * reciprocalTable[i], 0) *
+                                           sinQuadrant<Precision, double, std::int64_t>(x * i, 1)) *
+                             scaleTable[i];
+                }
+                out[k] = result;
+            }
+        }
+#pragma GCC diagnostic pop
+
+        // One clone per ISA; the dynamic loader resolves the best one once, at startup
+        __attribute__((target_clones("avx512f", "avx2", "default"))) void kernelAccurate(const double *in, double *out, std::size_t count)
+        {
+            kernelBody<TrigPrecision::Accurate>(in, out, count);
+        }
+
+        __attribute__((target_clones("avx512f", "avx2", "default"))) void kernelFast(const double *in, double *out, std::size_t count)
+        {
+            kernelBody<TrigPrecision::Fast>(in, out, count);
+        }
+    }
+
+    double sinApprox(double x, TrigPrecision precision)
+    {
+        return precision == TrigPrecision::Accurate ? sinQuadrant<TrigPrecision::Accurate, double, std::int64_t>(x, 0)
+                                                    : sinQuadrant<TrigPrecision::Fast, double, std::int64_t>(x, 0);
+    }
+
+    double cosApprox(double x, TrigPrecision precision)
+    {
+        return precision == TrigPrecision::Accurate ? sinQuadrant<TrigPrecision::Accurate, double, std::int64_t>(x, 1)
+                                                    : sinQuadrant<TrigPrecision::Fast, double, std::int64_t>(x, 1);
+    }
+
+    void complexCalculationBatch(std::span<const double> in, std::span<double> out, TrigPrecision precision)
+    {
+        std::size_t count = std::min(in.size(), out.size());
+        if (precision == TrigPrecision::Accurate)
+            kernelAccurate(in.data(), out.data(), count);
+        else
+            kernelFast(in.data(), out.data(), count);
+    }
+
+    void complexCalculationParallel(std::span<const double> in, std::span<double> out, TrigPrecision precision, unsigned threads)
+    {
+        std::size_t count = std::min(in.size(), out.size());
+        if (threads == 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+
+        // Chunks are whole SIMD blocks so that only the last one has a scalar tail
+        std::size_t chunk = (count / threads + block - 1) / block * block;
+        if (threads == 1 || chunk == 0)
+        {
+            complexCalculationBatch(in.first(count), out.first(count), precision);
+            return;
+        }
+
+        std::vector<std::thread> workers;
+        for (std::size_t begin = 0; begin < count; begin += chunk)
+        {
+            std::size_t size = std::min(chunk, count - begin);
+            workers.emplace_back([=]
+                                 { complexCalculationBatch(in.subspan(begin, size), out.subspan(begin, size), precision); });
+        }
+        for (auto &worker : workers)
+            worker.join();
+    }
+
+    const char *selectedIsa()
+    {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f"))
+            return "avx512f";
+        if (__builtin_cpu_supports("avx2"))
+            return "avx2";
+        return "default";
+    }
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <span>
+
+// Batch version of complexCalculation() from inline_examples.hpp
+//
+// complexCalculation(x) runs 100 iterations of
+//     result = (result + sin(x / i) * cos(x * i)) * sqrt(i) / (i + 1)
+// The sqrt(i) / (i + 1) and 1 / i factors do not depend on x, so they are computed once,
+// at compile time, into the tables below. The batch kernels then evaluate sin and cos with
+// polynomial approximations that vectorize, running several inputs side by side in the
+// lanes of one SIMD register (8 inputs per step). The kernels are compiled for AVX-512,
+// AVX2 and baseline x86-64; the best version is picked when the program starts.
+//
+// Accuracy of the sin/cos approximations against std::sin/std::cos, |x| <= 1e4:
+//     TrigPrecision::Accurate   fdlibm-style polynomials, at most 2 ULP
+//     TrigPrecision::Fast       shorter polynomials, absolute error below 3e-8
+// Both reduce the argument with a three-part pi/2 (Cody-Waite), which stays accurate for
+// |x| up to about 1e6. complexCalculation multiplies x by up to 100, so inputs should stay
+// within |x| <= 1e4. benchmark/complex_batch_benchmark.cpp measures the end-to-end error.
+
+namespace ComplexBatch
+{
+    enum class TrigPrecision
+    {
+        Accurate,
+        Fast
+    };
+
+    constexpr int iterations = 100; // as in complexCalculation
+
+    namespace detail
+    {
+        // Newton's method; std::sqrt is not constexpr
+        constexpr double constexprSqrt(double value)
+        {
+            if (value <= 0)
+                return 0;
+            double guess = value < 1 ? 1 : value;
+            for (int step = 0; step < 100; ++step)
+            {
+                double next = 0.5 * (guess + value / guess);
+                if (next == guess)
+                    break;
+                guess = next;
+            }
+            return guess;
+        }
+
+        // scale[i] = sqrt(i) / (i + 1), the factor applied after step i
+        constexpr std::array<double, iterations + 1> makeScaleTable()
+        {
+            std::array<double, iterations + 1> table{};
+            for (int i = 1; i <= iterations; ++i)
+                table[i] = constexprSqrt(i) / (i + 1);
+            return table;
+        }
+
+        // reciprocal[i] = 1 / i, so that x / i becomes a multiplication
+        constexpr std::array<double, iterations + 1> makeReciprocalTable()
+        {
+            std::array<double, iterations + 1> table{};
+            for (int i = 1; i <= iterations; ++i)
+                table[i] = 1.0 / i;
+            return table;
+        }
+    }
+
+    inline constexpr auto scaleTable = detail::makeScaleTable();
+    inline constexpr auto reciprocalTable = detail::makeReciprocalTable();
+
+    static_assert(detail::constexprSqrt(4.0) == 2.0, "constexpr sqrt must be exact for squares");
+    static_assert(scaleTable[3] == detail::constexprSqrt(3.0) / 4, "tables are built at compile time");
+
+    // Scalar sin/cos with the same approximations as the batch kernels (for testing and tails)
+    double sinApprox(double x, TrigPrecision precision = TrigPrecision::Accurate);
+    double cosApprox(double x, TrigPrecision precision = TrigPrecision::Accurate);
+
+    // out[k] = complexCalculation(in[k]); in and out must have the same size (they may be the same span)
+    void complexCalculationBatch(std::span<const double> in, std::span<double> out,
+                                 TrigPrecision precision = TrigPrecision::Accurate);
+
+    // The same, split over `threads` threads (0: std::thread::hardware_concurrency())
+    void complexCalculationParallel(std::span<const double> in, std::span<double> out,
+                                    TrigPrecision precision = TrigPrecision::Accurate, unsigned threads = 0);
+
+    // Which kernel the dispatcher picked: "avx512f", "avx2" or "default"
+    const char *selectedIsa();
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cstddef>
+#include <initializer_list>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Real-world example: Container access patterns (used by dangerous_references.cpp)
+//
+// at() checks the index on every call, which is right for a single access but adds a
+// compare and a possible throw to every iteration of a loop. The bulk interface checks
+// once and then hands out plain memory:
+//   - view() and begin()/end(): the whole container, no checks needed
+//   - range(first, count): one check for the whole block, then a std::span
+//   - transform(f) / for_each(f): simple loops over contiguous ints that the compiler
+//     can vectorize when f is inlinable
+//
+//     for (int &x : container.range(first, 4096))   // checked once
+//         x *= 2;
+//     container.transform([](int x) { return x * 2; });
+//
+// References and spans stay valid until the container is destroyed (it never resizes).
+
+class Container
+{
+private:
+    std::vector<int> data;
+
+    void checkRange(size_t first, size_t count) const
+    {
+        if (first > data.size() || count > data.size() - first)
+        {
+            throw std::out_of_range(std::to_string(count) + " elements from index " + std::to_string(first) +
+                                    " out of range for size " + std::to_string(data.size()));
+        }
+    }
+
+public:
+    Container(std::initializer_list<int> init) : data(init) {}
+    explicit Container(std::vector<int> values) : data(std::move(values)) {}
+
+    // Safe: Return reference to existing element
+    int &at(size_t index)
+    {
+        if (index >= data.size())
+        {
+            throw std::out_of_range("Index out of range");
+        }
+        return data[index]; // Safe: data[index] exists as long as Container exists
+    }
+
+    const int &at(size_t index) const
+    {
+        if (index >= data.size())
+        {
+            throw std::out_of_range("Index out of range");
+        }
+        return data[index]; // Safe const version
+    }
+
+    // DANGEROUS: Don't do this!
+    /*
+    int& getFirst() {
+        if (data.empty()) {
+            int defaultValue = 0;
+            return defaultValue;  // DANGEROUS! Local variable
+        }
+        return data[0];  // This part is safe
+    }
+    */
+
+    // Safe alternative
+    int getFirstSafe() const
+    {
+        return data.empty() ? 0 : data[0]; // Return by value
+    }
+
+    // Another safe alternative
+    int *getFirstPtr()
+    {
+        return data.empty() ? nullptr : &data[0]; // Return pointer (can be null)
+    }
+
+    size_t size() const { return data.size(); }
+
+    // Bulk access: the whole container as a span, and range-for support
+    std::span<int> view() { return data; }
+    std::span<const int> view() const { return data; }
+
+    int *begin() { return data.data(); }
+    int *end() { return data.data() + data.size(); }
+    const int *begin() const { return data.data(); }
+    const int *end() const { return data.data() + data.size(); }
+
+    // Elements [first, first + count), checked once; std::out_of_range if any is missing
+    std::span<int> range(size_t first, size_t count)
+    {
+        checkRange(first, count);
+        return std::span<int>(data).subspan(first, count);
+    }
+
+    std::span<const int> range(size_t first, size_t count) const
+    {
+        checkRange(first, count);
+        return std::span<const int>(data).subspan(first, count);
+    }
+
+    // element = f(element) for every element, in order. The fixed-width inner loop is what lets
+    // GCC vectorize at -O2, whose cost model rejects loops that would need a scalar tail.
+    template <typename F>
+    void transform(F f)
+    {
+        int *values = data.data();
+        const size_t n = data.size();
+        size_t i = 0;
+        for (; i + blockWidth <= n; i += blockWidth)
+            for (size_t j = 0; j < blockWidth; ++j)
+                values[i + j] = f(values[i + j]);
+        for (; i < n; ++i)
+            values[i] = f(values[i]);
+    }
+
+    // f(element) for every element, in order
+    template <typename F>
+    void for_each(F f) const
+    {
+        const int *values = data.data();
+        const size_t n = data.size();
+        size_t i = 0;
+        for (; i + blockWidth <= n; i += blockWidth)
+            for (size_t j = 0; j < blockWidth; ++j)
+                f(values[i + j]);
+        for (; i < n; ++i)
+            f(values[i]);
+    }
+
+private:
+    static constexpr size_t blockWidth = 16;
+};
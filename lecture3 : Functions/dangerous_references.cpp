@@ -3,6 +3,9 @@
 #include <string>
 #include <memory>
 
+#include "container.hpp"
+#include "handle_pool.hpp"
+
 // DANGEROUS EXAMPLES - These demonstrate what NOT to do!
 
 // Example 1: DANGEROUS - Returning reference to local variable
@@ -168,6 +171,14 @@ void demonstrateSafeCode()
     auto dynamicInt = createDynamicInt(77);
     std::cout << "Dynamic int value: " << *dynamicInt << std::endl;
 
+    // Safe: Handle into a pool - a stale handle is detected instead of dangling
+    HandlePool<int> pool;
+    auto handle = pool.create(77);
+    std::cout << "Pooled int value: " << pool.at(handle) << std::endl;
+    pool.destroy(handle);
+    pool.create(88); // reuses the slot with a new generation
+    std::cout << "Old handle after destroy: " << (pool.get(handle) ? "still valid?!" : "stale, rejected") << std::endl;
+
     // Safe: Return complex object by value
     auto safeVector = createSafeVector();
     std::cout << "Safe vector size: " << safeVector.size() << std::endl;
@@ -190,60 +201,6 @@ void compilerWarningsExample()
     std::cout << std::endl;
 }
 
-// Real-world example: Container access patterns
-class Container
-{
-private:
-    std::vector<int> data;
-
-public:
-    Container(std::initializer_list<int> init) : data(init) {}
-
-    // Safe: Return reference to existing element
-    int &at(size_t index)
-    {
-        if (index >= data.size())
-        {
-            throw std::out_of_range("Index out of range");
-        }
-        return data[index]; // Safe: data[index] exists as long as Container exists
-    }
-
-    const int &at(size_t index) const
-    {
-        if (index >= data.size())
-        {
-            throw std::out_of_range("Index out of range");
-        }
-        return data[index]; // Safe const version
-    }
-
-    // DANGEROUS: Don't do this!
-    /*
-    int& getFirst() {
-        if (data.empty()) {
-            int defaultValue = 0;
-            return defaultValue;  // DANGEROUS! Local variable
-        }
-        return data[0];  // This part is safe
-    }
-    */
-
-    // Safe alternative
-    int getFirstSafe() const
-    {
-        return data.empty() ? 0 : data[0]; // Return by value
-    }
-
-    // Another safe alternative
-    int *getFirstPtr()
-    {
-        return data.empty() ? nullptr : &data[0]; // Return pointer (can be null)
-    }
-
-    size_t size() const { return data.size(); }
-};
-
 void containerExample()
 {
     std::cout << "=== Container Access Example ===" << std::endl;
@@ -268,6 +225,32 @@ void containerExample()
         std::cout << "First element via pointer: " << *firstPtr << std::endl;
     }
 
+    // Bulk access: one check for the whole block instead of one per element
+    for (int &value : container.range(1, 3))
+    {
+        value += 1;
+    }
+    container.transform([](int x)
+                        { return x * 2; });
+    int sum = 0;
+    container.for_each([&sum](int x)
+                       { sum += x; });
+    std::cout << "After range(1, 3) += 1 and doubling:";
+    for (int value : container)
+    {
+        std::cout << " " << value;
+    }
+    std::cout << " (sum " << sum << ")" << std::endl;
+
+    try
+    {
+        container.range(3, 5);
+    }
+    catch (const std::out_of_range &e)
+    {
+        std::cout << "range(3, 5) rejected: " << e.what() << std::endl;
+    }
+
     std::cout << std::endl;
 }
 
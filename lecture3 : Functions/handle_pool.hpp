@@ -0,0 +1,186 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Objects stored contiguously and referred to by generational handles
+//
+// createDynamicInt (dangerous_references.cpp) gives every object its own heap allocation,
+// which is safe but slow with millions of small objects: one malloc/free each, and objects
+// scattered across memory. HandlePool<T> keeps all live objects in one dense array and hands
+// out handles instead of pointers:
+//
+//     HandlePool<Particle> pool;
+//     auto h = pool.create(1.0f, 2.0f);
+//     if (Particle *p = pool.get(h)) ...  // nullptr once h is destroyed
+//     pool.destroy(h);
+//     for (Particle &p : pool) ...        // only live objects, back to back
+//
+// A handle is a slot index plus the generation of that slot. Destroying an object bumps its
+// slot's generation, so every old handle to it fails the O(1) generation check, even after the
+// slot is reused. Destroying moves the last object into the hole (swap and pop), so iteration
+// order changes and pointers into the pool are only valid until the next create/destroy.
+//
+// Handles are 64 bits (32-bit index, 32-bit generation) or, with HandlePool<T, std::uint32_t>,
+// 32 bits (22-bit index, 10-bit generation). A slot whose generation is exhausted is retired
+// rather than reused, so a stale handle can never match a newer object.
+
+template <typename T, typename Bits = std::uint64_t>
+class HandlePool
+{
+    static_assert(std::is_same_v<Bits, std::uint32_t> || std::is_same_v<Bits, std::uint64_t>, "handles are 32 or 64 bits");
+
+public:
+    static constexpr unsigned indexBits = sizeof(Bits) == 4 ? 22 : 32;
+    static constexpr unsigned generationBits = 8 * sizeof(Bits) - indexBits;
+    static constexpr Bits indexMask = (Bits(1) << indexBits) - 1;
+    static constexpr Bits maxGeneration = Bits(~Bits(0)) >> indexBits;
+
+    // Generations start at 1, so a default Handle (0) never refers to anything
+    struct Handle
+    {
+        Bits value = 0;
+
+        bool operator==(const Handle &) const = default;
+        explicit operator bool() const { return value != 0; }
+    };
+
+    HandlePool() = default;
+
+    void reserve(std::size_t count)
+    {
+        objects_.reserve(count);
+        owners_.reserve(count);
+        slots_.reserve(count);
+    }
+
+    // Constructs a T from args; std::length_error when every slot index is in use or retired
+    template <typename... Args>
+    Handle create(Args &&...args)
+    {
+        if (freeHead_ == noSlot && slots_.size() >= indexMask)
+            throw std::length_error("HandlePool: all " + std::to_string(std::size_t(indexMask)) + " slots in use");
+        // Constructed first, so a throwing constructor leaves the pool unchanged
+        objects_.emplace_back(std::forward<Args>(args)...);
+
+        std::uint32_t slot;
+        if (freeHead_ != noSlot)
+        {
+            slot = freeHead_;
+            freeHead_ = slots_[slot].position;
+        }
+        else
+        {
+            slot = static_cast<std::uint32_t>(slots_.size());
+            slots_.push_back(Slot{0, 1});
+        }
+        owners_.push_back(slot);
+        slots_[slot].position = static_cast<std::uint32_t>(objects_.size() - 1);
+        return makeHandle(slot, slots_[slot].generation);
+    }
+
+    // Destroys the object; false (and nothing happens) if the handle is stale or null
+    bool destroy(Handle handle)
+    {
+        if (!contains(handle))
+            return false;
+        const std::uint32_t slot = slotOf(handle);
+        const std::uint32_t position = slots_[slot].position;
+
+        // Swap and pop: the last object fills the hole, and its slot learns the new position
+        if (position != objects_.size() - 1)
+        {
+            objects_[position] = std::move(objects_.back());
+            owners_[position] = owners_.back();
+            slots_[owners_[position]].position = position;
+        }
+        objects_.pop_back();
+        owners_.pop_back();
+
+        Slot &freed = slots_[slot];
+        if (freed.generation == maxGeneration)
+        {
+            freed.generation = 0; // retired: matches no handle and is never reused
+            return true;
+        }
+        ++freed.generation;
+        freed.position = freeHead_;
+        freeHead_ = slot;
+        return true;
+    }
+
+    // Whether the handle refers to a live object
+    bool contains(Handle handle) const
+    {
+        const std::uint32_t slot = slotOf(handle);
+        const Bits generation = generationOf(handle);
+        return generation != 0 && slot < slots_.size() && slots_[slot].generation == generation;
+    }
+
+    // The object, or nullptr for a stale handle
+    T *get(Handle handle) { return contains(handle) ? &objects_[slots_[slotOf(handle)].position] : nullptr; }
+    const T *get(Handle handle) const { return contains(handle) ? &objects_[slots_[slotOf(handle)].position] : nullptr; }
+
+    // The object; std::out_of_range for a stale handle
+    T &at(Handle handle)
+    {
+        if (T *object = get(handle))
+            return *object;
+        throw std::out_of_range("HandlePool: stale handle " + std::to_string(handle.value));
+    }
+    const T &at(Handle handle) const
+    {
+        if (const T *object = get(handle))
+            return *object;
+        throw std::out_of_range("HandlePool: stale handle " + std::to_string(handle.value));
+    }
+
+    // The live objects, densely packed; objects()[i] belongs to handleAt(i)
+    std::span<T> objects() { return objects_; }
+    std::span<const T> objects() const { return objects_; }
+    Handle handleAt(std::size_t position) const
+    {
+        const std::uint32_t slot = owners_[position];
+        return makeHandle(slot, slots_[slot].generation);
+    }
+
+    T *begin() { return objects_.data(); }
+    T *end() { return objects_.data() + objects_.size(); }
+    const T *begin() const { return objects_.data(); }
+    const T *end() const { return objects_.data() + objects_.size(); }
+
+    std::size_t size() const { return objects_.size(); }
+    bool empty() const { return objects_.empty(); }
+
+    // Destroys every object; all outstanding handles become stale
+    void clear()
+    {
+        while (!objects_.empty())
+            destroy(handleAt(objects_.size() - 1));
+    }
+
+private:
+    static constexpr std::uint32_t noSlot = std::numeric_limits<std::uint32_t>::max();
+
+    struct Slot
+    {
+        std::uint32_t position;   // index into objects_ while live, next free slot while free
+        std::uint32_t generation; // 0 once retired
+    };
+
+    static Handle makeHandle(std::uint32_t slot, std::uint32_t generation) { return Handle{Bits(Bits(generation) << indexBits) | slot}; }
+    static std::uint32_t slotOf(Handle handle) { return static_cast<std::uint32_t>(handle.value & indexMask); }
+    static Bits generationOf(Handle handle) { return handle.value >> indexBits; }
+
+    std::vector<T> objects_;
+    std::vector<std::uint32_t> owners_; // slot of each object in objects_
+    std::vector<Slot> slots_;
+    std::uint32_t freeHead_ = noSlot;
+};
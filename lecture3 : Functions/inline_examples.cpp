@@ -1,242 +1,64 @@
 #include <iostream>
 #include <vector>
-#include <chrono>
 #include <cmath>
+#include <climits>
+#include <cstring>
+#include <limits>
 #include <tuple>
+#include "inline_examples.hpp"
+#include "array_kernels.hpp"
+#include "benchmark/microbench.hpp"
+#include "probe.hpp"
 
-// Example 1: Basic inline function
-inline int square(int x)
-{
-    return x * x;
-}
-
-// Example 2: Non-inline version for comparison
-int squareNotInline(int x)
-{
-    return x * x;
-}
-
-// Example 3: Inline function with multiple statements
-inline double calculateCircleArea(double radius)
-{
-    const double PI = 3.14159265359;
-    return PI * radius * radius;
-}
-
-// Example 4: Larger function - NOT a good candidate for inlining
-inline double complexCalculation(double x)
-{
-    double result = 0.0;
-    for (int i = 1; i <= 100; ++i)
-    {
-        result += std::sin(x / i) * std::cos(x * i);
-        result *= std::sqrt(i);
-        result /= (i + 1);
-    }
-    return result; // Compiler will likely ignore the inline hint here
-}
-
-// Example 5: Class with inline member functions
-class Point
-{
-private:
-    double x, y;
-
-public:
-    // Constructor (implicitly inline)
-    Point(double x = 0.0, double y = 0.0) : x(x), y(y) {}
-
-    // Getters (implicitly inline - defined in class)
-    double getX() const { return x; }
-    double getY() const { return y; }
-
-    // Setters (implicitly inline)
-    void setX(double newX) { x = newX; }
-    void setY(double newY) { y = newY; }
-
-    // More complex function - explicitly inline
-    inline double distanceFromOrigin() const
-    {
-        return std::sqrt(x * x + y * y);
-    }
-
-    // Function defined outside class - needs inline keyword
-    inline double distanceTo(const Point &other) const;
-
-    // Static inline function
-    static inline Point origin()
-    {
-        return Point(0.0, 0.0);
-    }
-};
-
-// Definition outside class - must be inline to avoid multiple definition errors
-inline double Point::distanceTo(const Point &other) const
-{
-    double dx = x - other.x;
-    double dy = y - other.y;
-    return std::sqrt(dx * dx + dy * dy);
-}
-
-// Example 6: Template functions (automatically considered for inlining)
-template <typename T>
-inline T max(const T &a, const T &b)
-{
-    return (a > b) ? a : b;
-}
-
-template <typename T>
-inline T min(const T &a, const T &b)
-{
-    return (a < b) ? a : b;
-}
+// Examples 1-6, 8 and 9 (the inline candidates) live in inline_examples.hpp
 
 // Example 7: Performance comparison
+// One timing per variant is mostly noise, so the comparison runs on the microbench harness:
+// warm-up, calibrated iteration counts and many samples (see benchmark/microbench.hpp)
 void performanceTest()
 {
+    // For always-on timing of real code paths, a probe: recorded per thread, reported at the end
+    PROBE_SCOPE("performanceTest");
     std::cout << "=== Performance Comparison ===" << std::endl;
 
-    const int iterations = 10000000;
-    auto start = std::chrono::high_resolution_clock::now();
-
-    // Test inline version
-    long long sum1 = 0;
-    for (int i = 0; i < iterations; ++i)
-    {
-        sum1 += square(i % 1000);
-    }
-
-    auto mid = std::chrono::high_resolution_clock::now();
-
-    // Test non-inline version
-    long long sum2 = 0;
-    for (int i = 0; i < iterations; ++i)
-    {
-        sum2 += squareNotInline(i % 1000);
-    }
-
-    auto end = std::chrono::high_resolution_clock::now();
-
-    auto inline_time = std::chrono::duration_cast<std::chrono::milliseconds>(mid - start).count();
-    auto non_inline_time = std::chrono::duration_cast<std::chrono::milliseconds>(end - mid).count();
-
-    std::cout << "Inline function time: " << inline_time << " ms" << std::endl;
-    std::cout << "Non-inline function time: " << non_inline_time << " ms" << std::endl;
-    std::cout << "Sum results (should be equal): " << sum1 << " vs " << sum2 << std::endl;
-
-    if (inline_time < non_inline_time)
+    bench::Options options;
+    options.samples = 15;
+    options.quiet = true;
+    bench::Runner runner(options);
+
+    int i = 0;
+    bench::Stats inlineStats = runner.run("square (inline)", [&]
+                                         {
+        int x = i++ % 1000;
+        bench::doNotOptimize(x); // the optimizer must not see the input
+        bench::doNotOptimize(square(x)); });
+
+    i = 0;
+    bench::Stats nonInlineStats = runner.run("squareNotInline", [&]
+                                            {
+        int x = i++ % 1000;
+        bench::doNotOptimize(x);
+        bench::doNotOptimize(squareNotInline(x)); });
+
+    bench::printTable(std::cout, runner.results());
+
+    // A difference only counts when it is larger than the run-to-run noise
+    if (!bench::isSignificant(inlineStats, nonInlineStats))
     {
-        std::cout << "Inline version was faster by " << (non_inline_time - inline_time) << " ms" << std::endl;
+        std::cout << "No significant difference (within 5% or 3 x MAD)" << std::endl;
     }
-    else if (non_inline_time < inline_time)
+    else if (inlineStats.median < nonInlineStats.median)
     {
-        std::cout << "Non-inline version was faster by " << (inline_time - non_inline_time) << " ms" << std::endl;
+        std::cout << "Inline version was faster by " << (nonInlineStats.median - inlineStats.median) << " ns per call" << std::endl;
     }
     else
     {
-        std::cout << "Both versions performed equally" << std::endl;
+        std::cout << "Non-inline version was faster by " << (inlineStats.median - nonInlineStats.median) << " ns per call" << std::endl;
     }
     std::cout << "Note: Results may vary based on compiler optimization" << std::endl;
     std::cout << std::endl;
 }
 
-// Example 8: Good candidates for inlining
-namespace InlineCandidates
-{
-
-    // Mathematical operations
-    inline double celsius_to_fahrenheit(double celsius)
-    {
-        return celsius * 9.0 / 5.0 + 32.0;
-    }
-
-    inline bool is_even(int number)
-    {
-        return number % 2 == 0;
-    }
-
-    inline int abs_value(int x)
-    {
-        return (x < 0) ? -x : x;
-    }
-
-    // Simple utility functions
-    inline bool is_vowel(char c)
-    {
-        return (c == 'a' || c == 'e' || c == 'i' || c == 'o' || c == 'u' ||
-                c == 'A' || c == 'E' || c == 'I' || c == 'O' || c == 'U');
-    }
-
-    inline double square_double(double x)
-    {
-        return x * x;
-    }
-}
-
-// Example 9: Poor candidates for inlining
-namespace PoorInlineCandidates
-{
-
-    // Large function with complex logic
-    inline void print_multiplication_table(int n)
-    { // Poor candidate!
-        std::cout << "Multiplication table for " << n << ":" << std::endl;
-        for (int i = 1; i <= 12; ++i)
-        {
-            for (int j = 1; j <= 12; ++j)
-            {
-                std::cout << i * j << "\t";
-            }
-            std::cout << std::endl;
-        }
-        std::cout << std::endl;
-    }
-
-    // Recursive function
-    inline long long fibonacci(int n)
-    { // Poor candidate!
-        if (n <= 1)
-            return n;
-        return fibonacci(n - 1) + fibonacci(n - 2);
-    }
-
-    // Function with complex control flow
-    inline std::string process_string(const std::string &input)
-    { // Poor candidate!
-        std::string result;
-        for (char c : input)
-        {
-            if (std::isalpha(c))
-            {
-                if (std::islower(c))
-                {
-                    result += std::toupper(c);
-                }
-                else
-                {
-                    result += std::tolower(c);
-                }
-            }
-            else if (std::isdigit(c))
-            {
-                result += c;
-            }
-            else if (c == ' ')
-            {
-                result += '_';
-            }
-            // More complex logic...
-        }
-        return result;
-    }
-}
-
-// constexpr functions (implicitly inline) - defined at global scope
-constexpr int constexpr_factorial(int n)
-{
-    return (n <= 1) ? 1 : n * constexpr_factorial(n - 1);
-}
-
 // Example 10: Modern C++ and inline
 void modernInlineExamples()
 {
@@ -281,6 +103,80 @@ void testGoodInlineCandidates()
     std::cout << std::endl;
 }
 
+// Example 8b: The same helpers over whole arrays, dispatched to the best SIMD implementation.
+// Every supported ISA is forced in turn and must give bit-identical results to the scalar code.
+bool checkArrayKernels()
+{
+    std::cout << "=== Array Kernels (runtime CPU dispatch) ===" << std::endl;
+    std::cout << "Selected implementation: " << ArrayKernels::isaName(ArrayKernels::activeIsa()) << std::endl;
+
+    // An odd length exercises the scalar tails; the edge values the SIMD paths must agree on
+    const std::size_t n = 1003;
+    std::vector<double> temperatures(n);
+    std::vector<int> readings(n);
+    for (std::size_t k = 0; k < n; ++k)
+    {
+        temperatures[k] = -40.0 + 0.37 * static_cast<double>(k);
+        readings[k] = static_cast<int>(k * 2654435761u);
+    }
+    temperatures[1] = -0.0;
+    temperatures[2] = std::numeric_limits<double>::quiet_NaN();
+    temperatures[3] = std::numeric_limits<double>::infinity();
+    temperatures[4] = std::numeric_limits<double>::denorm_min();
+    readings[1] = INT_MIN;
+    readings[2] = INT_MAX;
+    readings[3] = -1;
+
+    struct Outputs
+    {
+        std::vector<double> fahrenheit, squares;
+        std::vector<std::uint8_t> even;
+        std::vector<int> abs;
+    };
+    auto runAll = [&]
+    {
+        Outputs out{std::vector<double>(n), std::vector<double>(n), std::vector<std::uint8_t>(n), std::vector<int>(n)};
+        ArrayKernels::celsiusToFahrenheit(temperatures, out.fahrenheit);
+        ArrayKernels::squareDouble(temperatures, out.squares);
+        ArrayKernels::isEven(readings, out.even);
+        ArrayKernels::absValue(readings, out.abs);
+        return out;
+    };
+    auto sameBits = [](const auto &a, const auto &b)
+    { return std::memcmp(a.data(), b.data(), a.size() * sizeof(a[0])) == 0; };
+
+    ArrayKernels::forceIsa(ArrayKernels::Isa::Scalar);
+    Outputs reference = runAll();
+
+    // The scalar kernels must also match the inline helpers they are based on
+    bool ok = true;
+    for (std::size_t k = 5; k < n; ++k)
+        ok = ok && reference.fahrenheit[k] == InlineCandidates::celsius_to_fahrenheit(temperatures[k]) &&
+             reference.squares[k] == InlineCandidates::square_double(temperatures[k]) &&
+             reference.even[k] == InlineCandidates::is_even(readings[k]) &&
+             (readings[k] == INT_MIN || reference.abs[k] == InlineCandidates::abs_value(readings[k]));
+
+    for (ArrayKernels::Isa isa : ArrayKernels::allIsas)
+    {
+        if (!ArrayKernels::isSupported(isa))
+        {
+            std::cout << "  " << ArrayKernels::isaName(isa) << ": not supported on this CPU" << std::endl;
+            continue;
+        }
+        ArrayKernels::forceIsa(isa);
+        Outputs out = runAll();
+        bool same = sameBits(out.fahrenheit, reference.fahrenheit) && sameBits(out.squares, reference.squares) &&
+                    sameBits(out.even, reference.even) && sameBits(out.abs, reference.abs);
+        std::cout << "  " << ArrayKernels::isaName(isa) << ": " << (same ? "identical" : "MISMATCH") << std::endl;
+        ok = ok && same;
+    }
+    ArrayKernels::resetIsa();
+
+    std::cout << (ok ? "All implementations agree" : "Array kernels disagree!") << std::endl;
+    std::cout << std::endl;
+    return ok;
+}
+
 void demonstrateClassInlining()
 {
     std::cout << "=== Class Inline Functions ===" << std::endl;
@@ -321,6 +217,7 @@ int main()
 
     demonstrateClassInlining();
     testGoodInlineCandidates();
+    bool kernelsAgree = checkArrayKernels();
     modernInlineExamples();
 
     // Performance test (compile with -O2 for better comparison)
@@ -342,5 +239,11 @@ int main()
     std::cout << "App name: " << APP_NAME << std::endl;
 #endif
 
-    return 0;
+#if PROBES_ENABLED
+    std::cout << std::endl
+              << "Probes:" << std::endl;
+    probe::printReport(std::cout);
+#endif
+
+    return kernelsAgree ? 0 : 1;
 }
\ No newline at end of file
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <cctype>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+// The inline candidates from inline_examples.cpp, shared with the benchmarks and the
+// batch/SIMD versions built on top of them. Everything here is inline (or a template or
+// constexpr), so the header can be included from any number of translation units.
+
+// Example 1: Basic inline function
+inline int square(int x)
+{
+    return x * x;
+}
+
+// Example 2: Non-inline version for comparison
+// Defined in not_inline.cpp: in its own translation unit the compiler cannot inline it
+// (unless link-time optimization is enabled)
+int squareNotInline(int x);
+
+// Example 3: Inline function with multiple statements
+inline double calculateCircleArea(double radius)
+{
+    const double PI = 3.14159265359;
+    return PI * radius * radius;
+}
+
+// Example 4: Larger function - NOT a good candidate for inlining
+inline double complexCalculation(double x)
+{
+    double result = 0.0;
+    for (int i = 1; i <= 100; ++i)
+    {
+        result += std::sin(x / i) * std::cos(x * i);
+        result *= std::sqrt(i);
+        result /= (i + 1);
+    }
+    return result; // Compiler will likely ignore the inline hint here
+}
+
+// Example 5: Class with inline member functions
+class Point
+{
+private:
+    double x, y;
+
+public:
+    // Constructor (implicitly inline)
+    Point(double x = 0.0, double y = 0.0) : x(x), y(y) {}
+
+    // Getters (implicitly inline - defined in class)
+    double getX() const { return x; }
+    double getY() const { return y; }
+
+    // Setters (implicitly inline)
+    void setX(double newX) { x = newX; }
+    void setY(double newY) { y = newY; }
+
+    // More complex function - explicitly inline
+    inline double distanceFromOrigin() const
+    {
+        return std::sqrt(x * x + y * y);
+    }
+
+    // Function defined outside class - needs inline keyword
+    inline double distanceTo(const Point &other) const;
+
+    // Static inline function
+    static inline Point origin()
+    {
+        return Point(0.0, 0.0);
+    }
+};
+
+// Definition outside class - must be inline to avoid multiple definition errors
+inline double Point::distanceTo(const Point &other) const
+{
+    double dx = x - other.x;
+    double dy = y - other.y;
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+// Example 6: Template functions (automatically considered for inlining)
+template <typename T>
+inline T max(const T &a, const T &b)
+{
+    return (a > b) ? a : b;
+}
+
+template <typename T>
+inline T min(const T &a, const T &b)
+{
+    return (a < b) ? a : b;
+}
+
+// Example 8: Good candidates for inlining
+namespace InlineCandidates
+{
+
+    // Mathematical operations
+    inline double celsius_to_fahrenheit(double celsius)
+    {
+        return celsius * 9.0 / 5.0 + 32.0;
+    }
+
+    inline bool is_even(int number)
+    {
+        return number % 2 == 0;
+    }
+
+    inline int abs_value(int x)
+    {
+        return (x < 0) ? -x : x;
+    }
+
+    // Simple utility functions
+    inline bool is_vowel(char c)
+    {
+        return (c == 'a' || c == 'e' || c == 'i' || c == 'o' || c == 'u' ||
+                c == 'A' || c == 'E' || c == 'I' || c == 'O' || c == 'U');
+    }
+
+    inline double square_double(double x)
+    {
+        return x * x;
+    }
+}
+
+// Example 9: Poor candidates for inlining
+namespace PoorInlineCandidates
+{
+
+    // Large function with complex logic
+    inline void print_multiplication_table(int n)
+    { // Poor candidate!
+        std::cout << "Multiplication table for " << n << ":" << std::endl;
+        for (int i = 1; i <= 12; ++i)
+        {
+            for (int j = 1; j <= 12; ++j)
+            {
+                std::cout << i * j << "\t";
+            }
+            std::cout << std::endl;
+        }
+        std::cout << std::endl;
+    }
+
+    // Recursive function: O(phi^n) calls; Sequences::fibonacci (sequences.hpp) is a table lookup
+    inline long long fibonacci(int n)
+    { // Poor candidate!
+        if (n <= 1)
+            return n;
+        return fibonacci(n - 1) + fibonacci(n - 2);
+    }
+
+    // Function with complex control flow
+    inline std::string process_string(const std::string &input)
+    { // Poor candidate!
+        std::string result;
+        for (char c : input)
+        {
+            if (std::isalpha(c))
+            {
+                if (std::islower(c))
+                {
+                    result += std::toupper(c);
+                }
+                else
+                {
+                    result += std::tolower(c);
+                }
+            }
+            else if (std::isdigit(c))
+            {
+                result += c;
+            }
+            else if (c == ' ')
+            {
+                result += '_';
+            }
+            // More complex logic...
+        }
+        return result;
+    }
+}
+
+// constexpr functions (implicitly inline) - defined at global scope
+// 13! does not fit an int. In a constant expression the signed overflow was already a
+// compile error; the check only changes run-time calls, which throw std::overflow_error
+// instead of overflowing (undefined behaviour). Sequences::factorial (sequences.hpp) covers
+// up to 20!.
+constexpr int constexpr_factorial(int n)
+{
+    if (n > 12)
+        throw std::overflow_error("constexpr_factorial: " + std::to_string(n) + "! does not fit an int");
+    return (n <= 1) ? 1 : n * constexpr_factorial(n - 1);
+}
@@ -0,0 +1,212 @@
+#include "kd_tree.hpp"
+#include "parallel_chunks.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace
+{
+    // Ranges smaller than this are not worth a thread of their own
+    constexpr std::size_t parallelBuildThreshold = 1 << 16;
+}
+
+KdTree::KdTree(const PointCloud &cloud, unsigned threads) : dimensions_(cloud.dimensions())
+{
+    if (cloud.size() >= std::numeric_limits<std::uint32_t>::max())
+        throw std::length_error("KdTree: " + std::to_string(cloud.size()) + " points do not fit 32-bit indices");
+
+    nodes_.resize(cloud.size());
+    parallelChunks(cloud.size(), threads, [&](std::size_t begin, std::size_t end)
+                   {
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            auto c = cloud.coordinates(i);
+            nodes_[i] = Node{{c[0], c[1], c[2]}, static_cast<std::uint32_t>(i), 0};
+        } });
+    build(0, nodes_.size(), resolveThreads(threads));
+}
+
+void KdTree::build(std::size_t begin, std::size_t end, unsigned threads)
+{
+    if (end - begin <= leafSize)
+        return;
+
+    // Split along the axis where this range is widest
+    double low[3], high[3];
+    for (std::size_t d = 0; d < dimensions_; ++d)
+        low[d] = high[d] = nodes_[begin].coordinates[d];
+    for (std::size_t i = begin + 1; i < end; ++i)
+    {
+        for (std::size_t d = 0; d < dimensions_; ++d)
+        {
+            low[d] = std::min(low[d], nodes_[i].coordinates[d]);
+            high[d] = std::max(high[d], nodes_[i].coordinates[d]);
+        }
+    }
+    std::uint8_t axis = 0;
+    for (std::size_t d = 1; d < dimensions_; ++d)
+        if (high[d] - low[d] > high[axis] - low[axis])
+            axis = static_cast<std::uint8_t>(d);
+
+    const std::size_t middle = begin + (end - begin) / 2;
+    std::nth_element(nodes_.begin() + begin, nodes_.begin() + middle, nodes_.begin() + end,
+                     [axis](const Node &a, const Node &b)
+                     { return a.coordinates[axis] < b.coordinates[axis]; });
+    nodes_[middle].axis = axis;
+
+    // The two halves touch disjoint parts of nodes_, so they can be built concurrently
+    if (threads > 1 && end - begin >= parallelBuildThreshold)
+    {
+        std::thread left(&KdTree::build, this, begin, middle, threads / 2);
+        build(middle + 1, end, threads - threads / 2);
+        left.join();
+    }
+    else
+    {
+        build(begin, middle, 1);
+        build(middle + 1, end, 1);
+    }
+}
+
+double KdTree::squaredDistance(const Node &node, const Coordinates &query) const
+{
+    double dx = node.coordinates[0] - query[0], dy = node.coordinates[1] - query[1];
+    if (dimensions_ == 2)
+        return dx * dx + dy * dy;
+    double dz = node.coordinates[2] - query[2];
+    return dx * dx + dy * dy + dz * dz;
+}
+
+// Visits every node whose squared distance is within `bound`. visit(node, squaredDistance)
+// may shrink the bound as it finds closer points; subtrees beyond it are skipped.
+template <typename Visit>
+void KdTree::search(const Coordinates &query, std::size_t begin, std::size_t end, double &bound, Visit &visit) const
+{
+    if (end - begin <= leafSize)
+    {
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            double d2 = squaredDistance(nodes_[i], query);
+            if (d2 <= bound)
+                visit(nodes_[i], d2);
+        }
+        return;
+    }
+
+    const std::size_t middle = begin + (end - begin) / 2;
+    const Node &node = nodes_[middle];
+    double d2 = squaredDistance(node, query);
+    if (d2 <= bound)
+        visit(node, d2);
+
+    // Nearer side first: it is the one most likely to shrink the bound
+    double offset = query[node.axis] - node.coordinates[node.axis];
+    if (offset < 0)
+    {
+        search(query, begin, middle, bound, visit);
+        if (offset * offset <= bound)
+            search(query, middle + 1, end, bound, visit);
+    }
+    else
+    {
+        search(query, middle + 1, end, bound, visit);
+        if (offset * offset <= bound)
+            search(query, begin, middle, bound, visit);
+    }
+}
+
+std::vector<KdTree::Neighbor> KdTree::nearest(const Coordinates &query, std::size_t k) const
+{
+    k = std::min(k, nodes_.size());
+    if (k == 0)
+        return {};
+
+    // Max-heap of the k best so far; its top is the current search bound
+    std::vector<std::pair<double, std::uint32_t>> best;
+    best.reserve(k);
+    double bound = std::numeric_limits<double>::infinity();
+    auto visit = [&](const Node &node, double d2)
+    {
+        if (best.size() < k)
+        {
+            best.emplace_back(d2, node.index);
+            std::push_heap(best.begin(), best.end());
+        }
+        else if (d2 < best.front().first)
+        {
+            std::pop_heap(best.begin(), best.end());
+            best.back() = {d2, node.index};
+            std::push_heap(best.begin(), best.end());
+        }
+        if (best.size() == k)
+            bound = best.front().first;
+    };
+    search(query, 0, nodes_.size(), bound, visit);
+
+    std::sort_heap(best.begin(), best.end());
+    std::vector<Neighbor> neighbors;
+    neighbors.reserve(best.size());
+    for (const auto &[d2, index] : best)
+        neighbors.push_back({index, std::sqrt(d2)});
+    return neighbors;
+}
+
+std::vector<KdTree::Neighbor> KdTree::withinRadius(const Coordinates &query, double radius) const
+{
+    std::vector<std::pair<double, std::uint32_t>> found;
+    double bound = radius * radius;
+    auto visit = [&](const Node &node, double d2)
+    { found.emplace_back(d2, node.index); };
+    if (radius >= 0)
+        search(query, 0, nodes_.size(), bound, visit);
+
+    std::sort(found.begin(), found.end());
+    std::vector<Neighbor> neighbors;
+    neighbors.reserve(found.size());
+    for (const auto &[d2, index] : found)
+        neighbors.push_back({index, std::sqrt(d2)});
+    return neighbors;
+}
+
+KdTree::BatchResult KdTree::nearestBatch(const PointCloud &queries, std::size_t k, unsigned threads) const
+{
+    if (queries.dimensions() != dimensions_)
+        throw std::invalid_argument("KdTree::nearestBatch: queries are " + std::to_string(queries.dimensions()) +
+                                    "D, the tree is " + std::to_string(dimensions_) + "D");
+
+    BatchResult result;
+    result.k = std::min(k, nodes_.size());
+    result.indices.resize(queries.size() * result.k);
+    result.distances.resize(queries.size() * result.k);
+    parallelChunks(queries.size(), threads, [&](std::size_t begin, std::size_t end)
+                   {
+        for (std::size_t q = begin; q < end; ++q)
+        {
+            auto neighbors = nearest(queries.coordinates(q), result.k);
+            for (std::size_t j = 0; j < neighbors.size(); ++j)
+            {
+                result.indices[q * result.k + j] = neighbors[j].index;
+                result.distances[q * result.k + j] = neighbors[j].distance;
+            }
+        } });
+    return result;
+}
+
+std::vector<std::vector<KdTree::Neighbor>> KdTree::withinRadiusBatch(const PointCloud &queries, double radius, unsigned threads) const
+{
+    if (queries.dimensions() != dimensions_)
+        throw std::invalid_argument("KdTree::withinRadiusBatch: queries are " + std::to_string(queries.dimensions()) +
+                                    "D, the tree is " + std::to_string(dimensions_) + "D");
+
+    std::vector<std::vector<Neighbor>> results(queries.size());
+    parallelChunks(queries.size(), threads, [&](std::size_t begin, std::size_t end)
+                   {
+        for (std::size_t q = begin; q < end; ++q)
+            results[q] = withinRadius(queries.coordinates(q), radius); });
+    return results;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "point_cloud.hpp"
+
+// k-d tree over a PointCloud (2D or 3D) for nearest-neighbour and radius queries
+//
+// Point::distanceTo answers one pair at a time, so finding neighbours by scanning is O(n) per
+// query. The tree answers the same questions in about O(log n).
+//
+// Layout: the points are copied into one flat array in tree order. The subtree over positions
+// [begin, end) has its splitting point at the middle, (begin + end) / 2, with the left subtree
+// before it and the right one after it, so there are no child pointers to chase. Ranges of at
+// most leafSize points are scanned linearly. The tree is built by median partitioning
+// (std::nth_element) along the widest axis; the two halves of large ranges are built on
+// separate threads.
+//
+//     KdTree tree(cloud);
+//     auto nearest = tree.nearest({x, y, 0.0}, 5);      // 5 closest, nearest first
+//     auto around = tree.withinRadius({x, y, 0.0}, 2.5);
+//
+// Indices in the results refer to positions in the cloud the tree was built from. The tree
+// keeps its own copy of the coordinates, so the cloud may change or go away afterwards.
+
+class KdTree
+{
+public:
+    using Coordinates = PointCloud::Coordinates;
+
+    struct Neighbor
+    {
+        std::uint32_t index; // position in the original cloud
+        double distance;
+    };
+
+    // k nearest neighbours of many queries, k entries per query (fewer if the tree is smaller)
+    struct BatchResult
+    {
+        std::size_t k = 0;
+        std::vector<std::uint32_t> indices;  // queries * k, row per query, nearest first
+        std::vector<double> distances;       // same layout
+    };
+
+    static constexpr std::size_t leafSize = 16;
+
+    // threads == 0: std::thread::hardware_concurrency(). Throws std::length_error for clouds
+    // with 2^32 points or more.
+    explicit KdTree(const PointCloud &cloud, unsigned threads = 0);
+
+    std::size_t size() const { return nodes_.size(); }
+    std::size_t dimensions() const { return dimensions_; }
+
+    // The k closest points, nearest first
+    std::vector<Neighbor> nearest(const Coordinates &query, std::size_t k) const;
+
+    // Every point within `radius` (inclusive), nearest first
+    std::vector<Neighbor> withinRadius(const Coordinates &query, double radius) const;
+
+    // nearest() / withinRadius() for every point of `queries`, split over `threads` threads
+    BatchResult nearestBatch(const PointCloud &queries, std::size_t k, unsigned threads = 0) const;
+    std::vector<std::vector<Neighbor>> withinRadiusBatch(const PointCloud &queries, double radius, unsigned threads = 0) const;
+
+private:
+    struct Node
+    {
+        double coordinates[3];
+        std::uint32_t index; // position in the original cloud
+        std::uint8_t axis;   // splitting axis when this node is the middle of a range
+    };
+
+    void build(std::size_t begin, std::size_t end, unsigned threads);
+
+    template <typename Visit>
+    void search(const Coordinates &query, std::size_t begin, std::size_t end, double &bound, Visit &visit) const;
+
+    double squaredDistance(const Node &node, const Coordinates &query) const;
+
+    std::size_t dimensions_;
+    std::vector<Node> nodes_;
+};
@@ -0,0 +1,236 @@
+#include "matrix.hpp"
+#include "parallel_chunks.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    // Cache blocking, the same for every ISA: an MC x KC block of A (96 KiB of floats) stays
+    // in L2, a KC x NR sliver of B in L1, and a KC x NC panel of B in L3
+    constexpr std::size_t KC = 256;
+    constexpr std::size_t MC = 96;
+    constexpr std::size_t NC = 2048;
+    constexpr std::size_t MR = 6; // rows of the register tile
+
+    // Register tile of MR x NR, NR being two SIMD vectors of `Bytes` bytes
+    template <typename T, std::size_t Bytes>
+    struct Tile
+    {
+        typedef T Vector __attribute__((vector_size(Bytes)));
+        static constexpr std::size_t lanes = Bytes / sizeof(T);
+        static constexpr std::size_t NR = 2 * lanes;
+    };
+
+    // Copies NR-wide column slivers [firstSliver, lastSliver) of B[pc .. pc + kc, jc ..), each
+    // stored k-major, so the micro-kernel reads them strictly sequentially. Columns past the
+    // edge are zero.
+    template <typename T, std::size_t NR>
+    void packB(const Matrix<T> &b, std::size_t pc, std::size_t kc, std::size_t jc, T *out, std::size_t firstSliver, std::size_t lastSliver)
+    {
+        const std::size_t n = b.cols();
+        for (std::size_t sliver = firstSliver; sliver < lastSliver; ++sliver)
+        {
+            const std::size_t j0 = jc + sliver * NR;
+            T *dst = out + sliver * NR * kc;
+            const std::size_t width = std::min(NR, n - j0);
+            for (std::size_t k = 0; k < kc; ++k, dst += NR)
+            {
+                const T *src = b.data() + (pc + k) * n + j0;
+                std::copy(src, src + width, dst);
+                std::fill(dst + width, dst + NR, T{});
+            }
+        }
+    }
+
+    // Copies A[ic .. ic + mc, pc .. pc + kc) into MR-tall slivers, k-major. Rows past the edge are zero.
+    template <typename T>
+    void packA(const Matrix<T> &a, std::size_t ic, std::size_t mc, std::size_t pc, std::size_t kc, T *out)
+    {
+        const std::size_t lda = a.cols();
+        for (std::size_t i0 = 0; i0 < mc; i0 += MR)
+        {
+            const std::size_t height = std::min(MR, mc - i0);
+            T *dst = out + i0 * kc;
+            for (std::size_t k = 0; k < kc; ++k, dst += MR)
+            {
+                for (std::size_t i = 0; i < height; ++i)
+                    dst[i] = a.data()[(ic + i0 + i) * lda + pc + k];
+                for (std::size_t i = height; i < MR; ++i)
+                    dst[i] = T{};
+            }
+        }
+    }
+
+    // C[0 .. mr, 0 .. nr) += packed A sliver * packed B sliver, with the tile in registers
+    template <typename T, std::size_t Bytes>
+    __attribute__((always_inline)) inline void microKernel(std::size_t kc, const T *a, const T *b, T *c, std::size_t ldc, std::size_t mr, std::size_t nr)
+    {
+        using V = typename Tile<T, Bytes>::Vector;
+        constexpr std::size_t L = Tile<T, Bytes>::lanes, NR = Tile<T, Bytes>::NR;
+
+        V acc[MR][2] = {};
+        for (std::size_t k = 0; k < kc; ++k, a += MR, b += NR)
+        {
+            V b0, b1;
+            std::memcpy(&b0, b, sizeof(V));
+            std::memcpy(&b1, b + L, sizeof(V));
+            for (std::size_t i = 0; i < MR; ++i)
+            {
+                V ai = V{} + a[i]; // broadcast
+                acc[i][0] += ai * b0;
+                acc[i][1] += ai * b1;
+            }
+        }
+
+        if (mr == MR && nr == NR)
+        {
+            for (std::size_t i = 0; i < MR; ++i)
+            {
+                V c0, c1;
+                std::memcpy(&c0, c + i * ldc, sizeof(V));
+                std::memcpy(&c1, c + i * ldc + L, sizeof(V));
+                c0 += acc[i][0];
+                c1 += acc[i][1];
+                std::memcpy(c + i * ldc, &c0, sizeof(V));
+                std::memcpy(c + i * ldc + L, &c1, sizeof(V));
+            }
+        }
+        else
+        {
+            for (std::size_t i = 0; i < mr; ++i)
+                for (std::size_t j = 0; j < nr; ++j)
+                    c[i * ldc + j] += acc[i][j / L][j % L];
+        }
+    }
+
+    // One packed A block times one packed B panel, tile by tile
+    template <typename T, std::size_t Bytes>
+    __attribute__((always_inline)) inline void macroKernel(std::size_t mc, std::size_t nc, std::size_t kc, const T *packedA, const T *packedB, T *c, std::size_t ldc)
+    {
+        constexpr std::size_t NR = Tile<T, Bytes>::NR;
+        for (std::size_t jr = 0; jr < nc; jr += NR)
+            for (std::size_t ir = 0; ir < mc; ir += MR)
+                microKernel<T, Bytes>(kc, packedA + ir * kc, packedB + jr * kc, c + ir * ldc + jr, ldc,
+                                      std::min(MR, mc - ir), std::min(NR, nc - jr));
+    }
+
+    // One version per ISA; "fma" lets the compiler turn acc += a * b into one instruction
+    __attribute__((target("avx512f,fma"))) void macroAvx512(std::size_t mc, std::size_t nc, std::size_t kc, const float *a, const float *b, float *c, std::size_t ldc) { macroKernel<float, 64>(mc, nc, kc, a, b, c, ldc); }
+    __attribute__((target("avx512f,fma"))) void macroAvx512(std::size_t mc, std::size_t nc, std::size_t kc, const double *a, const double *b, double *c, std::size_t ldc) { macroKernel<double, 64>(mc, nc, kc, a, b, c, ldc); }
+    __attribute__((target("avx2,fma"))) void macroAvx2(std::size_t mc, std::size_t nc, std::size_t kc, const float *a, const float *b, float *c, std::size_t ldc) { macroKernel<float, 32>(mc, nc, kc, a, b, c, ldc); }
+    __attribute__((target("avx2,fma"))) void macroAvx2(std::size_t mc, std::size_t nc, std::size_t kc, const double *a, const double *b, double *c, std::size_t ldc) { macroKernel<double, 32>(mc, nc, kc, a, b, c, ldc); }
+    void macroBaseline(std::size_t mc, std::size_t nc, std::size_t kc, const float *a, const float *b, float *c, std::size_t ldc) { macroKernel<float, 16>(mc, nc, kc, a, b, c, ldc); }
+    void macroBaseline(std::size_t mc, std::size_t nc, std::size_t kc, const double *a, const double *b, double *c, std::size_t ldc) { macroKernel<double, 16>(mc, nc, kc, a, b, c, ldc); }
+
+    template <typename T>
+    using MacroKernel = void (*)(std::size_t, std::size_t, std::size_t, const T *, const T *, T *, std::size_t);
+
+    template <typename T, std::size_t Bytes>
+    void gemmBlocked(const Matrix<T> &a, const Matrix<T> &b, Matrix<T> &c, unsigned threads, MacroKernel<T> macro)
+    {
+        constexpr std::size_t NR = Tile<T, Bytes>::NR;
+        const std::size_t m = a.rows(), n = b.cols(), k = a.cols();
+        std::fill(c.data(), c.data() + m * n, T{});
+        if (m == 0 || n == 0 || k == 0)
+            return;
+
+        std::vector<T, AlignedAllocator<T>> packedB(KC * ((NC + NR - 1) / NR) * NR);
+        const std::size_t rowBlocks = (m + MC - 1) / MC;
+        threads = resolveThreads(threads);
+
+        for (std::size_t jc = 0; jc < n; jc += NC)
+        {
+            const std::size_t nc = std::min(NC, n - jc);
+            const std::size_t slivers = (nc + NR - 1) / NR;
+            for (std::size_t pc = 0; pc < k; pc += KC)
+            {
+                const std::size_t kc = std::min(KC, k - pc);
+                parallelChunks(slivers, threads, [&](std::size_t first, std::size_t last)
+                               { packB<T, NR>(b, pc, kc, jc, packedB.data(), first, last); });
+
+                // Each thread owns whole MC-row blocks of C, so the writes never overlap
+                parallelChunks(rowBlocks, threads, [&](std::size_t first, std::size_t last)
+                               {
+                    std::vector<T, AlignedAllocator<T>> packedA(MC * KC);
+                    for (std::size_t block = first; block < last; ++block)
+                    {
+                        const std::size_t ic = block * MC, mc = std::min(MC, m - ic);
+                        packA(a, ic, mc, pc, kc, packedA.data());
+                        macro(mc, nc, kc, packedA.data(), packedB.data(), c.data() + ic * n + jc, n);
+                    } });
+            }
+        }
+    }
+
+    template <typename T>
+    void gemmDispatch(const Matrix<T> &a, const Matrix<T> &b, Matrix<T> &c, unsigned threads)
+    {
+        if (a.cols() != b.rows() || c.rows() != a.rows() || c.cols() != b.cols())
+            throw std::invalid_argument("gemm: cannot multiply " + std::to_string(a.rows()) + " x " + std::to_string(a.cols()) +
+                                        " by " + std::to_string(b.rows()) + " x " + std::to_string(b.cols()) + " into " +
+                                        std::to_string(c.rows()) + " x " + std::to_string(c.cols()));
+        // c is cleared before the first block of a and b is read
+        if (&c == &a || &c == &b)
+            throw std::invalid_argument("gemm: the output must not be one of the inputs");
+
+        static const int isa = []
+        {
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("fma"))
+                return 2;
+            if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+                return 1;
+            return 0;
+        }();
+        if (isa == 2)
+            gemmBlocked<T, 64>(a, b, c, threads, macroAvx512);
+        else if (isa == 1)
+            gemmBlocked<T, 32>(a, b, c, threads, macroAvx2);
+        else
+            gemmBlocked<T, 16>(a, b, c, threads, macroBaseline);
+    }
+
+    // Below this many elements a block is transposed directly; 32 x 32 doubles is 8 KiB
+    constexpr std::size_t transposeLeaf = 32;
+
+    template <typename T>
+    void transposeBlock(const T *in, std::size_t ldi, T *out, std::size_t ldo, std::size_t rows, std::size_t cols)
+    {
+        if (rows <= transposeLeaf && cols <= transposeLeaf)
+        {
+            for (std::size_t r = 0; r < rows; ++r)
+                for (std::size_t c = 0; c < cols; ++c)
+                    out[c * ldo + r] = in[r * ldi + c];
+            return;
+        }
+        if (rows >= cols)
+        {
+            std::size_t half = rows / 2;
+            transposeBlock(in, ldi, out, ldo, half, cols);
+            transposeBlock(in + half * ldi, ldi, out + half, ldo, rows - half, cols);
+        }
+        else
+        {
+            std::size_t half = cols / 2;
+            transposeBlock(in, ldi, out, ldo, rows, half);
+            transposeBlock(in + half, ldi, out + half * ldo, ldo, rows, cols - half);
+        }
+    }
+
+    template <typename T>
+    void transposeChecked(const Matrix<T> &in, Matrix<T> &out)
+    {
+        if (out.rows() != in.cols() || out.cols() != in.rows())
+            throw std::invalid_argument("transpose: output is " + std::to_string(out.rows()) + " x " + std::to_string(out.cols()) +
+                                        ", needs " + std::to_string(in.cols()) + " x " + std::to_string(in.rows()));
+        if (in.rows() != 0 && in.cols() != 0)
+            transposeBlock(in.data(), in.cols(), out.data(), out.cols(), in.rows(), in.cols());
+    }
+}
+
+void gemm(const Matrix<float> &a, const Matrix<float> &b, Matrix<float> &c, unsigned threads) { gemmDispatch(a, b, c, threads); }
+void gemm(const Matrix<double> &a, const Matrix<double> &b, Matrix<double> &c, unsigned threads) { gemmDispatch(a, b, c, threads); }
+
+void transpose(const Matrix<float> &in, Matrix<float> &out) { transposeChecked(in, out); }
+void transpose(const Matrix<double> &in, Matrix<double> &out) { transposeChecked(in, out); }
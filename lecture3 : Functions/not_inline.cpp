@@ -0,0 +1,7 @@
+#include "inline_examples.hpp"
+
+// Example 2: Non-inline version for comparison
+int squareNotInline(int x)
+{
+    return x * x;
+}
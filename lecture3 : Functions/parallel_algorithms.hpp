@@ -0,0 +1,209 @@
+#pragma once
+
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <numeric>
+#include <optional>
+#include <utility>
+
+// Parallel versions of for_each, transform, count_if, reduce and transform_reduce
+//
+// They take the same iterator pairs and lambdas as the <algorithm>/<numeric> calls in
+// lambdaExamples (auto_examples.cpp), optionally preceded by the pool to run on:
+//
+//     auto evens = Parallel::count_if(numbers.begin(), numbers.end(), isEven);
+//     auto sum = Parallel::transform_reduce(pool, v.begin(), v.end(), 0.0, std::plus<>(), square);
+//
+// A range is split in halves recursively down to a grain of about 1/(8 x threads) of the
+// input; the right half becomes a task, so idle threads steal the biggest pieces left and a
+// thread that finishes early takes over work from a slow one. Ranges shorter than
+// serialCutoff, or a pool with one thread, simply call the std:: algorithm.
+//
+// The iterators must be random access. The lambdas run concurrently on different elements,
+// so they must not write shared state; reduce and transform_reduce combine partial results
+// in order but with a different grouping, so the operation must be associative (floating
+// point sums can differ from the serial ones in the last bits).
+
+namespace Parallel
+{
+    // Below this many elements, splitting costs more than it gains
+    inline constexpr std::size_t serialCutoff = std::size_t{1} << 14;
+
+    namespace detail
+    {
+        inline std::size_t grainSize(const ThreadPool &pool, std::size_t count)
+        {
+            return std::max<std::size_t>(serialCutoff / 4, count / (8 * std::size_t{pool.concurrency()}));
+        }
+
+        inline bool runSerially(const ThreadPool &pool, std::size_t count)
+        {
+            return count < serialCutoff || pool.concurrency() == 1;
+        }
+
+        template <typename It>
+        bool isShort(It first, It last)
+        {
+            return static_cast<std::size_t>(last - first) < serialCutoff;
+        }
+
+        // combine(leaf(begin, middle), leaf(middle, end)), recursively; the right half is a task
+        template <typename T, typename Leaf, typename Combine>
+        T splitReduce(ThreadPool &pool, std::size_t begin, std::size_t end, std::size_t grain, const Leaf &leaf,
+                      const Combine &combine)
+        {
+            if (end - begin <= grain)
+                return leaf(begin, end);
+            const std::size_t middle = begin + (end - begin) / 2;
+            std::optional<T> right;
+            TaskGroup group(pool);
+            group.run([&]
+                      { right.emplace(splitReduce<T>(pool, middle, end, grain, leaf, combine)); });
+            T left = splitReduce<T>(pool, begin, middle, grain, leaf, combine);
+            group.wait();
+            return combine(std::move(left), std::move(*right));
+        }
+
+        template <typename Leaf>
+        void splitFor(ThreadPool &pool, std::size_t count, const Leaf &leaf)
+        {
+            struct Unit
+            {
+            };
+            splitReduce<Unit>(
+                pool, 0, count, grainSize(pool, count), [&](std::size_t begin, std::size_t end)
+                { leaf(begin, end); return Unit{}; },
+                [](Unit, Unit)
+                { return Unit{}; });
+        }
+    }
+
+    template <typename It, typename F>
+    void for_each(ThreadPool &pool, It first, It last, F f)
+    {
+        const auto count = static_cast<std::size_t>(last - first);
+        if (detail::runSerially(pool, count))
+        {
+            std::for_each(first, last, f);
+            return;
+        }
+        detail::splitFor(pool, count, [&](std::size_t begin, std::size_t end)
+                         { std::for_each(first + begin, first + end, f); });
+    }
+
+    // Returns the end of the output, like std::transform
+    template <typename It, typename Out, typename F>
+    Out transform(ThreadPool &pool, It first, It last, Out out, F f)
+    {
+        const auto count = static_cast<std::size_t>(last - first);
+        if (detail::runSerially(pool, count))
+            return std::transform(first, last, out, f);
+        detail::splitFor(pool, count, [&](std::size_t begin, std::size_t end)
+                         { std::transform(first + begin, first + end, out + begin, f); });
+        return out + count;
+    }
+
+    template <typename It, typename Pred>
+    typename std::iterator_traits<It>::difference_type count_if(ThreadPool &pool, It first, It last, Pred pred)
+    {
+        using Count = typename std::iterator_traits<It>::difference_type;
+        const auto count = static_cast<std::size_t>(last - first);
+        if (detail::runSerially(pool, count))
+            return std::count_if(first, last, pred);
+        return detail::splitReduce<Count>(
+            pool, 0, count, detail::grainSize(pool, count), [&](std::size_t begin, std::size_t end)
+            { return std::count_if(first + begin, first + end, pred); },
+            [](Count a, Count b)
+            { return a + b; });
+    }
+
+    // init op x0 op x1 op ... for an associative op
+    template <typename It, typename T, typename Op, typename TransformOp>
+    T transform_reduce(ThreadPool &pool, It first, It last, T init, Op op, TransformOp transformOp)
+    {
+        const auto count = static_cast<std::size_t>(last - first);
+        if (detail::runSerially(pool, count))
+            return std::transform_reduce(first, last, std::move(init), op, transformOp);
+        // Each part starts from its first element, so no identity element is needed
+        T total = detail::splitReduce<T>(
+            pool, 0, count, detail::grainSize(pool, count), [&](std::size_t begin, std::size_t end)
+            { return std::transform_reduce(first + begin + 1, first + end, T(transformOp(first[begin])), op, transformOp); },
+            [&](T a, T b)
+            { return op(std::move(a), std::move(b)); });
+        return op(std::move(init), std::move(total));
+    }
+
+    template <typename It, typename T, typename Op>
+    T reduce(ThreadPool &pool, It first, It last, T init, Op op)
+    {
+        const auto count = static_cast<std::size_t>(last - first);
+        if (detail::runSerially(pool, count))
+            return std::reduce(first, last, std::move(init), op);
+        T total = detail::splitReduce<T>(
+            pool, 0, count, detail::grainSize(pool, count), [&](std::size_t begin, std::size_t end)
+            { return std::reduce(first + begin + 1, first + end, T(first[begin]), op); },
+            [&](T a, T b)
+            { return op(std::move(a), std::move(b)); });
+        return op(std::move(init), std::move(total));
+    }
+
+    template <typename It, typename T>
+    T reduce(ThreadPool &pool, It first, It last, T init)
+    {
+        return Parallel::reduce(pool, first, last, std::move(init), std::plus<>());
+    }
+
+    // The same, on ThreadPool::shared(). Short ranges are checked first, so they never start
+    // the shared pool's threads
+    template <typename It, typename F>
+    void for_each(It first, It last, F f)
+    {
+        if (detail::isShort(first, last))
+            std::for_each(first, last, f);
+        else
+            Parallel::for_each(ThreadPool::shared(), first, last, std::move(f));
+    }
+
+    template <typename It, typename Out, typename F>
+    Out transform(It first, It last, Out out, F f)
+    {
+        if (detail::isShort(first, last))
+            return std::transform(first, last, out, f);
+        return Parallel::transform(ThreadPool::shared(), first, last, out, std::move(f));
+    }
+
+    template <typename It, typename Pred>
+    typename std::iterator_traits<It>::difference_type count_if(It first, It last, Pred pred)
+    {
+        if (detail::isShort(first, last))
+            return std::count_if(first, last, pred);
+        return Parallel::count_if(ThreadPool::shared(), first, last, std::move(pred));
+    }
+
+    template <typename It, typename T, typename Op>
+    T reduce(It first, It last, T init, Op op)
+    {
+        if (detail::isShort(first, last))
+            return std::reduce(first, last, std::move(init), op);
+        return Parallel::reduce(ThreadPool::shared(), first, last, std::move(init), std::move(op));
+    }
+
+    template <typename It, typename T>
+    T reduce(It first, It last, T init)
+    {
+        return Parallel::reduce(first, last, std::move(init), std::plus<>());
+    }
+
+    template <typename It, typename T, typename Op, typename TransformOp>
+    T transform_reduce(It first, It last, T init, Op op, TransformOp transformOp)
+    {
+        if (detail::isShort(first, last))
+            return std::transform_reduce(first, last, std::move(init), op, transformOp);
+        return Parallel::transform_reduce(ThreadPool::shared(), first, last, std::move(init), std::move(op),
+                                          std::move(transformOp));
+    }
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// Splitting a loop over [0, count) into one contiguous chunk per thread
+
+// threads == 0 means one per hardware thread
+inline unsigned resolveThreads(unsigned threads)
+{
+    return threads != 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
+}
+
+// Runs body(begin, end) on `threads` threads over contiguous chunks of [0, count).
+// With one thread (or one element) the body runs on the calling thread.
+template <typename Body>
+void parallelChunks(std::size_t count, unsigned threads, Body body)
+{
+    threads = static_cast<unsigned>(std::min<std::size_t>(resolveThreads(threads), std::max<std::size_t>(1, count)));
+    if (threads == 1)
+    {
+        body(std::size_t{0}, count);
+        return;
+    }
+    std::vector<std::thread> workers;
+    std::size_t chunk = (count + threads - 1) / threads;
+    for (std::size_t begin = 0; begin < count; begin += chunk)
+        workers.emplace_back(body, begin, std::min(count, begin + chunk));
+    for (auto &worker : workers)
+        worker.join();
+}
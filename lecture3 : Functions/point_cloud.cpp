@@ -0,0 +1,212 @@
+#include "point_cloud.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+    typedef double Doubles __attribute__((vector_size(32)));
+
+    constexpr std::size_t lanes = sizeof(Doubles) / sizeof(double);
+
+    // Column tile for distanceMatrix: 512 columns x 3 coordinates is 12 KiB, which stays in L1
+    // while every row is computed against it
+    constexpr std::size_t columnTile = 512;
+
+    // Plain loops over restrict pointers; CMakeLists.txt sets the flags the vectorizer needs
+    // for them (-fno-math-errno, -fvect-cost-model=dynamic)
+    __attribute__((target_clones("avx512f", "avx2", "default"))) void distanceKernel(
+        const double *__restrict xs, const double *__restrict ys, const double *__restrict zs, std::size_t count,
+        double qx, double qy, double qz, double *__restrict out)
+    {
+        if (zs)
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                double dx = xs[i] - qx, dy = ys[i] - qy, dz = zs[i] - qz;
+                out[i] = std::sqrt(dx * dx + dy * dy + dz * dz);
+            }
+        }
+        else
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                double dx = xs[i] - qx, dy = ys[i] - qy;
+                out[i] = std::sqrt(dx * dx + dy * dy);
+            }
+        }
+    }
+
+    // Reductions are not vectorized automatically (that would reorder the additions),
+    // so they use two vector accumulators explicitly
+    __attribute__((target_clones("avx512f", "avx2", "default"))) double sumKernel(const double *values, std::size_t count)
+    {
+        Doubles a = {}, b = {};
+        std::size_t i = 0;
+        for (; i + 2 * lanes <= count; i += 2 * lanes)
+        {
+            Doubles va, vb;
+            std::memcpy(&va, values + i, sizeof(va));
+            std::memcpy(&vb, values + i + lanes, sizeof(vb));
+            a += va;
+            b += vb;
+        }
+        a += b;
+        double sum = 0.0;
+        for (std::size_t lane = 0; lane < lanes; ++lane)
+            sum += a[lane];
+        for (; i < count; ++i)
+            sum += values[i];
+        return sum;
+    }
+
+    __attribute__((target_clones("avx512f", "avx2", "default"))) void minMaxKernel(const double *values, std::size_t count, double &minimum, double &maximum)
+    {
+        Doubles low, high;
+        for (std::size_t lane = 0; lane < lanes; ++lane)
+            low[lane] = high[lane] = values[0];
+        std::size_t i = 0;
+        for (; i + lanes <= count; i += lanes)
+        {
+            Doubles v;
+            std::memcpy(&v, values + i, sizeof(v));
+            low = v < low ? v : low;
+            high = v > high ? v : high;
+        }
+        minimum = low[0];
+        maximum = high[0];
+        for (std::size_t lane = 1; lane < lanes; ++lane)
+        {
+            minimum = std::min(minimum, low[lane]);
+            maximum = std::max(maximum, high[lane]);
+        }
+        for (; i < count; ++i)
+        {
+            minimum = std::min(minimum, values[i]);
+            maximum = std::max(maximum, values[i]);
+        }
+    }
+}
+
+PointCloud::PointCloud(std::size_t dimensions) : dimensions_(dimensions)
+{
+    if (dimensions != 2 && dimensions != 3)
+        throw std::invalid_argument("PointCloud: dimensions must be 2 or 3, not " + std::to_string(dimensions));
+}
+
+PointCloud PointCloud::fromPoints(const std::vector<Point> &points)
+{
+    PointCloud cloud(2);
+    cloud.reserve(points.size());
+    for (const Point &point : points)
+        cloud.push_back(point);
+    return cloud;
+}
+
+std::vector<Point> PointCloud::toPoints() const
+{
+    std::vector<Point> points;
+    points.reserve(size());
+    for (std::size_t i = 0; i < size(); ++i)
+        points.emplace_back(columns_[0][i], columns_[1][i]);
+    return points;
+}
+
+void PointCloud::push_back(double x, double y, double z)
+{
+    columns_[0].push_back(x);
+    columns_[1].push_back(y);
+    if (dimensions_ == 3)
+        columns_[2].push_back(z);
+}
+
+void PointCloud::reserve(std::size_t count)
+{
+    for (std::size_t d = 0; d < dimensions_; ++d)
+        columns_[d].reserve(count);
+}
+
+void PointCloud::clear()
+{
+    for (Column &column : columns_)
+        column.clear();
+}
+
+PointCloud::Coordinates PointCloud::coordinates(std::size_t index) const
+{
+    return {columns_[0][index], columns_[1][index], dimensions_ == 3 ? columns_[2][index] : 0.0};
+}
+
+void PointCloud::distancesTo(const Coordinates &query, std::span<double> out) const
+{
+    if (out.size() < size())
+        throw std::invalid_argument("PointCloud::distancesTo: output holds " + std::to_string(out.size()) +
+                                    " values, the cloud has " + std::to_string(size()) + " points");
+    const double *zs = dimensions_ == 3 ? columns_[2].data() : nullptr;
+    distanceKernel(columns_[0].data(), columns_[1].data(), zs, size(), query[0], query[1], query[2], out.data());
+}
+
+std::vector<double> PointCloud::distancesTo(const Point &query) const
+{
+    std::vector<double> distances(size());
+    distancesTo({query.getX(), query.getY(), 0.0}, distances);
+    return distances;
+}
+
+void PointCloud::requireSameDimensions(const PointCloud &other) const
+{
+    if (other.dimensions_ != dimensions_)
+        throw std::invalid_argument("PointCloud: cannot mix " + std::to_string(dimensions_) + "D and " +
+                                    std::to_string(other.dimensions_) + "D clouds");
+}
+
+void PointCloud::distanceMatrix(const PointCloud &other, std::span<double> out) const
+{
+    requireSameDimensions(other);
+    const std::size_t rows = size(), columns = other.size();
+    if (out.size() < rows * columns)
+        throw std::invalid_argument("PointCloud::distanceMatrix: output holds " + std::to_string(out.size()) +
+                                    " values, needs " + std::to_string(rows * columns));
+
+    const double *zs = dimensions_ == 3 ? other.columns_[2].data() : nullptr;
+    for (std::size_t j0 = 0; j0 < columns; j0 += columnTile)
+    {
+        const std::size_t width = std::min(columnTile, columns - j0);
+        for (std::size_t i = 0; i < rows; ++i)
+        {
+            Coordinates query = coordinates(i);
+            distanceKernel(other.columns_[0].data() + j0, other.columns_[1].data() + j0, zs ? zs + j0 : nullptr, width,
+                           query[0], query[1], query[2], out.data() + i * columns + j0);
+        }
+    }
+}
+
+std::vector<double> PointCloud::distanceMatrix(const PointCloud &other) const
+{
+    std::vector<double> matrix(size() * other.size());
+    distanceMatrix(other, matrix);
+    return matrix;
+}
+
+PointCloud::Coordinates PointCloud::centroid() const
+{
+    if (empty())
+        throw std::logic_error("PointCloud::centroid: the cloud is empty");
+    Coordinates mean{};
+    for (std::size_t d = 0; d < dimensions_; ++d)
+        mean[d] = sumKernel(columns_[d].data(), size()) / static_cast<double>(size());
+    return mean;
+}
+
+PointCloud::BoundingBox PointCloud::boundingBox() const
+{
+    if (empty())
+        throw std::logic_error("PointCloud::boundingBox: the cloud is empty");
+    BoundingBox box{};
+    for (std::size_t d = 0; d < dimensions_; ++d)
+        minMaxKernel(columns_[d].data(), size(), box.min[d], box.max[d]);
+    return box;
+}
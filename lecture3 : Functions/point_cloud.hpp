@@ -0,0 +1,82 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include "aligned_allocator.hpp"
+#include "inline_examples.hpp"
+
+// Structure-of-arrays container for many 2D or 3D points
+//
+// Point (inline_examples.hpp) keeps x and y side by side and answers one distance at a time.
+// PointCloud keeps all x values in one array, all y values in another (and z for 3D), each
+// aligned to a cache line. A batch operation then streams through contiguous doubles, which
+// the compiler turns into SIMD code (the kernels are cloned for AVX-512, AVX2 and baseline).
+//
+//     PointCloud cloud = PointCloud::fromPoints(points);
+//     std::vector<double> d = cloud.distancesTo(Point(1.0, 2.0));    // d[i] == points[i].distanceTo(...)
+//     auto box = cloud.boundingBox();
+//
+// Distances are computed as sqrt(dx*dx + dy*dy (+ dz*dz)), like Point::distanceTo.
+
+class PointCloud
+{
+public:
+    using Coordinates = std::array<double, 3>; // z is 0 for 2D clouds
+    using Column = std::vector<double, AlignedAllocator<double>>;
+
+    struct BoundingBox
+    {
+        Coordinates min;
+        Coordinates max;
+    };
+
+    // dimensions must be 2 or 3 (std::invalid_argument otherwise)
+    explicit PointCloud(std::size_t dimensions = 2);
+
+    static PointCloud fromPoints(const std::vector<Point> &points);
+    std::vector<Point> toPoints() const; // a 3D cloud drops z
+
+    void push_back(const Point &point) { push_back(point.getX(), point.getY()); }
+    void push_back(double x, double y, double z = 0.0);
+    void reserve(std::size_t count);
+    void clear();
+
+    std::size_t size() const { return columns_[0].size(); }
+    bool empty() const { return columns_[0].empty(); }
+    std::size_t dimensions() const { return dimensions_; }
+
+    Point point(std::size_t index) const { return Point(columns_[0][index], columns_[1][index]); }
+    Coordinates coordinates(std::size_t index) const;
+
+    // The raw columns; zs() is empty for a 2D cloud
+    std::span<const double> xs() const { return columns_[0]; }
+    std::span<const double> ys() const { return columns_[1]; }
+    std::span<const double> zs() const { return columns_[2]; }
+
+    // out[i] = distance from point i to query; out must hold size() values
+    void distancesTo(const Coordinates &query, std::span<double> out) const;
+    std::vector<double> distancesTo(const Point &query) const;
+
+    // out[i * other.size() + j] = distance from point i to other's point j (row-major).
+    // Works in tiles so that a block of `other` stays in L1 while many rows use it.
+    void distanceMatrix(const PointCloud &other, std::span<double> out) const;
+    std::vector<double> distanceMatrix(const PointCloud &other) const;
+
+    // All-pairs distances within this cloud, size() x size()
+    std::vector<double> pairwiseDistances() const { return distanceMatrix(*this); }
+
+    // Mean of all points; std::logic_error for an empty cloud
+    Coordinates centroid() const;
+
+    // Smallest axis-aligned box containing every point; std::logic_error for an empty cloud
+    BoundingBox boundingBox() const;
+
+private:
+    void requireSameDimensions(const PointCloud &other) const;
+
+    std::size_t dimensions_;
+    std::array<Column, 3> columns_;
+};
@@ -0,0 +1,343 @@
+#include "probe.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+
+namespace probe
+{
+    namespace
+    {
+        struct SiteInfo
+        {
+            std::string name;
+            Kind kind;
+        };
+
+        struct Registry
+        {
+            std::mutex mutex;
+            std::vector<SiteInfo> sites;
+            std::size_t dropped = 0;
+            // Slots of every thread running now, or free for the next one; at most one set per
+            // thread that ran at the same time
+            std::vector<std::unique_ptr<detail::ThreadData>> threads;
+            std::vector<detail::ThreadData *> free;
+            // What threads recorded before they exited
+            std::unique_ptr<detail::ThreadData> retired = std::make_unique<detail::ThreadData>();
+            std::string exitPath;
+            bool exitRegistered = false;
+        };
+
+        // Never destroyed, so probes in other static destructors and the at-exit report
+        // still find it
+        Registry &registry()
+        {
+            static Registry *instance = new Registry;
+            return *instance;
+        }
+
+        // Adds `from` into `into` and clears `from`; only while neither thread can write them
+        void retire(detail::Slot &into, detail::Slot &from)
+        {
+            auto move = [](std::atomic<std::uint64_t> &value, std::uint64_t reset)
+            { return value.exchange(reset, std::memory_order_relaxed); };
+            detail::bump(into.count, move(from.count, 0));
+            detail::bump(into.sum, move(from.sum, 0));
+            const std::uint64_t min = move(from.min, std::numeric_limits<std::uint64_t>::max());
+            if (min < into.min.load(std::memory_order_relaxed))
+                into.min.store(min, std::memory_order_relaxed);
+            const std::uint64_t max = move(from.max, 0);
+            if (max > into.max.load(std::memory_order_relaxed))
+                into.max.store(max, std::memory_order_relaxed);
+            for (unsigned b = 0; b < detail::bucketCount; ++b)
+                detail::bump(into.buckets[b], move(from.buckets[b], 0));
+        }
+
+        void releaseThread(detail::ThreadData *data)
+        {
+            Registry &r = registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            for (unsigned site = 0; site < r.sites.size(); ++site)
+                retire(r.retired->slots[site], data->slots[site]);
+            r.free.push_back(data);
+        }
+
+        // Set once the thread's slots are handed back: probes in later thread_local destructors
+        // are ignored instead of taking new slots
+        thread_local bool threadExited = false;
+
+        // Hands the thread's slots back when it exits
+        struct ThreadOwner
+        {
+            detail::ThreadData *data = nullptr;
+            ~ThreadOwner()
+            {
+                threadExited = true;
+                detail::threadData = nullptr;
+                if (data)
+                    releaseThread(data);
+            }
+        };
+
+        thread_local ThreadOwner threadOwner;
+
+        // Bucket b holds [low, high]; see detail::bucketOf
+        void bucketRange(unsigned b, double &low, double &high)
+        {
+            if (b < 4)
+            {
+                low = high = b;
+                return;
+            }
+            const unsigned shift = b / 4 - 1;
+            low = std::ldexp(4 + b % 4, static_cast<int>(shift));
+            high = low + std::ldexp(1, static_cast<int>(shift)) - 1;
+        }
+
+        // The value below which a fraction q of the recorded values lie, to bucket precision
+        double percentile(const std::vector<std::uint64_t> &buckets, std::uint64_t count, double q, double min, double max)
+        {
+            const auto rank = static_cast<std::uint64_t>(std::ceil(q * static_cast<double>(count)));
+            std::uint64_t seen = 0;
+            for (unsigned b = 0; b < buckets.size(); ++b)
+            {
+                seen += buckets[b];
+                if (seen >= rank && buckets[b] != 0)
+                {
+                    double low, high;
+                    bucketRange(b, low, high);
+                    return std::clamp((low + high) / 2, min, max);
+                }
+            }
+            return max;
+        }
+
+        const char *kindName(Kind kind)
+        {
+            switch (kind)
+            {
+            case Kind::Timer:
+                return "timer";
+            case Kind::Counter:
+                return "counter";
+            default:
+                return "histogram";
+            }
+        }
+
+        std::string escapeJson(const std::string &text)
+        {
+            std::string escaped;
+            for (char c : text)
+            {
+                if (c == '"' || c == '\\')
+                    escaped += '\\';
+                escaped += c;
+            }
+            return escaped;
+        }
+
+        bool endsWith(const std::string &text, const char *suffix)
+        {
+            const std::size_t n = std::strlen(suffix);
+            return text.size() >= n && text.compare(text.size() - n, n, suffix) == 0;
+        }
+
+        void reportNow()
+        {
+            const std::string path = registry().exitPath;
+            if (path.empty())
+            {
+                printReport(std::cerr);
+                return;
+            }
+            std::ofstream out(path);
+            if (!out)
+            {
+                std::cerr << "probe: cannot write " << path << std::endl;
+                return;
+            }
+            if (endsWith(path, ".json"))
+                writeJson(out);
+            else
+                printReport(out);
+        }
+    }
+
+    double nsPerTick()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        static const double value = []
+        {
+            using Clock = std::chrono::steady_clock;
+            const auto start = Clock::now();
+            const std::uint64_t startTicks = now();
+            while (Clock::now() - start < std::chrono::milliseconds(10))
+            {
+            }
+            const std::uint64_t ticks = now() - startTicks;
+            const double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+            return ns / static_cast<double>(ticks);
+        }();
+        return value;
+#else
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::duration(1)).count();
+#endif
+    }
+
+    namespace detail
+    {
+        ThreadData *registerThread()
+        {
+            if (threadExited)
+                return nullptr;
+            ThreadData *data;
+            {
+                Registry &r = registry();
+                std::lock_guard<std::mutex> lock(r.mutex);
+                if (!r.free.empty())
+                {
+                    data = r.free.back();
+                    r.free.pop_back();
+                }
+                else
+                {
+                    r.threads.push_back(std::make_unique<ThreadData>());
+                    data = r.threads.back().get();
+                }
+            }
+            threadOwner.data = data;
+            threadData = data;
+            return data;
+        }
+
+        unsigned registerSite(const char *name, Kind kind)
+        {
+            Registry &r = registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            for (unsigned i = 0; i < r.sites.size(); ++i)
+                if (r.sites[i].kind == kind && r.sites[i].name == name)
+                    return i;
+            if (r.sites.size() == maxSites)
+            {
+                ++r.dropped;
+                return noSite;
+            }
+            r.sites.push_back(SiteInfo{name, kind});
+            return static_cast<unsigned>(r.sites.size() - 1);
+        }
+    }
+
+    std::vector<Summary> collect()
+    {
+        const double tickNs = nsPerTick(); // calibrates on first use, so not under the lock
+        Registry &r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+
+        std::vector<Summary> summaries;
+        std::vector<std::uint64_t> buckets(detail::bucketCount);
+        for (unsigned site = 0; site < r.sites.size(); ++site)
+        {
+            Summary s;
+            s.name = r.sites[site].name;
+            s.kind = r.sites[site].kind;
+            std::uint64_t sum = 0, min = std::numeric_limits<std::uint64_t>::max(), max = 0;
+            std::fill(buckets.begin(), buckets.end(), 0);
+            auto add = [&](const detail::Slot &slot)
+            {
+                s.count += slot.count.load(std::memory_order_relaxed);
+                sum += slot.sum.load(std::memory_order_relaxed);
+                min = std::min(min, slot.min.load(std::memory_order_relaxed));
+                max = std::max(max, slot.max.load(std::memory_order_relaxed));
+                for (unsigned b = 0; b < detail::bucketCount; ++b)
+                    buckets[b] += slot.buckets[b].load(std::memory_order_relaxed);
+            };
+            add(r.retired->slots[site]);
+            for (const auto &thread : r.threads) // free slots are cleared, so they add nothing
+                add(thread->slots[site]);
+
+            const double scale = s.kind == Kind::Timer ? tickNs : 1.0;
+            s.sum = static_cast<double>(sum) * scale;
+            if (s.count != 0)
+                s.mean = s.sum / static_cast<double>(s.count);
+            if (s.kind != Kind::Counter && s.count != 0)
+            {
+                s.min = static_cast<double>(min) * scale;
+                s.max = static_cast<double>(max) * scale;
+                const double rawMin = static_cast<double>(min), rawMax = static_cast<double>(max);
+                s.p50 = percentile(buckets, s.count, 0.50, rawMin, rawMax) * scale;
+                s.p90 = percentile(buckets, s.count, 0.90, rawMin, rawMax) * scale;
+                s.p99 = percentile(buckets, s.count, 0.99, rawMin, rawMax) * scale;
+                s.p999 = percentile(buckets, s.count, 0.999, rawMin, rawMax) * scale;
+            }
+            summaries.push_back(std::move(s));
+        }
+        return summaries;
+    }
+
+    std::size_t droppedSites()
+    {
+        Registry &r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        return r.dropped;
+    }
+
+    void printReport(std::ostream &out)
+    {
+        const std::vector<Summary> summaries = collect();
+        out << std::left << std::setw(28) << "probe" << std::setw(10) << "kind" << std::right << std::setw(12)
+            << "count" << std::setw(14) << "sum" << std::setw(12) << "mean" << std::setw(12) << "p50"
+            << std::setw(12) << "p99" << std::setw(12) << "p99.9" << std::setw(12) << "max" << std::endl;
+        for (const Summary &s : summaries)
+        {
+            out << std::left << std::setw(28) << s.name << std::setw(10) << kindName(s.kind) << std::right
+                << std::fixed << std::setprecision(1) << std::setw(12) << s.count << std::setw(14) << s.sum
+                << std::setw(12) << s.mean;
+            if (s.kind == Kind::Counter)
+                out << std::endl;
+            else
+                out << std::setw(12) << s.p50 << std::setw(12) << s.p99 << std::setw(12) << s.p999 << std::setw(12)
+                    << s.max << std::endl;
+        }
+        out.unsetf(std::ios::floatfield);
+        if (std::size_t dropped = droppedSites())
+            out << dropped << " probe(s) dropped: raise PROBE_MAX_SITES (" << detail::maxSites << ")" << std::endl;
+    }
+
+    void writeJson(std::ostream &out)
+    {
+        const std::vector<Summary> summaries = collect();
+        out << std::setprecision(17) << "{\n  \"probes\": [\n";
+        for (std::size_t i = 0; i < summaries.size(); ++i)
+        {
+            const Summary &s = summaries[i];
+            out << "    {\"name\": \"" << escapeJson(s.name) << "\", \"kind\": \"" << kindName(s.kind)
+                << "\", \"count\": " << s.count << ", \"sum\": " << s.sum << ", \"mean\": " << s.mean;
+            if (s.kind != Kind::Counter)
+                out << ", \"min\": " << s.min << ", \"p50\": " << s.p50 << ", \"p90\": " << s.p90 << ", \"p99\": " << s.p99
+                    << ", \"p999\": " << s.p999 << ", \"max\": " << s.max;
+            out << "}" << (i + 1 < summaries.size() ? "," : "") << "\n";
+        }
+        out << "  ],\n  \"dropped\": " << droppedSites() << "\n}\n";
+    }
+
+    void reportAtExit(std::string path)
+    {
+        Registry &r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.exitPath = std::move(path);
+        if (!r.exitRegistered)
+        {
+            r.exitRegistered = true;
+            std::atexit(reportNow);
+        }
+    }
+}
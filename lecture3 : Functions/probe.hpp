@@ -0,0 +1,233 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <iosfwd>
+#include <limits>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+// probe: always-on instrumentation for hot paths
+//
+// microbench (benchmark/microbench.hpp) measures code in isolation. Probes stay in the real
+// program and record what happens in production:
+//
+//     void handleRequest(const Request &r)
+//     {
+//         PROBE_SCOPE("request");                  // time from here to the end of the scope
+//         PROBE_COUNT("request.bytes", r.size());   // running total
+//         PROBE_VALUE("request.fields", r.fields);  // distribution of a value
+//         ...
+//     }
+//
+//     probe::printReport(std::cout);               // any time, from any thread
+//     probe::reportAtExit("probes.json");          // or once the program ends
+//
+// Each thread records into its own cache-line-aligned slots with plain (relaxed atomic)
+// stores, so a probe takes no lock, allocates nothing after the thread's first probe and
+// never shares a cache line with another thread. When a thread exits, its counts are added to
+// a running total and its slots go to the next new thread, so memory stays at one set of
+// slots per thread running at once. Timers read the TSC (steady_clock on other CPUs); ticks
+// are converted to nanoseconds only when a report is made. Values go into log-linear
+// buckets, four per power of two, so reported percentiles are within about 12%.
+//
+// Building with PROBES_ENABLED=0 (CMake: -DENABLE_PROBES=OFF) compiles every probe out,
+// arguments included, like assert. A program may use up to PROBE_MAX_SITES distinct probe
+// names; probes beyond that do nothing and are counted as dropped in the report.
+
+#ifndef PROBES_ENABLED
+#define PROBES_ENABLED 1
+#endif
+
+#ifndef PROBE_MAX_SITES
+#define PROBE_MAX_SITES 64
+#endif
+
+namespace probe
+{
+    enum class Kind : std::uint8_t
+    {
+        Timer,
+        Counter,
+        Histogram
+    };
+
+    // Timestamp in ticks; see nsPerTick()
+    inline std::uint64_t now()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+    }
+
+    // Measured against steady_clock on first use (takes about 10 ms)
+    double nsPerTick();
+
+    // One probe name, aggregated over all threads. Timer values are in nanoseconds; counters
+    // only have count (calls) and sum (total added).
+    struct Summary
+    {
+        std::string name;
+        Kind kind = Kind::Counter;
+        std::uint64_t count = 0;
+        double sum = 0;
+        double min = 0;
+        double max = 0;
+        double mean = 0;
+        double p50 = 0;
+        double p90 = 0;
+        double p99 = 0;
+        double p999 = 0;
+    };
+
+    std::vector<Summary> collect();
+    // Probes that did not fit in PROBE_MAX_SITES
+    std::size_t droppedSites();
+
+    void printReport(std::ostream &out);
+    void writeJson(std::ostream &out);
+    // Writes a report when the program exits: text to stderr for an empty path, JSON for a
+    // path ending in .json, text otherwise
+    void reportAtExit(std::string path = "");
+
+    namespace detail
+    {
+        inline constexpr unsigned maxSites = PROBE_MAX_SITES;
+        inline constexpr unsigned bucketCount = 4 * 63;
+        inline constexpr unsigned noSite = ~0u;
+
+        // Values 0-3 have a bucket each; above that, four buckets per power of two
+        inline unsigned bucketOf(std::uint64_t value)
+        {
+            if (value < 4)
+                return static_cast<unsigned>(value);
+            const unsigned exponent = 63 - static_cast<unsigned>(std::countl_zero(value));
+            return 4 * (exponent - 1) + static_cast<unsigned>((value >> (exponent - 2)) & 3);
+        }
+
+        struct alignas(64) Slot
+        {
+            std::atomic<std::uint64_t> count{0};
+            std::atomic<std::uint64_t> sum{0};
+            std::atomic<std::uint64_t> min{std::numeric_limits<std::uint64_t>::max()};
+            std::atomic<std::uint64_t> max{0};
+            std::atomic<std::uint64_t> buckets[bucketCount]{};
+        };
+
+        struct ThreadData
+        {
+            Slot slots[maxSites];
+        };
+
+        // Only the owning thread writes, so load + store is enough (no locked instruction);
+        // the atomics make it safe for a reporter to read at the same time
+        inline void bump(std::atomic<std::uint64_t> &value, std::uint64_t amount)
+        {
+            value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+        }
+
+        inline void record(Slot &slot, std::uint64_t value)
+        {
+            bump(slot.count, 1);
+            bump(slot.sum, value);
+            if (value < slot.min.load(std::memory_order_relaxed))
+                slot.min.store(value, std::memory_order_relaxed);
+            if (value > slot.max.load(std::memory_order_relaxed))
+                slot.max.store(value, std::memory_order_relaxed);
+            bump(slot.buckets[bucketOf(value)], 1);
+        }
+
+        inline void add(Slot &slot, std::uint64_t amount)
+        {
+            bump(slot.count, 1);
+            bump(slot.sum, amount);
+        }
+
+        // Takes slots for this thread, reusing those of a thread that exited; nullptr once the
+        // thread is exiting
+        ThreadData *registerThread();
+        inline thread_local ThreadData *threadData = nullptr;
+
+        inline Slot *slot(unsigned site)
+        {
+            if (site == noSite)
+                return nullptr;
+            ThreadData *data = threadData;
+            if (!data && !(data = registerThread()))
+                return nullptr;
+            return &data->slots[site];
+        }
+
+        // The index of a probe name; the same name always gets the same index
+        unsigned registerSite(const char *name, Kind kind);
+
+        struct Site
+        {
+            unsigned id;
+            Site(const char *name, Kind kind) : id(registerSite(name, kind)) {}
+        };
+
+        class ScopedTimer
+        {
+        public:
+            explicit ScopedTimer(unsigned site) : slot_(slot(site)), start_(now()) {}
+            ~ScopedTimer()
+            {
+                if (slot_)
+                    record(*slot_, now() - start_);
+            }
+
+            ScopedTimer(const ScopedTimer &) = delete;
+            ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+        private:
+            Slot *slot_;
+            std::uint64_t start_;
+        };
+    }
+}
+
+#define PROBE_CONCAT_(a, b) a##b
+#define PROBE_CONCAT(a, b) PROBE_CONCAT_(a, b)
+
+#if PROBES_ENABLED
+
+// Times the rest of the enclosing scope
+#define PROBE_SCOPE(name)                                                                                           \
+    static const ::probe::detail::Site PROBE_CONCAT(probeSite, __LINE__)(name, ::probe::Kind::Timer);              \
+    const ::probe::detail::ScopedTimer PROBE_CONCAT(probeTimer, __LINE__)(PROBE_CONCAT(probeSite, __LINE__).id)
+
+// Adds `amount` to a running total
+#define PROBE_COUNT(name, amount)                                                                                   \
+    do                                                                                                              \
+    {                                                                                                               \
+        static const ::probe::detail::Site probeSite(name, ::probe::Kind::Counter);                                 \
+        if (::probe::detail::Slot *probeSlot = ::probe::detail::slot(probeSite.id))                                 \
+            ::probe::detail::add(*probeSlot, static_cast<std::uint64_t>(amount));                                   \
+    } while (0)
+
+// Records one value (an unsigned integer) of a distribution
+#define PROBE_VALUE(name, value)                                                                                    \
+    do                                                                                                              \
+    {                                                                                                               \
+        static const ::probe::detail::Site probeSite(name, ::probe::Kind::Histogram);                               \
+        if (::probe::detail::Slot *probeSlot = ::probe::detail::slot(probeSite.id))                                 \
+            ::probe::detail::record(*probeSlot, static_cast<std::uint64_t>(value));                                 \
+    } while (0)
+
+#else
+
+#define PROBE_SCOPE(name) static_cast<void>(0)
+#define PROBE_COUNT(name, amount) static_cast<void>(0)
+#define PROBE_VALUE(name, value) static_cast<void>(0)
+
+#endif
@@ -0,0 +1,251 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <utility>
+
+// Reference-counted pointers for data that stays on one thread
+//
+// std::shared_ptr (see smartPointerExamples in auto_examples.cpp) updates its count with
+// atomic instructions, because any thread may copy it, and std::shared_ptr<T>(new T) keeps
+// the count in a separate control block. When objects never leave one thread, both costs
+// can go:
+//   - intrusive_ptr<T>: T derives from ref_counted, so the count is a member of the object
+//   - local_shared_ptr<T>: like shared_ptr, but from make_local_shared, with a plain
+//     (non-atomic) count next to the object in one allocation
+//
+//     struct Node : ref_counted { int value; };
+//     intrusive_ptr<Node> a = make_intrusive<Node>();
+//     auto b = a;                                        // ++count, no atomic, no allocation
+//
+//     auto text = make_local_shared<std::string>("hi");
+//     auto copy = text;                                  // text.use_count() == 2
+//
+// Neither is thread-safe. With REF_COUNTED_THREAD_CHECKS (on unless NDEBUG is defined), every
+// count change checks that it happens on the thread that created the object, and aborts
+// with a message otherwise. The owning thread is recorded either way, so the layout of the
+// objects does not depend on the setting and translation units built with and without
+// NDEBUG can share them. Neither has weak pointers or conversions between types.
+
+#ifndef REF_COUNTED_THREAD_CHECKS
+#ifdef NDEBUG
+#define REF_COUNTED_THREAD_CHECKS 0
+#else
+#define REF_COUNTED_THREAD_CHECKS 1
+#endif
+#endif
+
+// When two pointers to one object are destroyed in a row, GCC 12 cannot tell that the first
+// release() did not delete it and warns about the second one
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 12
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuse-after-free"
+#define REF_COUNTED_POP_DIAGNOSTICS
+#endif
+
+namespace ref_counting_detail
+{
+    // The thread an object belongs to; check() does nothing when the checks are off
+    struct ThreadOwner
+    {
+        std::thread::id id = std::this_thread::get_id();
+
+        void check([[maybe_unused]] const char *what) const
+        {
+#if REF_COUNTED_THREAD_CHECKS
+            if (id != std::this_thread::get_id())
+            {
+                std::fprintf(stderr, "%s: reference count changed on a second thread\n", what);
+                std::abort();
+            }
+#endif
+        }
+    };
+}
+
+// Base class holding the count for intrusive_ptr
+class ref_counted
+{
+public:
+    std::size_t use_count() const { return refs_; }
+
+protected:
+    ref_counted() = default;
+    // A copy is a new object with no references yet
+    ref_counted(const ref_counted &) {}
+    ref_counted &operator=(const ref_counted &) { return *this; }
+    ~ref_counted() = default;
+
+private:
+    template <typename T>
+    friend class intrusive_ptr;
+
+    mutable std::size_t refs_ = 0;
+    ref_counting_detail::ThreadOwner owner_;
+};
+
+template <typename T>
+class intrusive_ptr
+{
+public:
+    intrusive_ptr() = default;
+    intrusive_ptr(std::nullptr_t) {}
+
+    // Takes a reference to an object created with new (make_intrusive does that)
+    explicit intrusive_ptr(T *object) : object_(object) { acquire(); }
+
+    intrusive_ptr(const intrusive_ptr &other) : object_(other.object_) { acquire(); }
+    intrusive_ptr(intrusive_ptr &&other) noexcept : object_(std::exchange(other.object_, nullptr)) {}
+
+    intrusive_ptr &operator=(const intrusive_ptr &other)
+    {
+        other.acquire(); // before release, in case both point to the same object
+        release();
+        object_ = other.object_;
+        return *this;
+    }
+
+    intrusive_ptr &operator=(intrusive_ptr &&other) noexcept
+    {
+        if (this != &other)
+        {
+            release();
+            object_ = std::exchange(other.object_, nullptr);
+        }
+        return *this;
+    }
+
+    ~intrusive_ptr() { release(); }
+
+    void reset() { intrusive_ptr().swap(*this); }
+    void swap(intrusive_ptr &other) noexcept { std::swap(object_, other.object_); }
+
+    T *get() const { return object_; }
+    T &operator*() const { return *object_; }
+    T *operator->() const { return object_; }
+    explicit operator bool() const { return object_ != nullptr; }
+    std::size_t use_count() const { return object_ ? object_->use_count() : 0; }
+
+    friend bool operator==(const intrusive_ptr &a, const intrusive_ptr &b) { return a.object_ == b.object_; }
+    friend bool operator==(const intrusive_ptr &a, std::nullptr_t) { return a.object_ == nullptr; }
+
+private:
+    void acquire() const
+    {
+        if (!object_)
+            return;
+        const ref_counted &base = *object_;
+        base.owner_.check("intrusive_ptr");
+        ++base.refs_;
+    }
+
+    void release()
+    {
+        if (!object_)
+            return;
+        const ref_counted &base = *object_;
+        base.owner_.check("intrusive_ptr");
+        if (--base.refs_ == 0)
+            delete object_;
+    }
+
+    T *object_ = nullptr;
+};
+
+template <typename T, typename... Args>
+intrusive_ptr<T> make_intrusive(Args &&...args)
+{
+    return intrusive_ptr<T>(new T(std::forward<Args>(args)...));
+}
+
+template <typename T>
+class local_shared_ptr
+{
+    struct Block
+    {
+        std::size_t refs = 1;
+        ref_counting_detail::ThreadOwner owner;
+        T value;
+
+        template <typename... Args>
+        explicit Block(Args &&...args) : value(std::forward<Args>(args)...) {}
+    };
+
+public:
+    local_shared_ptr() = default;
+    local_shared_ptr(std::nullptr_t) {}
+
+    local_shared_ptr(const local_shared_ptr &other) : block_(other.block_) { acquire(); }
+    local_shared_ptr(local_shared_ptr &&other) noexcept : block_(std::exchange(other.block_, nullptr)) {}
+
+    local_shared_ptr &operator=(const local_shared_ptr &other)
+    {
+        other.acquire(); // before release, in case both share the object
+        release();
+        block_ = other.block_;
+        return *this;
+    }
+
+    local_shared_ptr &operator=(local_shared_ptr &&other) noexcept
+    {
+        if (this != &other)
+        {
+            release();
+            block_ = std::exchange(other.block_, nullptr);
+        }
+        return *this;
+    }
+
+    ~local_shared_ptr() { release(); }
+
+    void reset() { local_shared_ptr().swap(*this); }
+    void swap(local_shared_ptr &other) noexcept { std::swap(block_, other.block_); }
+
+    T *get() const { return block_ ? &block_->value : nullptr; }
+    T &operator*() const { return block_->value; }
+    T *operator->() const { return &block_->value; }
+    explicit operator bool() const { return block_ != nullptr; }
+    std::size_t use_count() const { return block_ ? block_->refs : 0; }
+
+    friend bool operator==(const local_shared_ptr &a, const local_shared_ptr &b) { return a.block_ == b.block_; }
+    friend bool operator==(const local_shared_ptr &a, std::nullptr_t) { return a.block_ == nullptr; }
+
+private:
+    template <typename U, typename... Args>
+    friend local_shared_ptr<U> make_local_shared(Args &&...args);
+
+    explicit local_shared_ptr(Block *block) : block_(block) {}
+
+    void acquire() const
+    {
+        if (!block_)
+            return;
+        block_->owner.check("local_shared_ptr");
+        ++block_->refs;
+    }
+
+    void release()
+    {
+        if (!block_)
+            return;
+        block_->owner.check("local_shared_ptr");
+        if (--block_->refs == 0)
+            delete block_;
+    }
+
+    Block *block_ = nullptr;
+};
+
+// One allocation holding the count and the object
+template <typename T, typename... Args>
+local_shared_ptr<T> make_local_shared(Args &&...args)
+{
+    return local_shared_ptr<T>(new typename local_shared_ptr<T>::Block(std::forward<Args>(args)...));
+}
+
+#ifdef REF_COUNTED_POP_DIAGNOSTICS
+#pragma GCC diagnostic pop
+#undef REF_COUNTED_POP_DIAGNOSTICS
+#endif
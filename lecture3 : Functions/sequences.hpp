@@ -0,0 +1,202 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+// Factorial and Fibonacci without recursion at run time
+//
+// constexpr_factorial (inline_examples.hpp) is fine for a constant like 5!, but 13! no longer
+// fits an int, and PoorInlineCandidates::fibonacci makes an exponential number of calls.
+// Both sequences grow so quickly that only a few dozen values fit any integer type, so the
+// whole range is a lookup table built by the compiler:
+//
+//     Sequences::factorial(20)              // 2432902008176640000, one load
+//     Sequences::fibonacci(93)              // largest Fibonacci number in 64 bits
+//     Sequences::fibonacci128(186)          // fast doubling, O(log n), up to F(186)
+//     Sequences::fibonacciMod(1e18, 1e9+7)  // any n, modulo m
+//
+// Values that do not fit the return type throw std::overflow_error instead of wrapping.
+
+namespace Sequences
+{
+    __extension__ typedef unsigned __int128 uint128;
+
+    // Number of n with n! representable in T, i.e. the table covers 0! .. (size - 1)!
+    template <typename T>
+    constexpr std::size_t factorialTableSize()
+    {
+        T value = 1;
+        std::size_t n = 1;
+        while (value <= std::numeric_limits<T>::max() / static_cast<T>(n))
+            value *= static_cast<T>(n++);
+        return n;
+    }
+
+    // Number of n with F(n) representable in T
+    template <typename T>
+    constexpr std::size_t fibonacciTableSize()
+    {
+        T previous = 0, current = 1;
+        std::size_t n = 2;
+        while (current <= std::numeric_limits<T>::max() - previous)
+        {
+            T next = previous + current;
+            previous = current;
+            current = next;
+            ++n;
+        }
+        return n;
+    }
+
+    namespace detail
+    {
+        template <typename T>
+        constexpr T factorialAt(std::size_t n)
+        {
+            T value = 1;
+            for (std::size_t i = 2; i <= n; ++i)
+                value *= static_cast<T>(i);
+            return value;
+        }
+
+        template <typename T>
+        constexpr T fibonacciAt(std::size_t n)
+        {
+            T previous = 0, current = 1;
+            if (n == 0)
+                return 0;
+            for (std::size_t i = 1; i < n; ++i)
+            {
+                T next = previous + current;
+                previous = current;
+                current = next;
+            }
+            return current;
+        }
+
+        template <typename T, std::size_t... N>
+        constexpr std::array<T, sizeof...(N)> factorials(std::index_sequence<N...>) { return {{factorialAt<T>(N)...}}; }
+
+        template <typename T, std::size_t... N>
+        constexpr std::array<T, sizeof...(N)> fibonaccis(std::index_sequence<N...>) { return {{fibonacciAt<T>(N)...}}; }
+    }
+
+    // The tables themselves, one per integer type, as constant data in the binary
+    template <typename T>
+    inline constexpr auto factorialTable = detail::factorials<T>(std::make_index_sequence<factorialTableSize<T>()>{});
+
+    template <typename T>
+    inline constexpr auto fibonacciTable = detail::fibonaccis<T>(std::make_index_sequence<fibonacciTableSize<T>()>{});
+
+    // Being constexpr variables, the tables exist before the program runs; these would not compile otherwise
+    static_assert(factorialTable<int>.size() == 13 && factorialTable<int>[12] == 479001600);
+    static_assert(factorialTable<std::uint64_t>.size() == 21 && factorialTable<std::uint64_t>[20] == 2432902008176640000ULL);
+    static_assert(factorialTable<uint128>.size() == 35);
+    static_assert(fibonacciTable<long long>.size() == 93 && fibonacciTable<long long>[92] == 7540113804746346429LL);
+    static_assert(fibonacciTable<std::uint64_t>.size() == 94 && fibonacciTable<std::uint64_t>[93] == 12200160415121876738ULL);
+
+    // n! for 0 <= n <= 20; std::overflow_error past that (std::invalid_argument for n < 0)
+    template <typename T = std::uint64_t>
+    constexpr T factorial(int n)
+    {
+        if (n < 0)
+            throw std::invalid_argument("factorial: negative n " + std::to_string(n));
+        if (static_cast<std::size_t>(n) >= factorialTable<T>.size())
+            throw std::overflow_error("factorial: " + std::to_string(n) + "! does not fit; the largest is " +
+                                      std::to_string(factorialTable<T>.size() - 1) + "!");
+        return factorialTable<T>[n];
+    }
+
+    // F(n) for 0 <= n <= 93 from the table; std::overflow_error past that (std::invalid_argument for n < 0)
+    template <typename T = std::uint64_t>
+    constexpr T fibonacci(int n)
+    {
+        if (n < 0)
+            throw std::invalid_argument("fibonacci: negative n " + std::to_string(n));
+        if (static_cast<std::size_t>(n) >= fibonacciTable<T>.size())
+            throw std::overflow_error("fibonacci: F(" + std::to_string(n) + ") does not fit; the largest is F(" +
+                                      std::to_string(fibonacciTable<T>.size() - 1) + ")");
+        return fibonacciTable<T>[n];
+    }
+
+    // Fast doubling from F(k), F(k + 1) to F(2k) = F(k) (2 F(k + 1) - F(k)) and
+    // F(2k + 1) = F(k)^2 + F(k + 1)^2, one step per bit of n. With 128-bit arithmetic it
+    // reaches F(186); the table answers the first 94 values, so this covers the rest.
+    constexpr uint128 fibonacci128(int n)
+    {
+        if (n < 0)
+            throw std::invalid_argument("fibonacci128: negative n " + std::to_string(n));
+        if (static_cast<std::size_t>(n) < fibonacciTable<std::uint64_t>.size())
+            return fibonacciTable<std::uint64_t>[n];
+        if (static_cast<std::size_t>(n) >= fibonacciTableSize<uint128>())
+            throw std::overflow_error("fibonacci128: F(" + std::to_string(n) + ") does not fit; the largest is F(" +
+                                      std::to_string(fibonacciTableSize<uint128>() - 1) + ")");
+
+        // Unsigned arithmetic wraps modulo 2^128, so F(2k + 1) may wrap on the last step, but
+        // F(n) itself fits and comes out exact
+        uint128 a = 0, b = 1; // F(k), F(k + 1), starting at k = 0
+        for (int bit = 31 - __builtin_clz(static_cast<unsigned>(n)); bit >= 0; --bit)
+        {
+            uint128 c = a * (2 * b - a); // F(2k)
+            uint128 d = a * a + b * b;   // F(2k + 1)
+            if ((n >> bit) & 1)
+            {
+                a = d;
+                b = c + d;
+            }
+            else
+            {
+                a = c;
+                b = d;
+            }
+        }
+        return a;
+    }
+
+    // F(n) mod m for any n, by fast doubling; 128-bit products keep it exact for any 64-bit m
+    constexpr std::uint64_t fibonacciMod(std::uint64_t n, std::uint64_t m)
+    {
+        if (m == 0)
+            throw std::invalid_argument("fibonacciMod: modulus is 0");
+        if (n == 0)
+            return 0;
+        uint128 a = 0, b = 1 % m;
+        for (int bit = 63 - __builtin_clzll(n); bit >= 0; --bit)
+        {
+            uint128 twoBMinusA = (2 * b + m - a) % m;
+            uint128 c = a * twoBMinusA % m;
+            uint128 d = (a * a % m + b * b % m) % m;
+            if ((n >> bit) & 1)
+            {
+                a = d;
+                b = (c + d) % m;
+            }
+            else
+            {
+                a = c;
+                b = d;
+            }
+        }
+        return static_cast<std::uint64_t>(a);
+    }
+
+    // Decimal digits of a 128-bit value, since the standard library cannot print one
+    inline std::string toString(uint128 value)
+    {
+        std::string digits;
+        do
+        {
+            digits.insert(digits.begin(), static_cast<char>('0' + static_cast<int>(value % 10)));
+            value /= 10;
+        } while (value != 0);
+        return digits;
+    }
+
+    static_assert(fibonacci128(186) == fibonacciTable<uint128>[186]);
+    static_assert(fibonacciMod(93, 1000000007) == fibonacciTable<std::uint64_t>[93] % 1000000007);
+}
@@ -0,0 +1,287 @@
+#include "spatial_grid.hpp"
+#include "parallel_chunks.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+    struct KeyedPoint
+    {
+        std::uint64_t key;
+        std::uint32_t index;
+    };
+
+    constexpr unsigned radixBits = 11;
+    constexpr std::size_t radixBuckets = std::size_t{1} << radixBits;
+    constexpr std::uint64_t emptySlot = std::numeric_limits<std::uint64_t>::max(); // never a valid key
+
+    // Stable LSD radix sort on the low `keyBits` bits, 11 bits per pass. Every pass counts
+    // digits per thread chunk, turns the counts into per-chunk write positions, then scatters.
+    void radixSort(std::vector<KeyedPoint> &items, unsigned keyBits, unsigned threads)
+    {
+        std::vector<KeyedPoint> buffer(items.size());
+        const std::size_t count = items.size();
+        threads = static_cast<unsigned>(std::min<std::size_t>(resolveThreads(threads), std::max<std::size_t>(1, count / 4096)));
+        const std::size_t chunk = (count + threads - 1) / std::max(1u, threads);
+        std::vector<std::size_t> positions(static_cast<std::size_t>(threads) * radixBuckets);
+
+        for (unsigned shift = 0; shift < keyBits; shift += radixBits)
+        {
+            auto digit = [shift](const KeyedPoint &item)
+            { return static_cast<std::size_t>((item.key >> shift) & (radixBuckets - 1)); };
+
+            std::fill(positions.begin(), positions.end(), 0);
+            parallelChunks(threads, threads, [&](std::size_t first, std::size_t last)
+                           {
+                for (std::size_t t = first; t < last; ++t)
+                {
+                    std::size_t *counts = positions.data() + t * radixBuckets;
+                    for (std::size_t i = t * chunk; i < std::min(count, (t + 1) * chunk); ++i)
+                        ++counts[digit(items[i])];
+                } });
+
+            // Digit-major, then chunk order: keeps the sort stable
+            std::size_t running = 0;
+            for (std::size_t d = 0; d < radixBuckets; ++d)
+                for (unsigned t = 0; t < threads; ++t)
+                {
+                    std::size_t n = positions[t * radixBuckets + d];
+                    positions[t * radixBuckets + d] = running;
+                    running += n;
+                }
+
+            parallelChunks(threads, threads, [&](std::size_t first, std::size_t last)
+                           {
+                for (std::size_t t = first; t < last; ++t)
+                {
+                    std::size_t *next = positions.data() + t * radixBuckets;
+                    for (std::size_t i = t * chunk; i < std::min(count, (t + 1) * chunk); ++i)
+                        buffer[next[digit(items[i])]++] = items[i];
+                } });
+            items.swap(buffer);
+        }
+    }
+
+    inline std::size_t slotFor(std::uint64_t key, unsigned shift)
+    {
+        return static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ull) >> shift);
+    }
+}
+
+SpatialGrid::SpatialGrid(const PointCloud &cloud, double cellSize, unsigned threads)
+    : cloud_(cloud), cellSize_(cellSize), bitsPerAxis_(cloud.dimensions() == 2 ? 31 : 21)
+{
+    if (!(cellSize > 0) || !std::isfinite(cellSize))
+        throw std::invalid_argument("SpatialGrid: cell size must be positive and finite");
+    if (cloud.size() >= std::numeric_limits<std::uint32_t>::max())
+        throw std::length_error("SpatialGrid: " + std::to_string(cloud.size()) + " points do not fit 32-bit indices");
+
+    offsets_.push_back(0);
+    if (cloud.empty())
+        return;
+
+    const std::size_t dims = cloud.dimensions();
+    PointCloud::BoundingBox box = cloud.boundingBox();
+    for (std::size_t d = 0; d < dims; ++d)
+    {
+        originCell_[d] = cellCoordinate(box.min[d], d);
+        extent_[d] = cellCoordinate(box.max[d], d) + 1;
+        if (extent_[d] > (std::int64_t{1} << bitsPerAxis_))
+            throw std::out_of_range("SpatialGrid: " + std::to_string(extent_[d]) + " cells along axis " +
+                                    std::to_string(d) + " exceed " + std::to_string(bitsPerAxis_) + " bits");
+    }
+
+    std::vector<KeyedPoint> items(cloud.size());
+    parallelChunks(cloud.size(), threads, [&](std::size_t begin, std::size_t end)
+                   {
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            auto c = cloud.coordinates(i);
+            std::int64_t cell[3] = {cellCoordinate(c[0], 0), cellCoordinate(c[1], 1), dims == 3 ? cellCoordinate(c[2], 2) : 0};
+            items[i] = {packKey(cell), static_cast<std::uint32_t>(i)};
+        } });
+
+    // Only as many passes as the largest key has bits
+    std::int64_t last[3] = {extent_[0] - 1, extent_[1] - 1, dims == 3 ? extent_[2] - 1 : 0};
+    radixSort(items, static_cast<unsigned>(std::bit_width(packKey(last))), threads);
+
+    points_.resize(items.size());
+    for (std::size_t i = 0; i < items.size(); ++i)
+    {
+        points_[i] = items[i].index;
+        if (i == 0 || items[i].key != items[i - 1].key)
+        {
+            if (i != 0)
+                offsets_.push_back(static_cast<std::uint32_t>(i));
+            keys_.push_back(items[i].key);
+        }
+    }
+    offsets_.push_back(static_cast<std::uint32_t>(items.size()));
+
+    // Open addressing with linear probing, at most half full
+    std::size_t capacity = std::bit_ceil(std::max<std::size_t>(16, 2 * keys_.size()));
+    tableShift_ = 64 - static_cast<unsigned>(std::countr_zero(capacity));
+    tableKeys_.assign(capacity, emptySlot);
+    tableCells_.assign(capacity, noCell);
+    for (std::size_t cell = 0; cell < keys_.size(); ++cell)
+    {
+        std::size_t slot = slotFor(keys_[cell], tableShift_);
+        while (tableKeys_[slot] != emptySlot)
+            slot = (slot + 1) & (capacity - 1);
+        tableKeys_[slot] = keys_[cell];
+        tableCells_[slot] = static_cast<std::uint32_t>(cell);
+    }
+}
+
+std::int64_t SpatialGrid::cellCoordinate(double value, std::size_t axis) const
+{
+    // Clamped so that far-away query positions cannot overflow the conversion
+    return static_cast<std::int64_t>(std::clamp(std::floor(value / cellSize_), -0x1p61, 0x1p61)) - originCell_[axis];
+}
+
+std::uint64_t SpatialGrid::packKey(const std::int64_t (&cell)[3]) const
+{
+    return static_cast<std::uint64_t>(cell[0]) | static_cast<std::uint64_t>(cell[1]) << bitsPerAxis_ |
+           static_cast<std::uint64_t>(cell[2]) << (2 * bitsPerAxis_);
+}
+
+std::uint32_t SpatialGrid::findCell(std::uint64_t key) const
+{
+    if (tableKeys_.empty())
+        return noCell;
+    const std::size_t mask = tableKeys_.size() - 1;
+    for (std::size_t slot = slotFor(key, tableShift_);; slot = (slot + 1) & mask)
+    {
+        if (tableKeys_[slot] == key)
+            return tableCells_[slot];
+        if (tableKeys_[slot] == emptySlot)
+            return noCell;
+    }
+}
+
+std::size_t SpatialGrid::memoryBytes() const
+{
+    return keys_.capacity() * sizeof(std::uint64_t) + offsets_.capacity() * sizeof(std::uint32_t) +
+           points_.capacity() * sizeof(std::uint32_t) + tableKeys_.capacity() * sizeof(std::uint64_t) +
+           tableCells_.capacity() * sizeof(std::uint32_t);
+}
+
+std::uint32_t SpatialGrid::cellAt(const Coordinates &position) const
+{
+    std::int64_t cell[3] = {0, 0, 0};
+    for (std::size_t d = 0; d < dimensions(); ++d)
+    {
+        cell[d] = cellCoordinate(position[d], d);
+        if (cell[d] < 0 || cell[d] >= extent_[d])
+            return noCell;
+    }
+    return findCell(packKey(cell));
+}
+
+std::span<const std::uint32_t> SpatialGrid::pointsIn(std::uint32_t cell) const
+{
+    if (cell >= keys_.size())
+        throw std::out_of_range("SpatialGrid::pointsIn: no cell " + std::to_string(cell));
+    return std::span<const std::uint32_t>(points_).subspan(offsets_[cell], offsets_[cell + 1] - offsets_[cell]);
+}
+
+// Calls visit(cell) for every occupied cell in the inclusive box [low, high], clipped to the grid
+template <typename Visit>
+void SpatialGrid::forEachCell(const std::int64_t (&low)[3], const std::int64_t (&high)[3], Visit &&visit) const
+{
+    std::int64_t from[3] = {0, 0, 0}, to[3] = {0, 0, 0};
+    for (std::size_t d = 0; d < dimensions(); ++d)
+    {
+        from[d] = std::max<std::int64_t>(low[d], 0);
+        to[d] = std::min<std::int64_t>(high[d], extent_[d] - 1);
+        if (from[d] > to[d])
+            return;
+    }
+    std::int64_t cell[3];
+    for (cell[2] = from[2]; cell[2] <= to[2]; ++cell[2])
+        for (cell[1] = from[1]; cell[1] <= to[1]; ++cell[1])
+            for (cell[0] = from[0]; cell[0] <= to[0]; ++cell[0])
+                if (std::uint32_t found = findCell(packKey(cell)); found != noCell)
+                    visit(found);
+}
+
+std::vector<std::uint32_t> SpatialGrid::neighborhood(const Coordinates &position) const
+{
+    std::int64_t low[3] = {0, 0, 0}, high[3] = {0, 0, 0};
+    for (std::size_t d = 0; d < dimensions(); ++d)
+    {
+        std::int64_t center = cellCoordinate(position[d], d);
+        low[d] = center - 1;
+        high[d] = center + 1;
+    }
+    std::vector<std::uint32_t> found;
+    forEachCell(low, high, [&](std::uint32_t cell)
+                {
+        auto points = pointsIn(cell);
+        found.insert(found.end(), points.begin(), points.end()); });
+    return found;
+}
+
+std::vector<std::uint32_t> SpatialGrid::withinRadius(const Coordinates &position, double radius) const
+{
+    std::vector<std::uint32_t> found;
+    if (!(radius >= 0))
+        return found;
+    std::int64_t low[3] = {0, 0, 0}, high[3] = {0, 0, 0};
+    for (std::size_t d = 0; d < dimensions(); ++d)
+    {
+        low[d] = cellCoordinate(position[d] - radius, d);
+        high[d] = cellCoordinate(position[d] + radius, d);
+    }
+
+    const double bound = radius * radius;
+    auto xs = cloud_.xs(), ys = cloud_.ys(), zs = cloud_.zs();
+    forEachCell(low, high, [&](std::uint32_t cell)
+                {
+        for (std::uint32_t i : pointsIn(cell))
+        {
+            double dx = xs[i] - position[0], dy = ys[i] - position[1];
+            double d2 = dx * dx + dy * dy;
+            if (!zs.empty())
+            {
+                double dz = zs[i] - position[2];
+                d2 += dz * dz;
+            }
+            if (d2 <= bound)
+                found.push_back(i);
+        } });
+    return found;
+}
+
+PointCloud SpatialGrid::downsample(unsigned threads) const
+{
+    std::vector<Coordinates> means(cellCount());
+    auto xs = cloud_.xs(), ys = cloud_.ys(), zs = cloud_.zs();
+    parallelChunks(cellCount(), threads, [&](std::size_t begin, std::size_t end)
+                   {
+        for (std::size_t cell = begin; cell < end; ++cell)
+        {
+            Coordinates sum{};
+            for (std::uint32_t i = offsets_[cell]; i < offsets_[cell + 1]; ++i)
+            {
+                std::uint32_t point = points_[i];
+                sum[0] += xs[point];
+                sum[1] += ys[point];
+                if (!zs.empty())
+                    sum[2] += zs[point];
+            }
+            double n = offsets_[cell + 1] - offsets_[cell];
+            means[cell] = {sum[0] / n, sum[1] / n, sum[2] / n};
+        } });
+
+    PointCloud thinned(dimensions());
+    thinned.reserve(means.size());
+    for (const Coordinates &mean : means)
+        thinned.push_back(mean[0], mean[1], mean[2]);
+    return thinned;
+}
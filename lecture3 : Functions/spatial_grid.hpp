@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "point_cloud.hpp"
+
+// Uniform-grid spatial hash over a PointCloud (2D or 3D), plus voxel-grid downsampling
+//
+// Space is cut into cubes (squares in 2D) of side cellSize, aligned to multiples of cellSize
+// so that a point lands in the same cell from one frame to the next. Only cells that contain
+// a point are stored, so memory grows with the number of points and occupied cells, not with
+// the size of the bounding box:
+//   - every point gets a 64-bit cell key (its integer cell coordinates, packed)
+//   - (key, point) pairs are radix-sorted by key, in parallel, so each cell's points end up
+//     contiguous; the cells are then one sorted array with offsets into the point list
+//   - an open-addressing hash table maps a key to its cell
+//
+//     SpatialGrid grid(cloud, 0.5);
+//     auto nearby = grid.withinRadius({x, y, 0.0}, 0.5);   // indices into cloud
+//     PointCloud thinned = grid.downsample();              // one averaged point per cell
+//
+// The grid refers to the cloud it was built from, which must outlive it and stay unchanged.
+// Cell coordinates are relative to the cloud's bounding box and must fit 31 bits per axis in
+// 2D and 21 bits in 3D (std::out_of_range otherwise).
+
+class SpatialGrid
+{
+public:
+    using Coordinates = PointCloud::Coordinates;
+
+    static constexpr std::uint32_t noCell = UINT32_MAX;
+
+    // threads == 0: std::thread::hardware_concurrency()
+    SpatialGrid(const PointCloud &cloud, double cellSize, unsigned threads = 0);
+
+    double cellSize() const { return cellSize_; }
+    std::size_t dimensions() const { return cloud_.dimensions(); }
+    std::size_t cellCount() const { return keys_.size(); }
+    std::size_t memoryBytes() const;
+
+    // The cell containing `position`, or noCell if that cell is empty
+    std::uint32_t cellAt(const Coordinates &position) const;
+
+    // Indices (into the cloud) of the points in one cell
+    std::span<const std::uint32_t> pointsIn(std::uint32_t cell) const;
+
+    // Points in the cell of `position` and the cells around it (3 x 3, or 3 x 3 x 3 in 3D)
+    std::vector<std::uint32_t> neighborhood(const Coordinates &position) const;
+
+    // Points within `radius` of `position` (inclusive), in no particular order
+    std::vector<std::uint32_t> withinRadius(const Coordinates &position, double radius) const;
+
+    // One point per occupied cell: the mean of the points in it, in cell-key order
+    PointCloud downsample(unsigned threads = 0) const;
+
+    static PointCloud voxelDownsample(const PointCloud &cloud, double cellSize, unsigned threads = 0)
+    {
+        return SpatialGrid(cloud, cellSize, threads).downsample(threads);
+    }
+
+private:
+    std::int64_t cellCoordinate(double value, std::size_t axis) const;
+    std::uint64_t packKey(const std::int64_t (&cell)[3]) const;
+    std::uint32_t findCell(std::uint64_t key) const;
+    template <typename Visit>
+    void forEachCell(const std::int64_t (&low)[3], const std::int64_t (&high)[3], Visit &&visit) const;
+
+    const PointCloud &cloud_;
+    double cellSize_;
+    std::int64_t originCell_[3] = {0, 0, 0}; // cell of the bounding box's low corner
+    std::int64_t extent_[3] = {1, 1, 1};   // number of cells along each axis
+    unsigned bitsPerAxis_;
+
+    std::vector<std::uint64_t> keys_;      // sorted key of each occupied cell
+    std::vector<std::uint32_t> offsets_;   // cell c holds points_[offsets_[c], offsets_[c + 1])
+    std::vector<std::uint32_t> points_;    // point indices grouped by cell
+    std::vector<std::uint64_t> tableKeys_; // open-addressing table: key -> cell
+    std::vector<std::uint32_t> tableCells_;
+    unsigned tableShift_ = 64;
+};
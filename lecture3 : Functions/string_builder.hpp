@@ -0,0 +1,247 @@
+#pragma once
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// Concatenation without temporaries
+//
+// templateFunction(std::string("Hello "), std::string("World")) in auto_examples.cpp returns
+// a + b. For strings every + allocates a new string and copies everything so far, so a key
+// built from ten pieces allocates ten times and copies the first piece ten times.
+// StringBuilder::cat() instead returns an expression that only records the pieces (text as
+// string_views, numbers by value); converting it to a std::string computes the exact length,
+// allocates once and writes every piece once:
+//
+//     std::string key = cat("user:", id, ":session:", session, '/', path);
+//     auto line = cat("took ") + ms + " ms";            // + on an expression adds pieces
+//     std::string s = line;                             // the one allocation happens here
+//     std::cout << line;                                // or written out directly
+//     line.appendTo(buffer);                            // or appended to an existing string
+//
+// The expression refers to the text it was given, like a string_view: turn it into a string
+// before those strings go away. A temporary std::string is therefore refused at compile time
+// (cat(std::to_string(n)) would dangle); pass the number itself.
+//
+// Integers are written as std::to_string does. Floating-point numbers use the shortest form
+// that reads back the same (std::to_chars), e.g. 0.1 rather than to_string's 0.100000.
+
+namespace StringBuilder
+{
+    struct TextPiece
+    {
+        std::string_view text;
+
+        std::size_t size() const { return text.size(); }
+        char *write(char *out) const
+        {
+            // memcpy with a null pointer is undefined even for zero bytes
+            if (!text.empty())
+                std::memcpy(out, text.data(), text.size());
+            return out + text.size();
+        }
+    };
+
+    struct CharPiece
+    {
+        char c;
+
+        std::size_t size() const { return 1; }
+        char *write(char *out) const
+        {
+            *out = c;
+            return out + 1;
+        }
+    };
+
+    // Kept as a number: counting the digits is cheaper than formatting them twice
+    struct IntegerPiece
+    {
+        std::uint64_t magnitude;
+        bool negative;
+
+        template <typename T>
+        explicit IntegerPiece(T value) : magnitude(static_cast<std::uint64_t>(value)), negative(false)
+        {
+            if constexpr (std::is_signed_v<T>)
+            {
+                if (value < 0)
+                {
+                    magnitude = std::uint64_t(0) - magnitude; // also right for the most negative value
+                    negative = true;
+                }
+            }
+        }
+
+        std::size_t size() const
+        {
+            std::size_t digits = 1;
+            for (std::uint64_t v = magnitude; v >= 10; v /= 10)
+                ++digits;
+            return digits + negative;
+        }
+
+        char *write(char *out) const
+        {
+            char *end = out + size();
+            char *p = end;
+            std::uint64_t v = magnitude;
+            do
+            {
+                *--p = static_cast<char>('0' + v % 10);
+                v /= 10;
+            } while (v != 0);
+            if (negative)
+                *--p = '-';
+            return end;
+        }
+    };
+
+    // Formatted when captured, since its length is only known by formatting it
+    struct FloatPiece
+    {
+        char digits[32];
+        unsigned char length;
+
+        template <typename T>
+        explicit FloatPiece(T value)
+        {
+            length = static_cast<unsigned char>(std::to_chars(digits, digits + sizeof(digits), value).ptr - digits);
+        }
+
+        std::size_t size() const { return length; }
+        char *write(char *out) const
+        {
+            std::memcpy(out, digits, length);
+            return out + length;
+        }
+    };
+
+    template <typename... Pieces>
+    class Expression;
+
+    // The piece a value becomes
+    inline TextPiece toPiece(std::string_view text) { return {text}; }
+    inline TextPiece toPiece(const char *text) { return {text}; }
+    inline TextPiece toPiece(const std::string &text) { return {text}; }
+    inline CharPiece toPiece(char c) { return {c}; }
+
+    template <typename T>
+        requires(std::is_integral_v<T> && !std::is_same_v<T, char> && !std::is_same_v<T, bool>)
+    IntegerPiece toPiece(T value)
+    {
+        return IntegerPiece(value);
+    }
+
+    template <typename T>
+        requires std::is_floating_point_v<T>
+    FloatPiece toPiece(T value)
+    {
+        return FloatPiece(value);
+    }
+
+    namespace detail
+    {
+        template <typename T>
+        struct IsExpression : std::false_type
+        {
+        };
+        template <typename... Pieces>
+        struct IsExpression<Expression<Pieces...>> : std::true_type
+        {
+        };
+
+        // The pieces of a value as a tuple; an expression contributes all of its own
+        template <typename T>
+        auto piecesOf(T &&value)
+        {
+            using Value = std::remove_cvref_t<T>;
+            static_assert(!(std::is_same_v<Value, std::string> && !std::is_lvalue_reference_v<T>),
+                          "a temporary std::string would be destroyed before the expression is used");
+            if constexpr (IsExpression<Value>::value)
+                return value.pieces();
+            else
+                return std::make_tuple(toPiece(value));
+        }
+
+        template <typename Tuple>
+        auto fromTuple(Tuple &&pieces)
+        {
+            return std::apply([](auto &&...p)
+                              { return Expression<std::remove_cvref_t<decltype(p)>...>(std::forward<decltype(p)>(p)...); },
+                              std::forward<Tuple>(pieces));
+        }
+    }
+
+    template <typename... Pieces>
+    class Expression
+    {
+    public:
+        explicit Expression(Pieces... pieces) : pieces_(std::move(pieces)...) {}
+
+        // Exact length of the result
+        std::size_t size() const
+        {
+            return std::apply([](const auto &...p)
+                              { return (std::size_t{0} + ... + p.size()); },
+                              pieces_);
+        }
+
+        // Writes the result (size() bytes, no terminator) and returns the end
+        char *write(char *out) const
+        {
+            std::apply([&out](const auto &...p)
+                       { ((out = p.write(out)), ...); },
+                       pieces_);
+            return out;
+        }
+
+        std::string str() const
+        {
+            std::string result(size(), '\0');
+            write(result.data());
+            return result;
+        }
+
+        operator std::string() const { return str(); }
+
+        // Appends to `out`, growing it at most once
+        void appendTo(std::string &out) const
+        {
+            const std::size_t old = out.size();
+            out.resize(old + size());
+            write(out.data() + old);
+        }
+
+        const std::tuple<Pieces...> &pieces() const { return pieces_; }
+
+        // Adds a piece (or all pieces of another expression) at the end
+        template <typename T>
+        auto operator+(T &&value) const
+        {
+            return detail::fromTuple(std::tuple_cat(pieces_, detail::piecesOf(std::forward<T>(value))));
+        }
+
+        friend std::ostream &operator<<(std::ostream &os, const Expression &expression)
+        {
+            return os << expression.str();
+        }
+
+    private:
+        std::tuple<Pieces...> pieces_;
+    };
+
+    // Records the pieces; nothing is allocated or copied until the result is used
+    template <typename... Args>
+    auto cat(Args &&...args)
+    {
+        return detail::fromTuple(std::tuple_cat(detail::piecesOf(std::forward<Args>(args))...));
+    }
+}
@@ -0,0 +1,213 @@
+#pragma once
+
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// String interning and allocation-free lookup in string-keyed maps
+//
+// complexTypeExamples (auto_examples.cpp) looks up mapCopy["Alice"]: the literal becomes a
+// temporary std::string for every lookup, which allocates once the name is longer than the
+// small-string buffer (15 characters in libstdc++). Two ways around it:
+//
+//   - Transparent comparison and hashing: StringMap<V> and StringHashMap<V> accept any
+//     string_view-like key in find/count/contains, so lookups never build a std::string.
+//     (operator[] and insertion still take a std::string, since they may store it.)
+//
+//         StringHashMap<int> ages;
+//         auto it = ages.find(std::string_view("Alice"));   // no allocation
+//
+//   - Interning: StringInterner stores each distinct name once and hands out a 32-bit Symbol.
+//     Records then hold 4-byte symbols instead of 32-byte strings, comparing two names is
+//     one integer compare, and SymbolMap<V> is a plain array indexed by symbol.
+//
+//         StringInterner names;
+//         Symbol alice = names.intern("Alice");           // same symbol every time
+//         SymbolMap<int> ages;
+//         ages[alice] = 25;
+//         std::string_view text = names.name(alice);       // valid as long as `names`
+//
+// Symbols are numbered 0, 1, 2, ... in interning order and only mean something together with
+// the interner that made them. Neither class is thread-safe.
+
+// Hash for any string-like key, so unordered containers can look up by string_view
+struct StringHash
+{
+    using is_transparent = void;
+
+    std::size_t operator()(std::string_view text) const { return std::hash<std::string_view>{}(text); }
+};
+
+template <typename V>
+using StringMap = std::map<std::string, V, std::less<>>;
+
+template <typename V>
+using StringHashMap = std::unordered_map<std::string, V, StringHash, std::equal_to<>>;
+
+struct Symbol
+{
+    std::uint32_t id = 0;
+
+    auto operator<=>(const Symbol &) const = default;
+};
+
+template <>
+struct std::hash<Symbol>
+{
+    std::size_t operator()(Symbol symbol) const { return std::hash<std::uint32_t>{}(symbol.id); }
+};
+
+class StringInterner
+{
+public:
+    StringInterner() = default;
+
+    // A copy would hand out views into the original's text, so only moving is allowed
+    StringInterner(const StringInterner &) = delete;
+    StringInterner &operator=(const StringInterner &) = delete;
+    StringInterner(StringInterner &&) = default;
+    StringInterner &operator=(StringInterner &&) = default;
+
+    // The symbol for `text`, adding it if it is new; std::length_error after 2^32 names
+    Symbol intern(std::string_view text)
+    {
+        if (auto found = index_.find(text); found != index_.end())
+            return found->second;
+        if (names_.size() > maxId)
+            throw std::length_error("StringInterner: more than 2^32 names");
+
+        const Symbol symbol{static_cast<std::uint32_t>(names_.size())};
+        const std::string_view stored = store(text);
+        names_.push_back(stored);
+        index_.emplace(stored, symbol);
+        return symbol;
+    }
+
+    // The symbol for `text` if it was interned; never allocates
+    std::optional<Symbol> find(std::string_view text) const
+    {
+        if (auto found = index_.find(text); found != index_.end())
+            return found->second;
+        return std::nullopt;
+    }
+
+    // The text of a symbol; std::out_of_range for a symbol this interner did not make
+    std::string_view name(Symbol symbol) const
+    {
+        if (symbol.id >= names_.size())
+            throw std::out_of_range("StringInterner: unknown symbol " + std::to_string(symbol.id));
+        return names_[symbol.id];
+    }
+
+    std::size_t size() const { return names_.size(); }
+
+    // Bytes held for the text and the tables (approximate: allocator overhead not included)
+    std::size_t memoryUsage() const
+    {
+        const std::size_t nodeBytes = sizeof(void *) + sizeof(std::string_view) + sizeof(Symbol) + sizeof(std::size_t);
+        return blocks_.size() * blockSize + largeBytes_ + names_.capacity() * sizeof(std::string_view) +
+               index_.bucket_count() * sizeof(void *) + index_.size() * nodeBytes;
+    }
+
+private:
+    static constexpr std::size_t maxId = 0xffffffffu;
+    static constexpr std::size_t blockSize = 64 * 1024;
+
+    // Copies text into the current block; long names get an allocation of their own
+    std::string_view store(std::string_view text)
+    {
+        if (text.empty())
+            return {};
+        if (text.size() > blockSize / 4)
+        {
+            large_.push_back(std::make_unique<char[]>(text.size()));
+            largeBytes_ += text.size();
+            std::memcpy(large_.back().get(), text.data(), text.size());
+            return {large_.back().get(), text.size()};
+        }
+        if (blocks_.empty() || text.size() > blockSize - used_)
+        {
+            blocks_.push_back(std::make_unique<char[]>(blockSize));
+            used_ = 0;
+        }
+        char *out = blocks_.back().get() + used_;
+        std::memcpy(out, text.data(), text.size());
+        used_ += text.size();
+        return {out, text.size()};
+    }
+
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    std::size_t used_ = 0; // bytes used in blocks_.back()
+    std::vector<std::unique_ptr<char[]>> large_;
+    std::size_t largeBytes_ = 0;
+    std::vector<std::string_view> names_;
+    std::unordered_map<std::string_view, Symbol> index_;
+};
+
+// A map from the symbols of one interner to V, stored as an array indexed by symbol: lookup is
+// one bounds check and one load, no hashing. Memory grows with the largest symbol used, so it
+// suits the usual case of a few hundred or thousand names; for a handful of entries out of
+// millions of symbols, use std::unordered_map<Symbol, V>.
+template <typename V>
+class SymbolMap
+{
+public:
+    // Inserts a default V if the symbol has no value yet
+    V &operator[](Symbol symbol)
+    {
+        if (symbol.id >= values_.size())
+            values_.resize(std::size_t{symbol.id} + 1);
+        std::optional<V> &value = values_[symbol.id];
+        if (!value)
+        {
+            value.emplace();
+            ++size_;
+        }
+        return *value;
+    }
+
+    // The value, or nullptr if the symbol has none
+    V *find(Symbol symbol) { return symbol.id < values_.size() && values_[symbol.id] ? &*values_[symbol.id] : nullptr; }
+    const V *find(Symbol symbol) const
+    {
+        return symbol.id < values_.size() && values_[symbol.id] ? &*values_[symbol.id] : nullptr;
+    }
+
+    bool contains(Symbol symbol) const { return find(symbol) != nullptr; }
+
+    // Removes the value; false if there was none
+    bool erase(Symbol symbol)
+    {
+        if (!contains(symbol))
+            return false;
+        values_[symbol.id].reset();
+        --size_;
+        return true;
+    }
+
+    // f(symbol, value) for every entry, in symbol order
+    template <typename F>
+    void for_each(F f) const
+    {
+        for (std::size_t id = 0; id < values_.size(); ++id)
+            if (values_[id])
+                f(Symbol{static_cast<std::uint32_t>(id)}, *values_[id]);
+    }
+
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+private:
+    std::vector<std::optional<V>> values_;
+    std::size_t size_ = 0;
+};
@@ -0,0 +1,365 @@
+#include "string_transform.hpp"
+
+#include <array>
+#include <bit>
+#include <cctype>
+#include <cstdint>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define STRING_TRANSFORM_X86 1
+#endif
+
+namespace StringTransform
+{
+    namespace
+    {
+        // process_string's result for each ASCII character in the "C" locale, 0 for dropped ones
+        constexpr std::array<char, 128> makeAsciiTable()
+        {
+            std::array<char, 128> table{};
+            for (int c = 0; c < 128; ++c)
+            {
+                if (c >= 'a' && c <= 'z')
+                    table[c] = static_cast<char>(c - 'a' + 'A');
+                else if (c >= 'A' && c <= 'Z')
+                    table[c] = static_cast<char>(c - 'A' + 'a');
+                else if (c >= '0' && c <= '9')
+                    table[c] = static_cast<char>(c);
+                else if (c == ' ')
+                    table[c] = '_';
+            }
+            return table;
+        }
+
+        constexpr std::array<char, 128> asciiTable = makeAsciiTable();
+
+        // One character. Bytes >= 0x80 are classified by the current locale, passed as unsigned
+        // char as <cctype> requires. In the default "C" locale none of them is a letter or a
+        // digit, so they are dropped, as process_string does; a single-byte locale such as
+        // Latin-1 may keep or case-swap them.
+        inline char *scalarChar(char c, char *out)
+        {
+            const auto byte = static_cast<unsigned char>(c);
+            if (byte < 128)
+            {
+                if (char mapped = asciiTable[byte])
+                    *out++ = mapped;
+            }
+            else if (std::isalpha(byte))
+                *out++ = static_cast<char>(std::islower(byte) ? std::toupper(byte) : std::tolower(byte));
+            else if (std::isdigit(byte))
+                *out++ = c;
+            return out;
+        }
+
+        char *scalarRange(const char *in, std::size_t n, char *out)
+        {
+            for (std::size_t k = 0; k < n; ++k)
+                out = scalarChar(in[k], out);
+            return out;
+        }
+
+        std::size_t processScalar(const char *in, std::size_t n, char *out) { return scalarRange(in, n, out) - out; }
+
+#ifdef STRING_TRANSFORM_X86
+        // compactTable[m] lists the positions of the set bits of m, lowest first, one per byte;
+        // the unused bytes are 0x80, which makes pshufb write zero
+        constexpr std::array<std::uint64_t, 256> makeCompactTable()
+        {
+            std::array<std::uint64_t, 256> table{};
+            for (unsigned mask = 0; mask < 256; ++mask)
+            {
+                std::uint64_t entry = 0x8080808080808080ULL;
+                unsigned slot = 0;
+                for (unsigned bit = 0; bit < 8; ++bit)
+                    if (mask & (1u << bit))
+                    {
+                        entry &= ~(0xFFULL << (8 * slot));
+                        entry |= std::uint64_t(bit) << (8 * slot);
+                        ++slot;
+                    }
+                table[mask] = entry;
+            }
+            return table;
+        }
+
+        constexpr std::array<std::uint64_t, 256> compactTable = makeCompactTable();
+
+        // Stores the bytes of `bytes` whose bit is set in `keep` (16 bits) contiguously at out.
+        // Writes up to 16 bytes, past the end of the result but never past out + 16.
+        __attribute__((target("ssse3"), always_inline)) inline char *compact16(__m128i bytes, unsigned keep, char *out)
+        {
+            const unsigned low = keep & 0xFF, high = keep >> 8;
+            // +8 moves the second half's indices to bytes 8..15 (0x80 stays >= 0x80)
+            __m128i control = _mm_set_epi64x(static_cast<long long>(compactTable[high] + 0x0808080808080808ULL),
+                                             static_cast<long long>(compactTable[low]));
+            __m128i packed = _mm_shuffle_epi8(bytes, control);
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(out), packed);
+            out += std::popcount(low);
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(out), _mm_unpackhi_epi64(packed, packed));
+            return out + std::popcount(high);
+        }
+
+        // Per byte: letters get bit 0x20 flipped (case swap), ' ' ^ 0x7F == '_', digits stay.
+        // "x - lo < count" as unsigned is tested as a signed compare after adding 0x80 - lo.
+
+        __attribute__((target("ssse3"))) std::size_t processSsse3(const char *in, std::size_t n, char *out)
+        {
+            char *start = out;
+            const __m128i lowerBias = _mm_set1_epi8(static_cast<char>(0x80 - 'a')), upperBias = _mm_set1_epi8(static_cast<char>(0x80 - 'A'));
+            const __m128i digitBias = _mm_set1_epi8(static_cast<char>(0x80 - '0'));
+            const __m128i letters = _mm_set1_epi8(-128 + 26), digits = _mm_set1_epi8(-128 + 10);
+            const __m128i space = _mm_set1_epi8(' '), caseBit = _mm_set1_epi8(0x20), spaceToUnderscore = _mm_set1_epi8(0x7F);
+            std::size_t k = 0;
+            // Writing at out <= in-position, 16 bytes at most: always inside the caller's buffer
+            for (; k + 16 <= n; k += 16)
+            {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + k));
+                if (_mm_movemask_epi8(v) != 0)
+                {
+                    out = scalarRange(in + k, 16, out);
+                    continue;
+                }
+                __m128i alpha = _mm_or_si128(_mm_cmplt_epi8(_mm_add_epi8(v, lowerBias), letters),
+                                             _mm_cmplt_epi8(_mm_add_epi8(v, upperBias), letters));
+                __m128i digit = _mm_cmplt_epi8(_mm_add_epi8(v, digitBias), digits);
+                __m128i isSpace = _mm_cmpeq_epi8(v, space);
+                __m128i flip = _mm_or_si128(_mm_and_si128(alpha, caseBit), _mm_and_si128(isSpace, spaceToUnderscore));
+                unsigned keep = static_cast<unsigned>(_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(alpha, digit), isSpace)));
+                out = compact16(_mm_xor_si128(v, flip), keep, out);
+            }
+            out = scalarRange(in + k, n - k, out);
+            return out - start;
+        }
+
+        __attribute__((target("avx2"))) std::size_t processAvx2(const char *in, std::size_t n, char *out)
+        {
+            char *start = out;
+            const __m256i lowerBias = _mm256_set1_epi8(static_cast<char>(0x80 - 'a')), upperBias = _mm256_set1_epi8(static_cast<char>(0x80 - 'A'));
+            const __m256i digitBias = _mm256_set1_epi8(static_cast<char>(0x80 - '0'));
+            const __m256i letters = _mm256_set1_epi8(-128 + 26), digits = _mm256_set1_epi8(-128 + 10);
+            const __m256i space = _mm256_set1_epi8(' '), caseBit = _mm256_set1_epi8(0x20), spaceToUnderscore = _mm256_set1_epi8(0x7F);
+            std::size_t k = 0;
+            for (; k + 32 <= n; k += 32)
+            {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + k));
+                if (_mm256_movemask_epi8(v) != 0)
+                {
+                    out = scalarRange(in + k, 32, out);
+                    continue;
+                }
+                // AVX2 has only "greater than": a < b is b > a
+                __m256i alpha = _mm256_or_si256(_mm256_cmpgt_epi8(letters, _mm256_add_epi8(v, lowerBias)),
+                                                _mm256_cmpgt_epi8(letters, _mm256_add_epi8(v, upperBias)));
+                __m256i digit = _mm256_cmpgt_epi8(digits, _mm256_add_epi8(v, digitBias));
+                __m256i isSpace = _mm256_cmpeq_epi8(v, space);
+                __m256i flip = _mm256_or_si256(_mm256_and_si256(alpha, caseBit), _mm256_and_si256(isSpace, spaceToUnderscore));
+                __m256i result = _mm256_xor_si256(v, flip);
+                unsigned keep = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(alpha, digit), isSpace)));
+                out = compact16(_mm256_castsi256_si128(result), keep & 0xFFFF, out);
+                out = compact16(_mm256_extracti128_si256(result, 1), keep >> 16, out);
+            }
+            out = scalarRange(in + k, n - k, out);
+            return out - start;
+        }
+
+// _mm512_extracti32x4_epi32 passes an undefined vector as its merge source, which GCC 12
+// flags as maybe-uninitialized when it is inlined into processAvx512
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+        // Classifies 64 ASCII bytes: the transformed bytes and the mask of bytes to keep
+        __attribute__((target("avx512bw"), always_inline)) inline void classify64(const __m512i &v, __m512i &result, __mmask64 &keep)
+        {
+            const __m512i letters = _mm512_set1_epi8(-128 + 26), digits = _mm512_set1_epi8(-128 + 10);
+            __mmask64 alpha = _mm512_cmplt_epi8_mask(_mm512_add_epi8(v, _mm512_set1_epi8(static_cast<char>(0x80 - 'a'))), letters) |
+                              _mm512_cmplt_epi8_mask(_mm512_add_epi8(v, _mm512_set1_epi8(static_cast<char>(0x80 - 'A'))), letters);
+            __mmask64 digit = _mm512_cmplt_epi8_mask(_mm512_add_epi8(v, _mm512_set1_epi8(static_cast<char>(0x80 - '0'))), digits);
+            __mmask64 isSpace = _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8(' '));
+            __m512i flip = _mm512_or_si512(_mm512_maskz_mov_epi8(alpha, _mm512_set1_epi8(0x20)),
+                                           _mm512_maskz_mov_epi8(isSpace, _mm512_set1_epi8(0x7F)));
+            result = _mm512_xor_si512(v, flip);
+            keep = alpha | digit | isSpace;
+        }
+
+        __attribute__((target("avx512bw"))) std::size_t processAvx512(const char *in, std::size_t n, char *out)
+        {
+            char *start = out;
+            std::size_t k = 0;
+            for (; k + 64 <= n; k += 64)
+            {
+                __m512i v = _mm512_loadu_si512(in + k);
+                if (_mm512_movepi8_mask(v) != 0)
+                {
+                    out = scalarRange(in + k, 64, out);
+                    continue;
+                }
+                __m512i result;
+                __mmask64 keep;
+                classify64(v, result, keep);
+                out = compact16(_mm512_extracti32x4_epi32(result, 0), static_cast<unsigned>(keep & 0xFFFF), out);
+                out = compact16(_mm512_extracti32x4_epi32(result, 1), static_cast<unsigned>((keep >> 16) & 0xFFFF), out);
+                out = compact16(_mm512_extracti32x4_epi32(result, 2), static_cast<unsigned>((keep >> 32) & 0xFFFF), out);
+                out = compact16(_mm512_extracti32x4_epi32(result, 3), static_cast<unsigned>(keep >> 48), out);
+            }
+            out = scalarRange(in + k, n - k, out);
+            return out - start;
+        }
+
+        // Same, packing all 64 bytes with one vpcompressb
+        __attribute__((target("avx512bw,avx512vbmi2"))) std::size_t processAvx512Vbmi2(const char *in, std::size_t n, char *out)
+        {
+            char *start = out;
+            std::size_t k = 0;
+            for (; k + 64 <= n; k += 64)
+            {
+                __m512i v = _mm512_loadu_si512(in + k);
+                if (_mm512_movepi8_mask(v) != 0)
+                {
+                    out = scalarRange(in + k, 64, out);
+                    continue;
+                }
+                __m512i result;
+                __mmask64 keep;
+                classify64(v, result, keep);
+                _mm512_mask_compressstoreu_epi8(out, keep, result);
+                out += std::popcount(keep);
+            }
+            out = scalarRange(in + k, n - k, out);
+            return out - start;
+        }
+#pragma GCC diagnostic pop
+#endif
+
+        using Kernel = std::size_t (*)(const char *, std::size_t, char *);
+
+        Kernel kernelFor(Isa isa)
+        {
+#ifdef STRING_TRANSFORM_X86
+            switch (isa)
+            {
+            case Isa::Scalar:
+                break;
+            case Isa::SSSE3:
+                return processSsse3;
+            case Isa::AVX2:
+                return processAvx2;
+            case Isa::AVX512:
+                return __builtin_cpu_supports("avx512vbmi2") ? processAvx512Vbmi2 : processAvx512;
+            }
+#else
+            (void)isa;
+#endif
+            return processScalar;
+        }
+
+        Kernel bestKernel()
+        {
+            static const Kernel kernel = kernelFor(bestIsa());
+            return kernel;
+        }
+    }
+
+    const char *isaName(Isa isa)
+    {
+        switch (isa)
+        {
+        case Isa::Scalar:
+            return "scalar";
+        case Isa::SSSE3:
+            return "ssse3";
+        case Isa::AVX2:
+            return "avx2";
+        case Isa::AVX512:
+            return "avx512";
+        }
+        return "unknown";
+    }
+
+    bool isSupported(Isa isa)
+    {
+#ifdef STRING_TRANSFORM_X86
+        __builtin_cpu_init();
+        switch (isa)
+        {
+        case Isa::Scalar:
+            return true;
+        case Isa::SSSE3:
+            return __builtin_cpu_supports("ssse3");
+        case Isa::AVX2:
+            return __builtin_cpu_supports("avx2");
+        case Isa::AVX512:
+            return __builtin_cpu_supports("avx512bw");
+        }
+        return false;
+#else
+        return isa == Isa::Scalar;
+#endif
+    }
+
+    Isa bestIsa()
+    {
+#ifdef STRING_TRANSFORM_X86
+        // Without VBMI2 the AVX-512 kernel packs each block with four 16-byte shuffles and is
+        // slower than AVX2, so it is only preferred when vpcompressb is available
+        if (isSupported(Isa::AVX512) && __builtin_cpu_supports("avx512vbmi2"))
+            return Isa::AVX512;
+#endif
+        for (Isa isa : {Isa::AVX2, Isa::SSSE3})
+            if (isSupported(isa))
+                return isa;
+        return Isa::Scalar;
+    }
+
+    std::size_t processInto(std::string_view input, char *out)
+    {
+        return bestKernel()(input.data(), input.size(), out);
+    }
+
+    std::size_t processInto(std::string_view input, char *out, Isa isa)
+    {
+        if (!isSupported(isa))
+            throw std::invalid_argument(std::string("StringTransform: ") + isaName(isa) + " is not supported on this CPU");
+        return kernelFor(isa)(input.data(), input.size(), out);
+    }
+
+    std::string processString(std::string_view input)
+    {
+        std::string result(input.size(), '\0');
+        result.resize(processInto(input, result.data()));
+        return result;
+    }
+
+    void Batch::clear()
+    {
+        arena_.clear();
+        offsets_.assign(1, 0);
+    }
+
+    void processBatch(std::span<const std::string_view> inputs, Batch &batch)
+    {
+        std::size_t total = 0;
+        for (std::string_view input : inputs)
+            total += input.size();
+
+        // One allocation (none when the batch is reused), then each result right after the previous one
+        batch.arena_.resize(total);
+        batch.offsets_.resize(inputs.size() + 1);
+        const Kernel kernel = bestKernel();
+        std::size_t used = 0;
+        for (std::size_t i = 0; i < inputs.size(); ++i)
+        {
+            used += kernel(inputs[i].data(), inputs[i].size(), batch.arena_.data() + used);
+            batch.offsets_[i + 1] = used;
+        }
+        batch.arena_.resize(used);
+    }
+
+    Batch processBatch(std::span<const std::string_view> inputs)
+    {
+        Batch batch;
+        processBatch(inputs, batch);
+        return batch;
+    }
+}
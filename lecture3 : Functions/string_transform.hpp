@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Bulk version of PoorInlineCandidates::process_string (inline_examples.hpp)
+//
+// process_string swaps the case of letters, keeps digits, turns spaces into '_' and drops
+// everything else, appending one character at a time with a locale call per character.
+// Here the output is sized once and ASCII text is handled 16, 32 or 64 bytes per step:
+// compares classify the bytes, one XOR applies the case swap and the '_', and a shuffle packs
+// the kept bytes together. A block holding a byte >= 0x80 is done one byte at a time, and
+// those bytes go through std::isalpha / std::toupper under the current locale (as unsigned
+// char), so in the default "C" locale the output is byte-identical to process_string.
+//
+//     std::string out = StringTransform::processString(text);
+//
+//     StringTransform::Batch batch;
+//     StringTransform::processBatch(lines, batch);   // every result in one buffer
+//     std::string_view third = batch[2];
+
+namespace StringTransform
+{
+    enum class Isa
+    {
+        Scalar, // a 128-entry table per character, into a preallocated buffer
+        SSSE3,
+        AVX2,
+        AVX512 // AVX-512BW; packs with vpcompressb where AVX512-VBMI2 is available
+    };
+
+    inline constexpr Isa allIsas[] = {Isa::Scalar, Isa::SSSE3, Isa::AVX2, Isa::AVX512};
+
+    const char *isaName(Isa isa);
+    bool isSupported(Isa isa);
+    // The fastest supported implementation: AVX-512 only with VBMI2, else AVX2 or SSSE3
+    Isa bestIsa();
+
+    // Writes the result for `input` to out, which must have room for input.size() chars (the
+    // output is never longer), and returns its length. The second form uses a given
+    // implementation; std::invalid_argument if the CPU does not support it.
+    std::size_t processInto(std::string_view input, char *out);
+    std::size_t processInto(std::string_view input, char *out, Isa isa);
+
+    std::string processString(std::string_view input);
+
+    // Results for many inputs, back to back in one buffer
+    class Batch
+    {
+    public:
+        std::size_t size() const { return offsets_.size() - 1; }
+        std::string_view operator[](std::size_t index) const
+        {
+            return std::string_view(arena_).substr(offsets_[index], offsets_[index + 1] - offsets_[index]);
+        }
+        const std::string &arena() const { return arena_; }
+        void clear();
+
+    private:
+        friend void processBatch(std::span<const std::string_view> inputs, Batch &batch);
+
+        std::string arena_;
+        std::vector<std::size_t> offsets_{0}; // result i is arena_[offsets_[i], offsets_[i + 1])
+    };
+
+    // Replaces the contents of `batch`; reusing one Batch reuses its memory
+    void processBatch(std::span<const std::string_view> inputs, Batch &batch);
+    Batch processBatch(std::span<const std::string_view> inputs);
+}
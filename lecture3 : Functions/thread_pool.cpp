@@ -0,0 +1,139 @@
+#include "thread_pool.hpp"
+#include "parallel_chunks.hpp"
+
+namespace Parallel
+{
+    namespace
+    {
+        // The pool the current thread works for, and its deque there
+        thread_local const ThreadPool *currentPool = nullptr;
+        thread_local unsigned currentDeque = 0;
+    }
+
+    ThreadPool::ThreadPool(unsigned threads)
+    {
+        threads = resolveThreads(threads);
+        for (unsigned i = 0; i < threads; ++i)
+            deques_.push_back(std::make_unique<Deque>());
+        workers_.reserve(threads - 1);
+        for (unsigned i = 1; i < threads; ++i)
+            workers_.emplace_back([this, i]
+                                  { workerLoop(i); });
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        for (auto &worker : workers_)
+            worker.join();
+    }
+
+    ThreadPool &ThreadPool::shared()
+    {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    unsigned ThreadPool::currentIndex() const
+    {
+        return currentPool == this ? currentDeque : 0;
+    }
+
+    void ThreadPool::push(Task task)
+    {
+        // Counted first, so the count never drops below the number of queued tasks
+        queued_.fetch_add(1, std::memory_order_release);
+        Deque &own = *deques_[currentIndex()];
+        {
+            std::lock_guard<std::mutex> lock(own.mutex);
+            own.tasks.push_back(std::move(task));
+        }
+        if (workers_.empty())
+            return;
+        // Taking the mutex orders this with a worker that has just found nothing and is about
+        // to sleep, so the wake-up cannot be lost
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex_);
+        }
+        wake_.notify_one();
+    }
+
+    bool ThreadPool::runOne()
+    {
+        if (queued_.load(std::memory_order_acquire) == 0)
+            return false;
+
+        const unsigned self = currentIndex();
+        const unsigned n = concurrency();
+        Task task;
+        for (unsigned k = 0; k < n && !task; ++k)
+        {
+            Deque &deque = *deques_[(self + k) % n];
+            std::lock_guard<std::mutex> lock(deque.mutex);
+            if (deque.tasks.empty())
+                continue;
+            if (k == 0)
+            {
+                task = std::move(deque.tasks.back());
+                deque.tasks.pop_back();
+            }
+            else
+            {
+                task = std::move(deque.tasks.front());
+                deque.tasks.pop_front();
+            }
+        }
+        if (!task)
+            return false;
+        queued_.fetch_sub(1, std::memory_order_relaxed);
+        task();
+        return true;
+    }
+
+    void ThreadPool::workerLoop(unsigned index)
+    {
+        currentPool = this;
+        currentDeque = index;
+        for (;;)
+        {
+            if (runOne())
+                continue;
+            std::unique_lock<std::mutex> lock(sleepMutex_);
+            wake_.wait(lock, [this]
+                       { return stopping_ || queued_.load(std::memory_order_acquire) != 0; });
+            if (stopping_)
+                return;
+        }
+    }
+
+    TaskGroup::~TaskGroup()
+    {
+        finish();
+    }
+
+    void TaskGroup::wait()
+    {
+        finish();
+        std::exception_ptr error;
+        {
+            std::lock_guard<std::mutex> lock(errorMutex_);
+            error = std::exchange(error_, nullptr);
+        }
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    void TaskGroup::finish()
+    {
+        while (pending_.load(std::memory_order_acquire) != 0)
+        {
+            // Our tasks are either queued (run one, maybe ours) or running elsewhere
+            if (!pool_.runOne())
+                std::this_thread::yield();
+        }
+    }
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Work-stealing thread pool for fork-join parallelism
+//
+// parallelChunks (parallel_chunks.hpp) starts fresh threads and gives each one equal chunk,
+// so the slowest chunk decides the time. ThreadPool keeps its threads alive and gives every
+// one a deque of tasks: a thread pushes and pops at the back of its own deque (newest
+// first, still in cache), and an idle thread steals from the front of another (oldest
+// first, which in a recursive split is the largest piece of work left).
+//
+//     Parallel::ThreadPool pool(4);           // 3 workers + the thread that waits
+//     Parallel::TaskGroup group(pool);
+//     group.run([&] { left(); });
+//     right();
+//     group.wait();                           // runs queued tasks while it waits
+//
+// A thread waiting in TaskGroup::wait() executes other tasks instead of blocking, so tasks may
+// start and wait for groups of their own. parallel_algorithms.hpp builds the STL-style
+// algorithms on top of this.
+
+namespace Parallel
+{
+    class ThreadPool
+    {
+    public:
+        // `threads` counts the calling thread, which works while it waits: threads - 1 workers
+        // are started. threads == 0 means one per hardware thread.
+        explicit ThreadPool(unsigned threads = 0);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        // Threads that can run tasks at once, including the waiting one
+        unsigned concurrency() const { return static_cast<unsigned>(deques_.size()); }
+
+        // The pool used by the algorithms when none is given, one thread per hardware thread
+        static ThreadPool &shared();
+
+    private:
+        friend class TaskGroup;
+        using Task = std::function<void()>;
+
+        // One per thread; index 0 is shared by all threads outside the pool
+        struct alignas(64) Deque
+        {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        void push(Task task);
+        // Runs one task, own deque first, then stolen; false if every deque was empty
+        bool runOne();
+        unsigned currentIndex() const;
+        void workerLoop(unsigned index);
+
+        std::vector<std::unique_ptr<Deque>> deques_;
+        std::vector<std::thread> workers_;
+        std::atomic<std::size_t> queued_{0};
+        std::mutex sleepMutex_;
+        std::condition_variable wake_;
+        bool stopping_ = false;
+    };
+
+    // Tasks that are waited for together
+    class TaskGroup
+    {
+    public:
+        explicit TaskGroup(ThreadPool &pool) : pool_(pool) {}
+        // Waits (discarding exceptions) so that no task outlives the data it refers to
+        ~TaskGroup();
+
+        TaskGroup(const TaskGroup &) = delete;
+        TaskGroup &operator=(const TaskGroup &) = delete;
+
+        template <typename F>
+        void run(F f)
+        {
+            pending_.fetch_add(1, std::memory_order_relaxed);
+            pool_.push([this, f = std::move(f)]() mutable
+                       {
+                try
+                {
+                    f();
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(errorMutex_);
+                    if (!error_)
+                        error_ = std::current_exception();
+                }
+                // Last use of this group: the waiter may destroy it right after
+                pending_.fetch_sub(1, std::memory_order_release); });
+        }
+
+        // Returns when every task has finished, rethrowing the first exception one threw
+        void wait();
+
+    private:
+        void finish();
+
+        ThreadPool &pool_;
+        std::atomic<std::size_t> pending_{0};
+        std::mutex errorMutex_;
+        std::exception_ptr error_;
+    };
+}
@@ -0,0 +1,544 @@
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+/*
+ *   AsyncLogger: error/info logging that stays off the hot path
+ *
+ *   iostreamGLOBALS.cpp explains that std::cerr is unbuffered: every message is a locked
+ *   write() system call. Here a log call only copies the format string pointer and its
+ *   arguments (binary, unformatted) into a ring owned by the calling thread. A background
+ *   thread drains all rings, does the formatting and writes to two sinks: warnings and
+ *   errors go to the error sink (stderr by default), info goes to the info sink (stdout).
+ *
+ *   Each ring has exactly one producer (its thread) and one consumer (the backend), so it
+ *   needs no lock, only an acquire/release pair on its head and tail counters.
+ *
+ *   Format strings must be string literals: only the pointer is stored. Arguments are
+ *   copied, including strings. "{}" is replaced by the next argument.
+ *
+ *   fatal() logs and then blocks until every earlier record is written and the sinks are
+ *   fsync()ed, so the message survives an abort() right after it.
+ */
+
+namespace io
+{
+    enum class LogLevel : std::uint8_t
+    {
+        Info,
+        Warning,
+        Error,
+        Fatal
+    };
+
+    namespace detail
+    {
+        // How each argument type is stored in a record
+        template <typename T>
+        using Stored = std::conditional_t<
+            std::is_same_v<T, bool> || std::is_same_v<T, char>, T,
+            std::conditional_t<std::is_integral_v<T> && std::is_signed_v<T>, long long,
+                               std::conditional_t<std::is_integral_v<T>, unsigned long long,
+                                                  std::conditional_t<std::is_floating_point_v<T>, double,
+                                                                     std::string_view>>>>;
+
+        template <typename T>
+        std::size_t encodedSize(const T &value)
+        {
+            using S = Stored<std::decay_t<T>>;
+            if constexpr (std::is_same_v<S, std::string_view>)
+                return sizeof(std::uint32_t) + std::string_view(value).size();
+            else
+                return sizeof(S);
+        }
+
+        template <typename T>
+        char *encode(char *out, const T &value)
+        {
+            using S = Stored<std::decay_t<T>>;
+            if constexpr (std::is_same_v<S, std::string_view>)
+            {
+                std::string_view text(value);
+                auto length = static_cast<std::uint32_t>(text.size());
+                std::memcpy(out, &length, sizeof(length));
+                std::memcpy(out + sizeof(length), text.data(), text.size());
+                return out + sizeof(length) + text.size();
+            }
+            else
+            {
+                S stored = static_cast<S>(value);
+                std::memcpy(out, &stored, sizeof(S));
+                return out + sizeof(S);
+            }
+        }
+
+        template <typename S>
+        const char *appendDecoded(std::string &out, const char *in)
+        {
+            if constexpr (std::is_same_v<S, std::string_view>)
+            {
+                std::uint32_t length;
+                std::memcpy(&length, in, sizeof(length));
+                out.append(in + sizeof(length), length);
+                return in + sizeof(length) + length;
+            }
+            else
+            {
+                S value;
+                std::memcpy(&value, in, sizeof(S));
+                if constexpr (std::is_same_v<S, bool>)
+                    out += value ? "true" : "false";
+                else if constexpr (std::is_same_v<S, char>)
+                    out += value;
+                else
+                {
+                    char digits[32];
+                    auto [end, ec] = std::to_chars(digits, digits + sizeof(digits), value);
+                    (void)ec;
+                    out.append(digits, end);
+                }
+                return in + sizeof(S);
+            }
+        }
+
+        // Copies the format text up to the next "{}" and returns what follows it
+        inline const char *appendUntilPlaceholder(std::string &out, const char *format)
+        {
+            const char *placeholder = std::strstr(format, "{}");
+            if (!placeholder)
+            {
+                out += format;
+                return format + std::strlen(format);
+            }
+            out.append(format, placeholder);
+            return placeholder + 2;
+        }
+
+        using DecodeFn = void (*)(std::string &out, const char *format, const char *payload);
+
+        template <typename... Stored>
+        void decode(std::string &out, const char *format, const char *payload)
+        {
+            ((format = appendUntilPlaceholder(out, format), payload = appendDecoded<Stored>(out, payload)), ...);
+            out += format;
+        }
+
+        struct RecordHeader
+        {
+            std::uint32_t size; // whole record, padded to alignof(RecordHeader)
+            bool padding;       // skip to the start of the ring; only size and padding are written
+            LogLevel level;
+            DecodeFn decode;
+            const char *format;
+            std::int64_t timestampNs;
+        };
+
+        // size and padding always fit before the end of the ring, the rest of a header may not
+        constexpr std::size_t recordPrefix = offsetof(RecordHeader, decode);
+
+        // Single-producer single-consumer byte ring
+        class Ring
+        {
+        public:
+            explicit Ring(std::size_t capacity) : capacity_(capacity), mask_(capacity - 1),
+                                                  bytes_(static_cast<char *>(::operator new(capacity, std::align_val_t(64)))) {}
+            ~Ring() { ::operator delete(bytes_, std::align_val_t(64)); }
+
+            Ring(const Ring &) = delete;
+            Ring &operator=(const Ring &) = delete;
+
+            std::size_t capacity() const { return capacity_; }
+
+            // Producer: reserve `size` contiguous bytes, or nullptr if the ring is full
+            char *reserve(std::size_t size)
+            {
+                std::uint64_t head = head_.load(std::memory_order_relaxed);
+                std::size_t position = head & mask_;
+                std::size_t contiguous = capacity_ - position;
+                std::size_t needed = size <= contiguous ? size : contiguous + size;
+
+                if (capacity_ - (head - cachedTail_) < needed)
+                {
+                    cachedTail_ = tail_.load(std::memory_order_acquire);
+                    if (capacity_ - (head - cachedTail_) < needed)
+                        return nullptr;
+                }
+                if (size > contiguous)
+                {
+                    // Not enough room before the end: pad to the end and start over at 0
+                    RecordHeader padding{};
+                    padding.size = static_cast<std::uint32_t>(contiguous);
+                    padding.padding = true;
+                    std::memcpy(bytes_ + position, &padding, recordPrefix);
+                    pendingPadding_ = contiguous;
+                    return bytes_;
+                }
+                pendingPadding_ = 0;
+                return bytes_ + position;
+            }
+
+            void commit(std::size_t size)
+            {
+                head_.store(head_.load(std::memory_order_relaxed) + pendingPadding_ + size, std::memory_order_release);
+            }
+
+            // Consumer: calls visit(header, payload) for every committed record, returns the record count
+            template <typename Visit>
+            std::size_t drain(Visit &&visit)
+            {
+                std::uint64_t tail = tail_.load(std::memory_order_relaxed);
+                std::uint64_t head = head_.load(std::memory_order_acquire);
+                std::size_t count = 0;
+                while (tail != head)
+                {
+                    const char *record = bytes_ + (tail & mask_);
+                    RecordHeader header;
+                    std::memcpy(&header, record, recordPrefix);
+                    if (!header.padding)
+                    {
+                        std::memcpy(&header, record, sizeof(header));
+                        visit(header, record + sizeof(RecordHeader));
+                        ++count;
+                    }
+                    tail += header.size;
+                }
+                tail_.store(tail, std::memory_order_release);
+                return count;
+            }
+
+            bool empty() const
+            {
+                return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+            }
+
+            std::atomic<bool> orphaned{false}; // its thread has exited, remove once drained
+
+        private:
+            const std::size_t capacity_;
+            const std::size_t mask_;
+            char *const bytes_;
+
+            alignas(64) std::atomic<std::uint64_t> head_{0}; // written by the producer only
+            std::uint64_t cachedTail_ = 0;
+            std::size_t pendingPadding_ = 0;
+            alignas(64) std::atomic<std::uint64_t> tail_{0}; // written by the consumer only
+        };
+    }
+
+    struct AsyncLoggerOptions
+    {
+        std::size_t ringBytes = 1 << 20; // per producing thread, rounded up to a power of two
+        // false: drop the record and count it in dropped(). Records may take up to half the
+        // ring; log() throws std::length_error for a larger one when blocking, drops it otherwise
+        bool blockWhenFull = true;
+        std::chrono::microseconds idleSleep{100};
+    };
+
+    class AsyncLogger
+    {
+    public:
+        // Logs to already open descriptors, e.g. STDERR_FILENO / STDOUT_FILENO
+        explicit AsyncLogger(int errorFd = STDERR_FILENO, int infoFd = STDOUT_FILENO, AsyncLoggerOptions options = {})
+            : options_(options), errorFd_(errorFd), infoFd_(infoFd)
+        {
+            start();
+        }
+
+        // Logs to two files (appending), which are closed by the logger
+        AsyncLogger(const std::string &errorPath, const std::string &infoPath, AsyncLoggerOptions options = {})
+            : options_(options), errorFd_(openSink(errorPath)), infoFd_(openSink(infoPath)), ownsSinks_(true)
+        {
+            start();
+        }
+
+        AsyncLogger(const AsyncLogger &) = delete;
+        AsyncLogger &operator=(const AsyncLogger &) = delete;
+
+        // Drains every ring before the backend stops, nothing logged is lost
+        ~AsyncLogger()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stopping_ = true;
+            }
+            wakeup_.notify_one();
+            backend_.join();
+            if (ownsSinks_)
+            {
+                ::close(errorFd_);
+                ::close(infoFd_);
+            }
+        }
+
+        template <typename... Args>
+        void log(LogLevel level, const char *format, const Args &...args)
+        {
+            detail::Ring &ring = localRing();
+            std::size_t size = sizeof(detail::RecordHeader) + (std::size_t{0} + ... + detail::encodedSize(args));
+            size = (size + alignof(detail::RecordHeader) - 1) & ~(alignof(detail::RecordHeader) - 1);
+            if (size > ring.capacity() / 2)
+            {
+                // Waiting cannot make room for it
+                if (options_.blockWhenFull)
+                    throw std::length_error("AsyncLogger: a " + std::to_string(size) + "-byte record does not fit a " +
+                                            std::to_string(ring.capacity()) + "-byte ring (at most half of it)");
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            char *record = ring.reserve(size);
+            while (!record)
+            {
+                if (!options_.blockWhenFull)
+                {
+                    dropped_.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+                std::this_thread::yield(); // the backend frees space as it drains
+                record = ring.reserve(size);
+            }
+
+            detail::RecordHeader header{};
+            header.size = static_cast<std::uint32_t>(size);
+            header.level = level;
+            header.decode = &detail::decode<detail::Stored<std::decay_t<Args>>...>;
+            header.format = format;
+            header.timestampNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now() - start_)
+                                     .count();
+            std::memcpy(record, &header, sizeof(header));
+            char *payload = record + sizeof(header);
+            ((payload = detail::encode(payload, args)), ...);
+            ring.commit(size);
+        }
+
+        template <typename... Args>
+        void info(const char *format, const Args &...args) { log(LogLevel::Info, format, args...); }
+
+        template <typename... Args>
+        void warning(const char *format, const Args &...args) { log(LogLevel::Warning, format, args...); }
+
+        template <typename... Args>
+        void error(const char *format, const Args &...args) { log(LogLevel::Error, format, args...); }
+
+        // Guaranteed flush path: returns only once this and every earlier record is on disk
+        template <typename... Args>
+        void fatal(const char *format, const Args &...args)
+        {
+            log(LogLevel::Fatal, format, args...);
+            flush(true);
+        }
+
+        // Waits until everything logged before the call has been written (and fsync()ed if asked)
+        void flush(bool sync = false)
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            std::uint64_t ticket = ++flushRequested_;
+            syncRequested_ |= sync;
+            wakeup_.notify_one();
+            flushed_.wait(lock, [&]
+                          { return flushCompleted_ >= ticket; });
+        }
+
+        std::uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    private:
+        static int openSink(const std::string &path)
+        {
+            int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+            if (fd < 0)
+                throw std::system_error(errno, std::generic_category(), "AsyncLogger: cannot open " + path);
+            return fd;
+        }
+
+        void start()
+        {
+            std::size_t capacity = 4096;
+            while (capacity < options_.ringBytes)
+                capacity <<= 1;
+            options_.ringBytes = capacity;
+            id_ = nextId().fetch_add(1);
+            start_ = std::chrono::steady_clock::now();
+            backend_ = std::thread([this]
+                                   { backendLoop(); });
+        }
+
+        static std::atomic<std::uint64_t> &nextId()
+        {
+            static std::atomic<std::uint64_t> id{1};
+            return id;
+        }
+
+        // Every thread keeps its rings alive until it exits, then marks them orphaned
+        struct ThreadRings
+        {
+            std::vector<std::pair<std::uint64_t, std::shared_ptr<detail::Ring>>> rings;
+            ~ThreadRings()
+            {
+                for (auto &entry : rings)
+                    entry.second->orphaned.store(true, std::memory_order_release);
+            }
+        };
+
+        detail::Ring &localRing()
+        {
+            thread_local std::uint64_t cachedId = 0;
+            thread_local detail::Ring *cachedRing = nullptr;
+            if (cachedId == id_)
+                return *cachedRing;
+
+            thread_local ThreadRings threadRings;
+            for (auto &entry : threadRings.rings)
+            {
+                if (entry.first == id_)
+                {
+                    cachedId = id_;
+                    cachedRing = entry.second.get();
+                    return *cachedRing;
+                }
+            }
+
+            // First record from this thread: register a new ring with the backend
+            auto ring = std::make_shared<detail::Ring>(options_.ringBytes);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                rings_.push_back(ring);
+            }
+            threadRings.rings.emplace_back(id_, ring);
+            cachedId = id_;
+            cachedRing = ring.get();
+            return *cachedRing;
+        }
+
+        void format(const detail::RecordHeader &header, const char *payload)
+        {
+            static constexpr const char *names[] = {"[INFO ", "[WARN ", "[ERROR ", "[FATAL "};
+            std::string &out = header.level == LogLevel::Info ? infoText_ : errorText_;
+            out += names[static_cast<int>(header.level)];
+            char stamp[32];
+            auto [end, ec] = std::to_chars(stamp, stamp + sizeof(stamp), static_cast<double>(header.timestampNs) / 1e9,
+                                           std::chars_format::fixed, 6);
+            (void)ec;
+            out.append(stamp, end);
+            out += "] ";
+            header.decode(out, header.format, payload);
+            out += '\n';
+        }
+
+        static void writeAll(int fd, std::string &text)
+        {
+            const char *data = text.data();
+            std::size_t left = text.size();
+            while (left > 0)
+            {
+                ssize_t written = ::write(fd, data, left);
+                if (written < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    break; // nowhere left to report a failing log sink
+                }
+                data += written;
+                left -= static_cast<std::size_t>(written);
+            }
+            text.clear();
+        }
+
+        void backendLoop()
+        {
+            std::vector<std::shared_ptr<detail::Ring>> rings;
+            bool idle = false;
+            while (true)
+            {
+                std::uint64_t ticket;
+                bool sync;
+                bool stopping;
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    if (idle && flushRequested_ == flushCompleted_ && !stopping_)
+                        wakeup_.wait_for(lock, options_.idleSleep);
+                    ticket = flushRequested_;
+                    sync = syncRequested_;
+                    syncRequested_ = false;
+                    stopping = stopping_;
+                    rings = rings_;
+                }
+
+                // Everything committed before the ticket was taken is visible to this pass
+                std::size_t drained = 0;
+                for (auto &ring : rings)
+                    drained += ring->drain([this](const detail::RecordHeader &header, const char *payload)
+                                           { format(header, payload); });
+                writeAll(errorFd_, errorText_);
+                writeAll(infoFd_, infoText_);
+                idle = drained == 0;
+
+                if (sync)
+                {
+                    ::fsync(errorFd_);
+                    ::fsync(infoFd_);
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    // Rings of exited threads can go once they are empty
+                    for (std::size_t i = 0; i < rings_.size();)
+                    {
+                        if (rings_[i]->orphaned.load(std::memory_order_acquire) && rings_[i]->empty())
+                        {
+                            rings_[i] = rings_.back();
+                            rings_.pop_back();
+                        }
+                        else
+                            ++i;
+                    }
+                    flushCompleted_ = ticket;
+                }
+                flushed_.notify_all();
+
+                if (stopping)
+                    break;
+            }
+        }
+
+        AsyncLoggerOptions options_;
+        int errorFd_;
+        int infoFd_;
+        bool ownsSinks_ = false;
+        std::uint64_t id_ = 0;
+        std::chrono::steady_clock::time_point start_;
+        std::atomic<std::uint64_t> dropped_{0};
+
+        std::mutex mutex_; // guards rings_, the flush tickets and stopping_; never taken by log()
+        std::condition_variable wakeup_;
+        std::condition_variable flushed_;
+        std::vector<std::shared_ptr<detail::Ring>> rings_;
+        std::uint64_t flushRequested_ = 0;
+        std::uint64_t flushCompleted_ = 0;
+        bool syncRequested_ = false;
+        bool stopping_ = false;
+
+        std::string errorText_; // backend only
+        std::string infoText_;  // backend only
+        std::thread backend_;
+    };
+}
@@ -0,0 +1,103 @@
+#include "asyncLogger.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ *   Per-call latency of std::cerr vs io::AsyncLogger
+ *
+ *   Both write to files so the terminal does not dominate: std::cerr is redirected to
+ *   cerr_bench.log, the logger writes logger_error.log and logger_info.log.
+ *
+ *   g++ -std=c++17 -O2 -pthread asyncLoggerBenchmark.cpp -o asyncLoggerBenchmark
+ *   ./asyncLoggerBenchmark [messages per thread] [threads]
+ */
+
+using Clock = std::chrono::steady_clock;
+
+int loadingFile()
+{
+    return -1;
+}
+
+template <typename LogOnce>
+std::vector<double> measure(std::size_t messages, std::size_t threads, LogOnce logOnce)
+{
+    std::vector<std::vector<double>> perThread(threads);
+    std::vector<std::thread> workers;
+    for (std::size_t t = 0; t < threads; ++t)
+    {
+        workers.emplace_back([&, t]
+                             {
+            auto &samples = perThread[t];
+            samples.reserve(messages);
+            for (std::size_t i = 0; i < messages; ++i)
+            {
+                auto before = Clock::now();
+                logOnce(i);
+                auto after = Clock::now();
+                samples.push_back(std::chrono::duration<double, std::nano>(after - before).count());
+            } });
+    }
+    for (auto &worker : workers)
+        worker.join();
+
+    std::vector<double> all;
+    for (auto &samples : perThread)
+        all.insert(all.end(), samples.begin(), samples.end());
+    std::sort(all.begin(), all.end());
+    return all;
+}
+
+void report(const char *name, const std::vector<double> &sorted)
+{
+    if (sorted.empty())
+    {
+        std::printf("%-26s no samples\n", name);
+        return;
+    }
+    auto at = [&](double p)
+    { return sorted[static_cast<std::size_t>(p * (sorted.size() - 1))]; };
+    std::printf("%-26s p50 %7.0f ns  p90 %7.0f ns  p99 %7.0f ns  p99.9 %8.0f ns  max %9.0f ns\n",
+                name, at(0.5), at(0.9), at(0.99), at(0.999), sorted.back());
+}
+
+int main(int argc, char **argv)
+{
+    std::size_t messages = argc > 1 ? std::stoul(argv[1]) : 200000;
+    std::size_t threads = argc > 2 ? std::stoul(argv[2]) : 1;
+    std::printf("%zu messages x %zu threads\n", messages, threads);
+
+    if (!std::freopen("cerr_bench.log", "w", stderr))
+        return 1;
+    auto cerrSamples = measure(messages, threads, [](std::size_t i)
+                               { std::cerr << "error acocured! code " << loadingFile() << " at " << i << std::endl; });
+    report("std::cerr", cerrSamples);
+
+    {
+        io::AsyncLogger logger("logger_error.log", "logger_info.log");
+        auto loggerSamples = measure(messages, threads, [&](std::size_t i)
+                                     { logger.error("error acocured! code {} at {}", loadingFile(), i); });
+        report("AsyncLogger::error", loggerSamples);
+
+        auto infoSamples = measure(messages, threads, [&](std::size_t i)
+                                   { logger.info("hello world {} {}", i, "from the hot loop"); });
+        report("AsyncLogger::info", infoSamples);
+
+        auto start = Clock::now();
+        logger.fatal("fatal error after {} messages", messages);
+        double fatalUs = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+        std::printf("%-26s %.0f us (drain + fsync)\n", "AsyncLogger::fatal", fatalUs);
+        std::printf("dropped records: %llu\n", static_cast<unsigned long long>(logger.dropped()));
+    }
+
+    std::remove("cerr_bench.log");
+    std::remove("logger_error.log");
+    std::remove("logger_info.log");
+    return 0;
+}
@@ -0,0 +1,326 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+/*
+ *   AsyncWriter: a multi-buffered replacement for the std::ofstream in writeFIle.cpp
+ *
+ *   The producer formats into one large in-memory buffer. When it is full the buffer is
+ *   handed to a background thread that hands it to the kernel with writev(), while the
+ *   producer keeps filling the next free buffer. The producer only blocks when every
+ *   buffer is in flight (the disk is slower than the producer).
+ *
+ *   One thread produces into a writer; the flushing thread is owned by the writer.
+ */
+
+namespace io
+{
+    enum class Durability
+    {
+        None,         // leave the data in the page cache, the kernel writes it back later
+        SyncOnClose,  // one fsync() when the writer is closed
+        SyncEachBatch // fdatasync() after every writev() batch: nothing acknowledged is lost
+    };
+
+    struct AsyncWriterOptions
+    {
+        std::size_t bufferSize = 1 << 20; // bytes per buffer
+        std::size_t bufferCount = 4;      // at least 2: one being filled, one being flushed
+        Durability durability = Durability::None;
+        bool append = false; // append to an existing file instead of truncating it
+    };
+
+    class AsyncWriter
+    {
+    public:
+        explicit AsyncWriter(const std::string &path, AsyncWriterOptions options = {})
+            : options_(options)
+        {
+            options_.bufferCount = std::max<std::size_t>(options_.bufferCount, 2);
+            options_.bufferSize = std::max<std::size_t>(options_.bufferSize, 4096);
+
+            int flags = O_WRONLY | O_CREAT | O_CLOEXEC | (options_.append ? O_APPEND : O_TRUNC);
+            fd_ = ::open(path.c_str(), flags, 0644);
+            if (fd_ < 0)
+            {
+                throw std::system_error(errno, std::generic_category(), "AsyncWriter: cannot open " + path);
+            }
+
+            buffers_.resize(options_.bufferCount);
+            for (std::size_t i = 0; i < buffers_.size(); ++i)
+            {
+                buffers_[i].data = std::make_unique<char[]>(options_.bufferSize);
+                if (i != 0)
+                    free_.push_back(i);
+            }
+            current_ = 0;
+            flusher_ = std::thread([this]
+                                   { flushLoop(); });
+        }
+
+        AsyncWriter(const AsyncWriter &) = delete;
+        AsyncWriter &operator=(const AsyncWriter &) = delete;
+
+        // The destructor drains everything, but cannot report errors: call close() to see them
+        ~AsyncWriter()
+        {
+            try
+            {
+                close();
+            }
+            catch (...)
+            {
+            }
+        }
+
+        bool is_open() const { return fd_ >= 0; }
+
+        void write(const char *data, std::size_t size)
+        {
+            while (size > 0)
+            {
+                Buffer &buffer = buffers_[current_];
+                std::size_t room = options_.bufferSize - buffer.size;
+                if (room == 0)
+                {
+                    submitCurrent();
+                    continue;
+                }
+                std::size_t chunk = std::min(room, size);
+                std::memcpy(buffer.data.get() + buffer.size, data, chunk);
+                buffer.size += chunk;
+                data += chunk;
+                size -= chunk;
+            }
+        }
+
+        void write(std::string_view text) { write(text.data(), text.size()); }
+
+        void put(char c)
+        {
+            Buffer &buffer = buffers_[current_];
+            if (buffer.size == options_.bufferSize)
+                submitCurrent();
+            buffers_[current_].data[buffers_[current_].size++] = c;
+        }
+
+        AsyncWriter &operator<<(std::string_view text)
+        {
+            write(text);
+            return *this;
+        }
+
+        AsyncWriter &operator<<(const char *text) { return *this << std::string_view(text); }
+
+        AsyncWriter &operator<<(char c)
+        {
+            put(c);
+            return *this;
+        }
+
+        // Integers are formatted straight into the buffer with std::to_chars (no locale, no allocation)
+        template <typename Int, typename = std::enable_if_t<std::is_integral_v<Int> && !std::is_same_v<Int, char> && !std::is_same_v<Int, bool>>>
+        AsyncWriter &operator<<(Int value)
+        {
+            constexpr std::size_t maxDigits = 24;
+            if (options_.bufferSize - buffers_[current_].size < maxDigits)
+                submitCurrent();
+            Buffer &buffer = buffers_[current_];
+            char *begin = buffer.data.get() + buffer.size;
+            auto [end, ec] = std::to_chars(begin, begin + maxDigits, value);
+            (void)ec; // maxDigits always fits a 64-bit integer
+            buffer.size += static_cast<std::size_t>(end - begin);
+            return *this;
+        }
+
+        // Hand the partially filled buffer to the flusher and wait until everything is written
+        void flush()
+        {
+            submitCurrent();
+            std::unique_lock<std::mutex> lock(mutex_);
+            bufferFreed_.wait(lock, [this]
+                              { return (full_.empty() && inFlight_ == 0) || error_ != 0; });
+            throwIfFailed();
+        }
+
+        // flush() and force the data to stable storage, whatever the durability policy says
+        void sync()
+        {
+            flush();
+            if (::fsync(fd_) != 0)
+                throw std::system_error(errno, std::generic_category(), "AsyncWriter: fsync failed");
+        }
+
+        // Drains all pending buffers, applies the durability policy and closes the file
+        void close()
+        {
+            if (fd_ < 0)
+                return;
+
+            {
+                // No free buffer is needed afterwards, so queue the last one without waiting
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (buffers_[current_].size > 0 && error_ == 0)
+                    full_.push_back(current_);
+                stopping_ = true;
+            }
+            bufferFull_.notify_one();
+            flusher_.join();
+
+            int error = error_;
+            if (error == 0 && options_.durability == Durability::SyncOnClose && ::fsync(fd_) != 0)
+                error = errno;
+            if (::close(fd_) != 0 && error == 0)
+                error = errno;
+            fd_ = -1;
+
+            if (error != 0)
+                throw std::system_error(error, std::generic_category(), "AsyncWriter: write failed");
+        }
+
+        // Bytes handed to the kernel so far (does not include the buffer being filled)
+        std::size_t bytesWritten() const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return bytesWritten_;
+        }
+
+    private:
+        struct Buffer
+        {
+            std::unique_ptr<char[]> data;
+            std::size_t size = 0;
+        };
+
+        // Queue the current buffer for writing and take a free one (blocks while none is free)
+        void submitCurrent()
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            throwIfFailed();
+            if (buffers_[current_].size == 0)
+                return;
+
+            full_.push_back(current_);
+            bufferFull_.notify_one();
+
+            bufferFreed_.wait(lock, [this]
+                              { return !free_.empty() || error_ != 0; });
+            throwIfFailed();
+            current_ = free_.front();
+            free_.pop_front();
+        }
+
+        void throwIfFailed() const
+        {
+            if (error_ != 0)
+                throw std::system_error(error_, std::generic_category(), "AsyncWriter: write failed");
+        }
+
+        void flushLoop()
+        {
+            std::vector<std::size_t> batch;
+            std::vector<iovec> iov;
+
+            std::unique_lock<std::mutex> lock(mutex_);
+            while (true)
+            {
+                bufferFull_.wait(lock, [this]
+                                 { return !full_.empty() || stopping_; });
+                if (full_.empty())
+                    break; // stopping and fully drained
+
+                // Take every full buffer at once so that one writev() covers all of them
+                batch.assign(full_.begin(), full_.end());
+                full_.clear();
+                inFlight_ = batch.size();
+                lock.unlock();
+
+                iov.clear();
+                std::size_t total = 0;
+                for (std::size_t index : batch)
+                {
+                    iov.push_back({buffers_[index].data.get(), buffers_[index].size});
+                    total += buffers_[index].size;
+                }
+                int error = error_ != 0 ? error_ : writeAll(iov); // after a failure only recycle buffers
+                if (error == 0 && options_.durability == Durability::SyncEachBatch && ::fdatasync(fd_) != 0)
+                    error = errno;
+
+                lock.lock();
+                for (std::size_t index : batch)
+                {
+                    buffers_[index].size = 0;
+                    free_.push_back(index);
+                }
+                inFlight_ = 0;
+                bytesWritten_ += total;
+                if (error != 0 && error_ == 0)
+                    error_ = error;
+                bufferFreed_.notify_all();
+            }
+        }
+
+        // writev() may write less than asked (signals, pipes, full disks): keep going until done
+        int writeAll(std::vector<iovec> &iov)
+        {
+            std::size_t first = 0;
+            while (first < iov.size())
+            {
+                int count = static_cast<int>(std::min<std::size_t>(iov.size() - first, IOV_MAX));
+                ssize_t written = ::writev(fd_, iov.data() + first, count);
+                if (written < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    return errno;
+                }
+                std::size_t left = static_cast<std::size_t>(written);
+                while (first < iov.size() && left >= iov[first].iov_len)
+                {
+                    left -= iov[first].iov_len;
+                    ++first;
+                }
+                if (left > 0)
+                {
+                    iov[first].iov_base = static_cast<char *>(iov[first].iov_base) + left;
+                    iov[first].iov_len -= left;
+                }
+            }
+            return 0;
+        }
+
+        AsyncWriterOptions options_;
+        int fd_ = -1;
+        std::vector<Buffer> buffers_;
+        std::size_t current_ = 0; // owned by the producer
+
+        mutable std::mutex mutex_;
+        std::condition_variable bufferFull_;  // producer -> flusher
+        std::condition_variable bufferFreed_; // flusher -> producer
+        std::deque<std::size_t> full_;
+        std::deque<std::size_t> free_;
+        std::size_t inFlight_ = 0;
+        std::size_t bytesWritten_ = 0;
+        int error_ = 0;
+        bool stopping_ = false;
+        std::thread flusher_;
+    };
+}
@@ -0,0 +1,126 @@
+#include "asyncWriter.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/*
+ *   Throughput and per-record latency of std::ofstream vs io::AsyncWriter
+ *   Every record is the writeFIle.cpp line followed by a running counter.
+ *
+ *   g++ -std=c++17 -O2 -pthread asyncWriterBenchmark.cpp -o asyncWriterBenchmark
+ *   ./asyncWriterBenchmark [records]
+ */
+
+using Clock = std::chrono::steady_clock;
+
+struct Result
+{
+    double seconds = 0;
+    std::size_t bytes = 0;
+    std::vector<double> latenciesNs; // one sample every sampleEvery records
+};
+
+constexpr std::size_t sampleEvery = 64;
+
+template <typename WriteRecord, typename Close>
+Result run(std::size_t records, WriteRecord writeRecord, Close close)
+{
+    Result result;
+    result.latenciesNs.reserve(records / sampleEvery + 1);
+
+    auto start = Clock::now();
+    for (std::size_t i = 0; i < records; ++i)
+    {
+        if (i % sampleEvery == 0)
+        {
+            auto before = Clock::now();
+            writeRecord(i);
+            auto after = Clock::now();
+            result.latenciesNs.push_back(std::chrono::duration<double, std::nano>(after - before).count());
+        }
+        else
+        {
+            writeRecord(i);
+        }
+    }
+    result.bytes = close(); // includes draining everything to the kernel
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return result;
+}
+
+double percentile(std::vector<double> samples, double p)
+{
+    if (samples.empty())
+        return 0;
+    std::size_t index = static_cast<std::size_t>(p * (samples.size() - 1));
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+
+void report(const char *name, const Result &result)
+{
+    double mbPerSecond = result.bytes / result.seconds / 1e6;
+    std::printf("%-28s %8.1f MB/s  p50 %7.0f ns  p99 %7.0f ns  p99.9 %9.0f ns  max %10.0f ns\n",
+                name, mbPerSecond,
+                percentile(result.latenciesNs, 0.50),
+                percentile(result.latenciesNs, 0.99),
+                percentile(result.latenciesNs, 0.999),
+                percentile(result.latenciesNs, 1.0));
+}
+
+int main(int argc, char **argv)
+{
+    std::size_t records = argc > 1 ? std::stoul(argv[1]) : 20000000;
+    const std::string path = "async_writer_bench.txt";
+    const std::string line = "hello from the main.cpp ";
+
+    std::cout << "Writing " << records << " records per run" << std::endl;
+
+    {
+        std::ofstream file(path);
+        auto result = run(
+            records,
+            [&](std::size_t i)
+            { file << line << i << '\n'; },
+            [&]
+            {
+                file.flush();
+                return static_cast<std::size_t>(file.tellp());
+            });
+        report("std::ofstream", result);
+    }
+
+    struct Config
+    {
+        const char *name;
+        io::AsyncWriterOptions options;
+    };
+    const Config configs[] = {
+        {"AsyncWriter 2 x 1 MiB", {1 << 20, 2, io::Durability::None, false}},
+        {"AsyncWriter 4 x 4 MiB", {4 << 20, 4, io::Durability::None, false}},
+        {"AsyncWriter 4 x 4 MiB fsync", {4 << 20, 4, io::Durability::SyncOnClose, false}},
+    };
+
+    for (const auto &config : configs)
+    {
+        io::AsyncWriter file(path, config.options);
+        auto result = run(
+            records,
+            [&](std::size_t i)
+            { file << line << i << '\n'; },
+            [&]
+            {
+                file.close();
+                return file.bytesWritten();
+            });
+        report(config.name, result);
+    }
+
+    std::remove(path.c_str());
+    return 0;
+}
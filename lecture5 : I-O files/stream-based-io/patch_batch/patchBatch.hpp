@@ -0,0 +1,231 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+ *   PatchBatch: in-place file updates without a seek per patch
+ *
+ *   writeFIle.cpp patches bytes with seekp() followed by <<. Every seekp() on an ofstream
+ *   flushes its buffer, so a million patches are a million write() calls in file order
+ *   of arrival. PatchBatch collects (offset, bytes) pairs first, sorts them by offset,
+ *   merges adjacent and overlapping patches into contiguous runs and then applies the
+ *   runs with one pwrite() each, or by copying them into a writable mmap of the file.
+ *
+ *   Overlapping patches behave like the stream version: the patch added last wins.
+ */
+
+namespace io
+{
+    enum class PatchMethod
+    {
+        Pwrite, // one pwrite() per merged run
+        Mmap    // memcpy() into a shared writable mapping of the patched range
+    };
+
+    class PatchBatch
+    {
+    public:
+        struct Run
+        {
+            std::uint64_t offset;
+            std::size_t position; // into runBytes()
+            std::size_t size;
+        };
+
+        void add(std::uint64_t offset, const void *data, std::size_t size)
+        {
+            if (size == 0)
+                return;
+            patches_.push_back({offset, bytes_.size(), size});
+            const char *bytes = static_cast<const char *>(data);
+            bytes_.insert(bytes_.end(), bytes, bytes + size);
+            coalesced_ = false;
+        }
+
+        void add(std::uint64_t offset, std::string_view bytes) { add(offset, bytes.data(), bytes.size()); }
+
+        std::size_t size() const { return patches_.size(); }
+        bool empty() const { return patches_.empty(); }
+
+        void clear()
+        {
+            patches_.clear();
+            bytes_.clear();
+            runs_.clear();
+            runBytes_.clear();
+            coalesced_ = false;
+        }
+
+        // Sorts and merges the patches into non-overlapping, non-adjacent runs (cached until the next add)
+        const std::vector<Run> &runs()
+        {
+            coalesce();
+            return runs_;
+        }
+
+        const char *runBytes() const { return runBytes_.data(); }
+
+        // Applies every patch to an open file descriptor, returns the number of system calls made
+        std::size_t apply(int fd, PatchMethod method = PatchMethod::Pwrite)
+        {
+            coalesce();
+            if (runs_.empty())
+                return 0;
+            return method == PatchMethod::Pwrite ? applyPwrite(fd) : applyMmap(fd);
+        }
+
+        std::size_t apply(const std::string &path, PatchMethod method = PatchMethod::Pwrite)
+        {
+            // O_RDWR even for pwrite: a shared writable mapping needs read access
+            int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+            if (fd < 0)
+                throw std::system_error(errno, std::generic_category(), "PatchBatch: cannot open " + path);
+            try
+            {
+                std::size_t calls = apply(fd, method);
+                ::close(fd);
+                return calls;
+            }
+            catch (...)
+            {
+                ::close(fd);
+                throw;
+            }
+        }
+
+    private:
+        struct Patch
+        {
+            std::uint64_t offset;
+            std::size_t position; // into bytes_
+            std::size_t size;
+            std::uint64_t end() const { return offset + size; }
+        };
+
+        void coalesce()
+        {
+            if (coalesced_)
+                return;
+            runs_.clear();
+            runBytes_.clear();
+
+            // Sort indices by offset; the index is also the insertion order
+            std::vector<std::uint32_t> order(patches_.size());
+            std::iota(order.begin(), order.end(), 0u);
+            std::sort(order.begin(), order.end(), [this](std::uint32_t a, std::uint32_t b)
+                      { return patches_[a].offset != patches_[b].offset ? patches_[a].offset < patches_[b].offset : a < b; });
+
+            std::size_t first = 0;
+            while (first < order.size())
+            {
+                // Extend the run while the next patch touches or overlaps it
+                std::uint64_t start = patches_[order[first]].offset;
+                std::uint64_t end = patches_[order[first]].end();
+                bool overlapping = false;
+                std::size_t last = first + 1;
+                while (last < order.size() && patches_[order[last]].offset <= end)
+                {
+                    overlapping |= patches_[order[last]].offset < end;
+                    end = std::max(end, patches_[order[last]].end());
+                    ++last;
+                }
+
+                // Overlaps are resolved by copying in insertion order so that the newest patch wins
+                if (overlapping)
+                    std::sort(order.begin() + first, order.begin() + last);
+
+                std::size_t position = runBytes_.size();
+                runBytes_.resize(position + (end - start));
+                for (std::size_t i = first; i < last; ++i)
+                {
+                    const Patch &patch = patches_[order[i]];
+                    std::memcpy(runBytes_.data() + position + (patch.offset - start), bytes_.data() + patch.position, patch.size);
+                }
+                runs_.push_back({start, position, static_cast<std::size_t>(end - start)});
+                first = last;
+            }
+            coalesced_ = true;
+        }
+
+        std::size_t applyPwrite(int fd)
+        {
+            std::size_t calls = 0;
+            for (const Run &run : runs_)
+            {
+                const char *data = runBytes_.data() + run.position;
+                std::size_t left = run.size;
+                std::uint64_t offset = run.offset;
+                while (left > 0)
+                {
+                    ssize_t written = ::pwrite(fd, data, left, static_cast<off_t>(offset));
+                    ++calls;
+                    if (written < 0)
+                    {
+                        if (errno == EINTR)
+                            continue;
+                        throw std::system_error(errno, std::generic_category(), "PatchBatch: pwrite failed");
+                    }
+                    data += written;
+                    left -= static_cast<std::size_t>(written);
+                    offset += static_cast<std::uint64_t>(written);
+                }
+            }
+            return calls;
+        }
+
+        std::size_t applyMmap(int fd)
+        {
+            std::size_t calls = 0;
+            std::uint64_t end = runs_.back().offset + runs_.back().size;
+
+            // Writing past the end of a mapping is SIGBUS, so grow the file first (like seekp past the end)
+            struct stat info;
+            if (::fstat(fd, &info) != 0)
+                throw std::system_error(errno, std::generic_category(), "PatchBatch: fstat failed");
+            ++calls;
+            if (static_cast<std::uint64_t>(info.st_size) < end)
+            {
+                if (::ftruncate(fd, static_cast<off_t>(end)) != 0)
+                    throw std::system_error(errno, std::generic_category(), "PatchBatch: ftruncate failed");
+                ++calls;
+            }
+
+            // Only the patched range is mapped; the mapping must start on a page boundary
+            std::uint64_t page = static_cast<std::uint64_t>(::sysconf(_SC_PAGESIZE));
+            std::uint64_t base = runs_.front().offset / page * page;
+            std::size_t length = static_cast<std::size_t>(end - base);
+            void *mapping = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, static_cast<off_t>(base));
+            if (mapping == MAP_FAILED)
+                throw std::system_error(errno, std::generic_category(), "PatchBatch: mmap failed");
+            ++calls;
+
+            char *bytes = static_cast<char *>(mapping);
+            for (const Run &run : runs_)
+            {
+                std::memcpy(bytes + (run.offset - base), runBytes_.data() + run.position, run.size);
+            }
+            ::munmap(mapping, length); // dirty pages are written back by the kernel, like pwrite()
+            ++calls;
+            return calls;
+        }
+
+        std::vector<Patch> patches_;
+        std::vector<char> bytes_;
+        std::vector<Run> runs_;
+        std::vector<char> runBytes_;
+        bool coalesced_ = false;
+    };
+}
@@ -0,0 +1,135 @@
+#include "patchBatch.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+ *   Stream seekp()/write() pairs vs io::PatchBatch (pwrite and mmap) on one large file
+ *
+ *   random:    8-byte records patched at uniformly random record offsets
+ *   clustered: the same number of records, but in bursts of 64 consecutive records
+ *
+ *   g++ -std=c++17 -O2 patchBatchBenchmark.cpp -o patchBatchBenchmark
+ *   ./patchBatchBenchmark [file MiB] [patches]
+ */
+
+using Clock = std::chrono::steady_clock;
+
+struct Patch
+{
+    std::uint64_t offset;
+    std::uint64_t value;
+};
+
+constexpr std::size_t recordSize = sizeof(std::uint64_t);
+
+std::vector<Patch> randomPatches(std::size_t count, std::uint64_t records, std::mt19937_64 &rng)
+{
+    std::uniform_int_distribution<std::uint64_t> record(0, records - 1);
+    std::vector<Patch> patches(count);
+    for (std::size_t i = 0; i < count; ++i)
+        patches[i] = {record(rng) * recordSize, i};
+    return patches;
+}
+
+std::vector<Patch> clusteredPatches(std::size_t count, std::uint64_t records, std::mt19937_64 &rng)
+{
+    constexpr std::uint64_t clusterSize = 64;
+    std::uniform_int_distribution<std::uint64_t> cluster(0, records / clusterSize - 1);
+    std::vector<Patch> patches(count);
+    for (std::size_t i = 0; i < count; i += clusterSize)
+    {
+        std::uint64_t first = cluster(rng) * clusterSize;
+        for (std::size_t j = 0; j < clusterSize && i + j < count; ++j)
+            patches[i + j] = {(first + j) * recordSize, i + j};
+    }
+    return patches;
+}
+
+void createFile(const std::string &path, std::size_t bytes)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    std::vector<char> zeros(1 << 20, 0);
+    for (std::size_t written = 0; written < bytes; written += zeros.size())
+        file.write(zeros.data(), static_cast<std::streamsize>(std::min(zeros.size(), bytes - written)));
+}
+
+std::uint64_t checksum(const std::string &path)
+{
+    std::ifstream file(path, std::ios::binary);
+    std::vector<char> buffer(1 << 20);
+    std::uint64_t hash = 1469598103934665603ull; // FNV-1a
+    while (file.read(buffer.data(), static_cast<std::streamsize>(buffer.size())) || file.gcount() > 0)
+    {
+        for (std::streamsize i = 0; i < file.gcount(); ++i)
+            hash = (hash ^ static_cast<unsigned char>(buffer[static_cast<std::size_t>(i)])) * 1099511628211ull;
+    }
+    return hash;
+}
+
+template <typename Apply>
+double timeIt(Apply apply)
+{
+    auto start = Clock::now();
+    apply();
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+void runPattern(const char *name, const std::vector<Patch> &patches, const std::string &path, std::size_t fileBytes)
+{
+    std::cout << "--- " << name << " (" << patches.size() << " patches) ---" << std::endl;
+
+    createFile(path, fileBytes);
+    double streamMs = timeIt([&]
+                             {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        for (const Patch &patch : patches)
+        {
+            file.seekp(static_cast<std::streamoff>(patch.offset));
+            file.write(reinterpret_cast<const char *>(&patch.value), recordSize);
+        } });
+    std::uint64_t expected = checksum(path);
+    std::printf("  %-22s %9.1f ms\n", "fstream seekp/write", streamMs);
+
+    const std::pair<const char *, io::PatchMethod> methods[] = {
+        {"PatchBatch pwrite", io::PatchMethod::Pwrite},
+        {"PatchBatch mmap", io::PatchMethod::Mmap},
+    };
+    for (const auto &[label, method] : methods)
+    {
+        createFile(path, fileBytes);
+        std::size_t calls = 0;
+        std::size_t runs = 0;
+        double ms = timeIt([&]
+                           {
+            io::PatchBatch batch;
+            for (const Patch &patch : patches)
+                batch.add(patch.offset, &patch.value, recordSize);
+            runs = batch.runs().size();
+            calls = batch.apply(path, method); });
+        bool same = checksum(path) == expected;
+        std::printf("  %-22s %9.1f ms  (%zu runs, %zu syscalls, %.1fx, %s)\n",
+                    label, ms, runs, calls, streamMs / ms, same ? "identical" : "MISMATCH");
+    }
+}
+
+int main(int argc, char **argv)
+{
+    std::size_t fileMiB = argc > 1 ? std::stoul(argv[1]) : 256;
+    std::size_t count = argc > 2 ? std::stoul(argv[2]) : 1000000;
+    const std::string path = "patch_batch_bench.bin";
+    const std::size_t fileBytes = fileMiB << 20;
+    const std::uint64_t records = fileBytes / recordSize;
+
+    std::mt19937_64 rng(42);
+    runPattern("random", randomPatches(count, records, rng), path, fileBytes);
+    runPattern("clustered", clusteredPatches(count, records, rng), path, fileBytes);
+
+    std::remove(path.c_str());
+    return 0;
+}
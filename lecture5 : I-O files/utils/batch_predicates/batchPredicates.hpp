@@ -0,0 +1,244 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/*
+ *   Batch predicates: isGreat() from optional.cpp applied to whole arrays
+ *
+ *   Returning a std::optional per element forces a branch per element, which the compiler
+ *   cannot vectorize. These kernels test a whole block of values at once and produce:
+ *
+ *       a bitmask         bit i of mask[i / 64] is set when values[i] passes
+ *       a selection       the indices of the passing values
+ *       a compressed copy the passing values themselves, packed
+ *
+ *   The comparisons use AVX2 (8 lanes) when compiled with -mavx2 or -march=native, SSE2
+ *   (4 lanes) otherwise, and plain scalar code on other CPUs. The scalar form stays the
+ *   single-value API: predicate(value) is a bool, select(value, predicate) an optional.
+ */
+
+namespace predicates
+{
+    // value > threshold
+    struct Greater
+    {
+        int threshold;
+
+        bool operator()(int value) const { return value > threshold; }
+#if defined(__AVX2__)
+        __m256i operator()(__m256i values) const { return _mm256_cmpgt_epi32(values, _mm256_set1_epi32(threshold)); }
+#elif defined(__SSE2__)
+        __m128i operator()(__m128i values) const { return _mm_cmpgt_epi32(values, _mm_set1_epi32(threshold)); }
+#endif
+    };
+
+    // value < threshold
+    struct Less
+    {
+        int threshold;
+
+        bool operator()(int value) const { return value < threshold; }
+#if defined(__AVX2__)
+        __m256i operator()(__m256i values) const { return _mm256_cmpgt_epi32(_mm256_set1_epi32(threshold), values); }
+#elif defined(__SSE2__)
+        __m128i operator()(__m128i values) const { return _mm_cmplt_epi32(values, _mm_set1_epi32(threshold)); }
+#endif
+    };
+
+    // low <= value <= high
+    struct Between
+    {
+        int low;
+        int high;
+
+        bool operator()(int value) const { return value >= low && value <= high; }
+#if defined(__AVX2__)
+        __m256i operator()(__m256i values) const
+        {
+            __m256i belowLow = _mm256_cmpgt_epi32(_mm256_set1_epi32(low), values);
+            __m256i aboveHigh = _mm256_cmpgt_epi32(values, _mm256_set1_epi32(high));
+            return _mm256_andnot_si256(_mm256_or_si256(belowLow, aboveHigh), _mm256_set1_epi32(-1));
+        }
+#elif defined(__SSE2__)
+        __m128i operator()(__m128i values) const
+        {
+            __m128i belowLow = _mm_cmplt_epi32(values, _mm_set1_epi32(low));
+            __m128i aboveHigh = _mm_cmpgt_epi32(values, _mm_set1_epi32(high));
+            return _mm_andnot_si128(_mm_or_si128(belowLow, aboveHigh), _mm_set1_epi32(-1));
+        }
+#endif
+    };
+
+    // Single-value API: the value itself when it passes, std::nullopt otherwise
+    template <typename Predicate>
+    std::optional<int> select(int value, Predicate predicate)
+    {
+        if (predicate(value))
+            return value;
+        return std::nullopt;
+    }
+
+    // Fills mask ((count + 63) / 64 words) and returns how many values passed
+    template <typename Predicate>
+    std::size_t match(const int *values, std::size_t count, Predicate predicate, std::uint64_t *mask)
+    {
+        std::size_t words = (count + 63) / 64;
+        // mask may be null when count is 0, and memset with a null pointer is undefined even
+        // for zero bytes
+        if (words != 0)
+            std::memset(mask, 0, words * sizeof(std::uint64_t));
+        std::size_t i = 0;
+#if defined(__AVX2__)
+        for (; i + 8 <= count; i += 8)
+        {
+            __m256i hit = predicate(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i)));
+            auto bits = static_cast<std::uint64_t>(_mm256_movemask_ps(_mm256_castsi256_ps(hit)));
+            mask[i / 64] |= bits << (i % 64);
+        }
+#elif defined(__SSE2__)
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128i hit = predicate(_mm_loadu_si128(reinterpret_cast<const __m128i *>(values + i)));
+            auto bits = static_cast<std::uint64_t>(_mm_movemask_ps(_mm_castsi128_ps(hit)));
+            mask[i / 64] |= bits << (i % 64);
+        }
+#endif
+        for (; i < count; ++i)
+            mask[i / 64] |= static_cast<std::uint64_t>(predicate(values[i])) << (i % 64);
+
+        std::size_t passed = 0;
+        for (std::size_t w = 0; w < words; ++w)
+            passed += static_cast<std::size_t>(__builtin_popcountll(mask[w]));
+        return passed;
+    }
+
+    template <typename Predicate>
+    std::vector<std::uint64_t> match(const std::vector<int> &values, Predicate predicate)
+    {
+        std::vector<std::uint64_t> mask((values.size() + 63) / 64);
+        match(values.data(), values.size(), predicate, mask.data());
+        return mask;
+    }
+
+    // Indices of the set bits, in order; selection must have room for every set bit
+    inline std::size_t maskToSelection(const std::uint64_t *mask, std::size_t words, std::uint32_t *selection)
+    {
+        std::size_t selected = 0;
+        for (std::size_t w = 0; w < words; ++w)
+        {
+            for (std::uint64_t bits = mask[w]; bits != 0; bits &= bits - 1)
+                selection[selected++] = static_cast<std::uint32_t>(w * 64 + static_cast<std::size_t>(__builtin_ctzll(bits)));
+        }
+        return selected;
+    }
+
+    namespace detail
+    {
+#if defined(__AVX2__)
+        // For every 8-bit lane mask, the permutation that moves the selected lanes to the front
+        inline const std::array<std::array<std::int32_t, 8>, 256> &compressTable()
+        {
+            static const auto table = []
+            {
+                std::array<std::array<std::int32_t, 8>, 256> entries{};
+                for (int bits = 0; bits < 256; ++bits)
+                {
+                    int next = 0;
+                    for (int lane = 0; lane < 8; ++lane)
+                        if (bits & (1 << lane))
+                            entries[bits][next++] = lane;
+                }
+                return entries;
+            }();
+            return table;
+        }
+#endif
+    }
+
+    // Writes the indices of passing values into selection (room for count entries), returns how many
+    template <typename Predicate>
+    std::size_t select(const int *values, std::size_t count, Predicate predicate, std::uint32_t *selection)
+    {
+        std::size_t selected = 0;
+        std::size_t i = 0;
+#if defined(__AVX2__)
+        const auto &table = detail::compressTable();
+        const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        for (; i + 8 <= count; i += 8)
+        {
+            __m256i hit = predicate(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i)));
+            int bits = _mm256_movemask_ps(_mm256_castsi256_ps(hit));
+            __m256i permutation = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(table[bits].data()));
+            __m256i indices = _mm256_add_epi32(lanes, _mm256_set1_epi32(static_cast<int>(i)));
+            // Full 8-lane store; lanes past the selected ones are overwritten by the next step
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(selection + selected), _mm256_permutevar8x32_epi32(indices, permutation));
+            selected += static_cast<std::size_t>(__builtin_popcount(static_cast<unsigned>(bits)));
+        }
+#endif
+        // Branch-free: always store, only advance on a hit
+        for (; i < count; ++i)
+        {
+            selection[selected] = static_cast<std::uint32_t>(i);
+            selected += predicate(values[i]);
+        }
+        return selected;
+    }
+
+    // Copies the passing values to out (room for count values), returns how many
+    template <typename Predicate>
+    std::size_t compress(const int *values, std::size_t count, Predicate predicate, int *out)
+    {
+        std::size_t kept = 0;
+        std::size_t i = 0;
+#if defined(__AVX2__)
+        const auto &table = detail::compressTable();
+        for (; i + 8 <= count; i += 8)
+        {
+            __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i));
+            int bits = _mm256_movemask_ps(_mm256_castsi256_ps(predicate(block)));
+            __m256i permutation = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(table[bits].data()));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + kept), _mm256_permutevar8x32_epi32(block, permutation));
+            kept += static_cast<std::size_t>(__builtin_popcount(static_cast<unsigned>(bits)));
+        }
+#endif
+        for (; i < count; ++i)
+        {
+            out[kept] = values[i];
+            kept += predicate(values[i]);
+        }
+        return kept;
+    }
+
+    template <typename Predicate>
+    std::vector<int> compress(const std::vector<int> &values, Predicate predicate)
+    {
+        std::vector<int> out(values.size());
+        out.resize(compress(values.data(), values.size(), predicate, out.data()));
+        return out;
+    }
+
+    // out[k] = values[selection[k]]
+    inline void gather(const int *values, const std::uint32_t *selection, std::size_t count, int *out)
+    {
+        std::size_t k = 0;
+#if defined(__AVX2__)
+        for (; k + 8 <= count; k += 8)
+        {
+            __m256i indices = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(selection + k));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + k), _mm256_i32gather_epi32(values, indices, 4));
+        }
+#endif
+        for (; k < count; ++k)
+            out[k] = values[selection[k]];
+    }
+}
@@ -0,0 +1,104 @@
+#include "batchPredicates.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+ *   Per-element std::optional vs batch kernels, selectivity 0% .. 100%
+ *
+ *   optional:  for each value, isGreat-style std::optional<int> + branch, push the survivors
+ *   mask:      predicates::match  -> bitmask + count
+ *   select:    predicates::select -> selection vector
+ *   compress:  predicates::compress -> packed passing values
+ *
+ *   g++ -std=c++17 -O2 batchPredicatesBenchmark.cpp -o batchPredicatesBenchmark
+ *   g++ -std=c++17 -O2 -march=native batchPredicatesBenchmark.cpp -o batchPredicatesBenchmark   (AVX2)
+ *   ./batchPredicatesBenchmark [values]
+ */
+
+using Clock = std::chrono::steady_clock;
+
+std::optional<int> keepIfGreater(int num, int threshold)
+{
+    if (num > threshold)
+        return num;
+    else
+        return std::nullopt;
+}
+
+template <typename Work>
+double bestNsPerValue(std::size_t values, Work work)
+{
+    double best = 1e300;
+    for (int r = 0; r < 5; ++r)
+    {
+        auto start = Clock::now();
+        work();
+        best = std::min(best, std::chrono::duration<double, std::nano>(Clock::now() - start).count());
+    }
+    return best / static_cast<double>(values);
+}
+
+int main(int argc, char **argv)
+{
+    std::size_t count = argc > 1 ? std::stoul(argv[1]) : 10000000;
+#if defined(__AVX2__)
+    const char *isa = "AVX2";
+#elif defined(__SSE2__)
+    const char *isa = "SSE2";
+#else
+    const char *isa = "scalar";
+#endif
+    std::printf("%zu values, kernels built for %s (ns per value)\n", count, isa);
+
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<int> distribution(0, 99999);
+    std::vector<int> values(count);
+    for (int &value : values)
+        value = distribution(rng);
+
+    std::vector<int> survivors(count);
+    std::vector<int> packed(count);
+    std::vector<std::uint32_t> selection(count);
+    std::vector<std::uint64_t> mask((count + 63) / 64);
+
+    std::printf("%11s %10s %10s %10s %10s\n", "selectivity", "optional", "mask", "select", "compress");
+    for (int percent = 0; percent <= 100; percent += 10)
+    {
+        // values are uniform in [0, 100000): value > threshold passes percent% of the time
+        int threshold = 100000 - percent * 1000 - 1;
+        predicates::Greater isGreat{threshold};
+
+        std::size_t expected = 0;
+        double optionalNs = bestNsPerValue(count, [&]
+                                           {
+            expected = 0;
+            for (int value : values)
+                if (auto kept = keepIfGreater(value, threshold))
+                    survivors[expected++] = *kept; });
+
+        std::size_t matched = 0, selected = 0, kept = 0;
+        double maskNs = bestNsPerValue(count, [&]
+                                       { matched = predicates::match(values.data(), count, isGreat, mask.data()); });
+        double selectNs = bestNsPerValue(count, [&]
+                                         { selected = predicates::select(values.data(), count, isGreat, selection.data()); });
+        double compressNs = bestNsPerValue(count, [&]
+                                           { kept = predicates::compress(values.data(), count, isGreat, packed.data()); });
+
+        bool same = matched == expected && selected == expected && kept == expected &&
+                    std::equal(survivors.begin(), survivors.begin() + static_cast<std::ptrdiff_t>(expected), packed.begin());
+        std::printf("%10d%% %10.2f %10.2f %10.2f %10.2f  %s\n", percent, optionalNs, maskNs, selectNs, compressNs,
+                    same ? "" : "MISMATCH");
+    }
+
+    // gather turns a selection back into values
+    std::size_t selected = predicates::select(values.data(), count, predicates::Between{1000, 2000}, selection.data());
+    predicates::gather(values.data(), selection.data(), selected, packed.data());
+    std::printf("Between{1000, 2000}: %zu values, first %d\n", selected, selected ? packed[0] : -1);
+    return 0;
+}
@@ -1,11 +1,12 @@
 #include <utility>
 #include <optional>
 #include <iostream>
+#include "batch_predicates/batchPredicates.hpp"
 #define print(x) std::cout << x << std::endl
 
 std::optional<int> isGreat(int num) // this allows you to make a return optional !
 {
-    if (num > 1000)
+    if (predicates::Greater{1000}(num)) // same test as the batch kernels use for whole arrays
         return 1;
     else
         return std::nullopt;
@@ -0,0 +1,429 @@
+#pragma once
+
+#include "studentTable.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <tuple>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+ *   StudentFile: a binary, memory-mappable form of StudentTable
+ *
+ *   File layout (version 1, little-endian, every block 64-byte aligned):
+ *
+ *       FileHeader         64 bytes: magic, version, row/segment counts, committed length, CRC-32
+ *       segment 0          SegmentHeader (64 bytes) followed by its columns:
+ *           ages           int32  x rows
+ *           grades         char   x rows
+ *           nameEnds       uint32 x rows   end of each name inside this segment's names
+ *           names          the names, back to back
+ *       segment 1 ...
+ *
+ *   The writer is append-only: each append() writes a new segment after the committed end
+ *   and then rewrites the file header, so a crash mid-append leaves the previous contents
+ *   intact (bytes past the committed length are ignored and overwritten by the next append).
+ *
+ *   The reader maps the file and points straight into the columns; opening checks the
+ *   header and segment headers only (including that every column lies inside the committed
+ *   bytes), verify() also checks every column checksum.
+ */
+
+namespace students
+{
+    namespace format
+    {
+        constexpr char fileMagic[8] = {'S', 'T', 'U', 'D', 'E', 'N', 'T', 'S'};
+        constexpr char segmentMagic[8] = {'S', 'E', 'G', 'M', 'E', 'N', 'T', '1'};
+        constexpr std::uint32_t version = 1;
+        constexpr std::uint64_t alignment = 64;
+
+        struct FileHeader
+        {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t headerBytes;
+            std::uint64_t segmentCount;
+            std::uint64_t rowCount;
+            std::uint64_t committedBytes; // everything after this offset is not part of the file
+            std::uint64_t reserved[2];
+            std::uint32_t flags;
+            std::uint32_t checksum; // CRC-32 of the bytes before this field
+        };
+        static_assert(sizeof(FileHeader) == 64, "FileHeader must stay 64 bytes");
+
+        struct SegmentHeader
+        {
+            char magic[8];
+            std::uint64_t rows;
+            std::uint64_t nameBytes;
+            std::uint64_t segmentBytes; // header + columns + alignment padding
+            std::uint64_t gradesOffset; // from the start of the segment
+            std::uint64_t nameEndsOffset;
+            std::uint64_t namesOffset;
+            std::uint32_t dataChecksum;   // CRC-32 of the columns
+            std::uint32_t headerChecksum; // CRC-32 of the bytes before this field
+        };
+        static_assert(sizeof(SegmentHeader) == 64, "SegmentHeader must stay 64 bytes");
+
+        inline std::uint32_t crc32(const void *data, std::size_t size, std::uint32_t crc = 0)
+        {
+            static const auto table = []
+            {
+                std::array<std::uint32_t, 256> entries{};
+                for (std::uint32_t i = 0; i < 256; ++i)
+                {
+                    std::uint32_t value = i;
+                    for (int bit = 0; bit < 8; ++bit)
+                        value = (value >> 1) ^ (0xEDB88320u & (0u - (value & 1u)));
+                    entries[i] = value;
+                }
+                return entries;
+            }();
+            const auto *bytes = static_cast<const unsigned char *>(data);
+            crc = ~crc;
+            for (std::size_t i = 0; i < size; ++i)
+                crc = table[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+            return ~crc;
+        }
+
+        constexpr std::uint64_t alignUp(std::uint64_t value) { return (value + alignment - 1) / alignment * alignment; }
+    }
+
+    // Appends StudentTables to a file as new segments
+    class StudentFileWriter
+    {
+    public:
+        // Creates the file, or continues after the committed end of an existing one
+        explicit StudentFileWriter(const std::string &path, bool syncEachAppend = false)
+            : fd_(::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644)), syncEachAppend_(syncEachAppend)
+        {
+            if (fd_.get() < 0)
+                throw std::system_error(errno, std::generic_category(), "StudentFileWriter: cannot open " + path);
+
+            if (::pread(fd_.get(), &header_, sizeof(header_), 0) == static_cast<ssize_t>(sizeof(header_)))
+            {
+                if (!validHeader(header_))
+                    throw std::runtime_error("StudentFileWriter: " + path + " is not a version 1 student file");
+            }
+            else
+            {
+                header_ = format::FileHeader{};
+                std::memcpy(header_.magic, format::fileMagic, sizeof(header_.magic));
+                header_.version = format::version;
+                header_.headerBytes = sizeof(format::FileHeader);
+                header_.committedBytes = sizeof(format::FileHeader);
+                writeHeader();
+            }
+        }
+
+        StudentFileWriter(const StudentFileWriter &) = delete;
+        StudentFileWriter &operator=(const StudentFileWriter &) = delete;
+
+        void append(const StudentTable &table)
+        {
+            if (table.empty())
+                return;
+
+            const std::uint64_t rows = table.size();
+            format::SegmentHeader segment{};
+            std::memcpy(segment.magic, format::segmentMagic, sizeof(segment.magic));
+            segment.rows = rows;
+            segment.nameBytes = table.nameArena().size();
+            segment.gradesOffset = format::alignUp(sizeof(segment) + rows * sizeof(std::int32_t));
+            segment.nameEndsOffset = format::alignUp(segment.gradesOffset + rows);
+            segment.namesOffset = format::alignUp(segment.nameEndsOffset + rows * sizeof(std::uint32_t));
+            segment.segmentBytes = format::alignUp(segment.namesOffset + segment.nameBytes);
+
+            // Build the segment in memory, then write it with a single pwrite()
+            const std::size_t segmentBytes = static_cast<std::size_t>(segment.segmentBytes);
+            std::unique_ptr<char[]> bytes(new char[segmentBytes]()); // zeroed padding
+            char *data = bytes.get();
+            std::memcpy(data + sizeof(segment), table.ages().data(), rows * sizeof(std::int32_t));
+            std::memcpy(data + segment.gradesOffset, table.grades().data(), rows);
+            std::memcpy(data + segment.nameEndsOffset, table.nameEnds().data() + 1, rows * sizeof(std::uint32_t));
+            std::memcpy(data + segment.namesOffset, table.nameArena().data(), segment.nameBytes);
+            segment.dataChecksum = format::crc32(data + sizeof(segment), segmentBytes - sizeof(segment));
+            segment.headerChecksum = format::crc32(&segment, offsetof(format::SegmentHeader, headerChecksum));
+            std::memcpy(data, &segment, sizeof(segment));
+
+            writeAt(data, segmentBytes, header_.committedBytes);
+            if (syncEachAppend_ && ::fdatasync(fd_.get()) != 0)
+                throw std::system_error(errno, std::generic_category(), "StudentFileWriter: fdatasync failed");
+
+            // Commit: only now does the header point past the new segment
+            header_.segmentCount += 1;
+            header_.rowCount += rows;
+            header_.committedBytes += segment.segmentBytes;
+            writeHeader();
+            if (syncEachAppend_ && ::fdatasync(fd_.get()) != 0)
+                throw std::system_error(errno, std::generic_category(), "StudentFileWriter: fdatasync failed");
+        }
+
+        std::uint64_t rows() const { return header_.rowCount; }
+
+        static bool validHeader(const format::FileHeader &header)
+        {
+            return std::memcmp(header.magic, format::fileMagic, sizeof(header.magic)) == 0 &&
+                   header.version == format::version &&
+                   header.headerBytes == sizeof(format::FileHeader) &&
+                   header.checksum == format::crc32(&header, offsetof(format::FileHeader, checksum));
+        }
+
+    private:
+        // Closes the file however the writer goes away, including a constructor that throws
+        class Descriptor
+        {
+        public:
+            explicit Descriptor(int fd) : fd_(fd) {}
+            Descriptor(const Descriptor &) = delete;
+            Descriptor &operator=(const Descriptor &) = delete;
+            ~Descriptor()
+            {
+                if (fd_ >= 0)
+                    ::close(fd_);
+            }
+
+            int get() const { return fd_; }
+
+        private:
+            int fd_;
+        };
+
+        void writeHeader()
+        {
+            header_.checksum = format::crc32(&header_, offsetof(format::FileHeader, checksum));
+            writeAt(&header_, sizeof(header_), 0);
+        }
+
+        void writeAt(const void *data, std::size_t size, std::uint64_t offset)
+        {
+            const char *bytes = static_cast<const char *>(data);
+            while (size > 0)
+            {
+                ssize_t written = ::pwrite(fd_.get(), bytes, size, static_cast<off_t>(offset));
+                if (written < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    throw std::system_error(errno, std::generic_category(), "StudentFileWriter: pwrite failed");
+                }
+                bytes += written;
+                size -= static_cast<std::size_t>(written);
+                offset += static_cast<std::uint64_t>(written);
+            }
+        }
+
+        Descriptor fd_;
+        bool syncEachAppend_;
+        format::FileHeader header_{};
+    };
+
+    // A read-only, memory-mapped student file, queried in place
+    class StudentFile
+    {
+    public:
+        struct Segment
+        {
+            std::uint64_t firstRow;
+            std::size_t rows;
+            const std::int32_t *ages;
+            const char *grades;
+            const std::uint32_t *nameEnds;
+            const char *names;
+            const format::SegmentHeader *header;
+        };
+
+        explicit StudentFile(const std::string &path)
+        {
+            int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0)
+                throw std::system_error(errno, std::generic_category(), "StudentFile: cannot open " + path);
+            struct stat info;
+            if (::fstat(fd, &info) != 0)
+            {
+                int error = errno;
+                ::close(fd);
+                throw std::system_error(error, std::generic_category(), "StudentFile: fstat failed");
+            }
+            size_ = static_cast<std::size_t>(info.st_size);
+            if (size_ < sizeof(format::FileHeader))
+            {
+                ::close(fd);
+                throw std::runtime_error("StudentFile: " + path + " is too small");
+            }
+            void *mapping = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+            ::close(fd); // the mapping keeps the file alive
+            if (mapping == MAP_FAILED)
+                throw std::system_error(errno, std::generic_category(), "StudentFile: mmap failed");
+            base_ = static_cast<const char *>(mapping);
+
+            try
+            {
+                indexSegments(path);
+            }
+            catch (...)
+            {
+                ::munmap(const_cast<char *>(base_), size_);
+                throw;
+            }
+        }
+
+        StudentFile(const StudentFile &) = delete;
+        StudentFile &operator=(const StudentFile &) = delete;
+
+        ~StudentFile() { ::munmap(const_cast<char *>(base_), size_); }
+
+        std::uint64_t size() const { return header().rowCount; }
+        const std::vector<Segment> &segments() const { return segments_; }
+
+        const format::FileHeader &header() const { return *reinterpret_cast<const format::FileHeader *>(base_); }
+
+        // Reads the columns of every segment and compares them against their checksums
+        bool verify() const
+        {
+            for (const Segment &segment : segments_)
+            {
+                const char *data = reinterpret_cast<const char *>(segment.header) + sizeof(format::SegmentHeader);
+                if (format::crc32(data, segment.header->segmentBytes - sizeof(format::SegmentHeader)) != segment.header->dataChecksum)
+                    return false;
+            }
+            return true;
+        }
+
+        // The row as the tuple from tuple.cpp, with the name pointing into the mapping
+        std::tuple<std::string_view, int, char> row(std::uint64_t index) const
+        {
+            if (index >= size())
+                throw std::out_of_range("StudentFile: row out of range");
+            auto next = std::upper_bound(segments_.begin(), segments_.end(), index, [](std::uint64_t row, const Segment &segment)
+                                         { return row < segment.firstRow; });
+            const Segment &segment = *(next - 1);
+            std::size_t local = static_cast<std::size_t>(index - segment.firstRow);
+            std::uint32_t begin = local == 0 ? 0 : segment.nameEnds[local - 1];
+            // Name offsets are only covered by verify(), so check them before use
+            if (segment.nameEnds[local] < begin || segment.nameEnds[local] > segment.header->nameBytes)
+                throw std::runtime_error("StudentFile: corrupt name offsets in row " + std::to_string(index));
+            return {std::string_view(segment.names + begin, segment.nameEnds[local] - begin),
+                    segment.ages[local], segment.grades[local]};
+        }
+
+        std::size_t count(char wantedGrade, int olderThan) const
+        {
+            std::size_t total = 0;
+            std::vector<std::uint64_t> mask;
+            for (const Segment &segment : segments_)
+            {
+                mask.assign((segment.rows + 63) / 64, 0);
+                matchRows(segment.grades, segment.ages, segment.rows, wantedGrade, olderThan, mask.data());
+                for (std::uint64_t word : mask)
+                    total += static_cast<std::size_t>(__builtin_popcountll(word));
+            }
+            return total;
+        }
+
+        std::vector<std::uint64_t> select(char wantedGrade, int olderThan) const
+        {
+            std::vector<std::uint64_t> rows;
+            std::vector<std::uint64_t> mask;
+            for (const Segment &segment : segments_)
+            {
+                mask.assign((segment.rows + 63) / 64, 0);
+                matchRows(segment.grades, segment.ages, segment.rows, wantedGrade, olderThan, mask.data());
+                for (std::size_t word = 0; word < mask.size(); ++word)
+                {
+                    for (std::uint64_t bits = mask[word]; bits != 0; bits &= bits - 1)
+                        rows.push_back(segment.firstRow + word * 64 + static_cast<std::uint64_t>(__builtin_ctzll(bits)));
+                }
+            }
+            return rows;
+        }
+
+        // Copies everything into an in-memory table (the deserializing path the format avoids)
+        StudentTable toTable() const
+        {
+            StudentTable table;
+            table.reserve(static_cast<std::size_t>(size()));
+            for (std::uint64_t i = 0; i < size(); ++i)
+            {
+                auto [name, age, grade] = row(i);
+                table.push_back(name, age, grade);
+            }
+            return table;
+        }
+
+    private:
+        void indexSegments(const std::string &path)
+        {
+            const format::FileHeader &file = header();
+            if (!StudentFileWriter::validHeader(file) || file.committedBytes < sizeof(format::FileHeader) ||
+                file.committedBytes > size_)
+                throw std::runtime_error("StudentFile: " + path + " has a bad or unsupported header");
+
+            std::uint64_t offset = sizeof(format::FileHeader);
+            std::uint64_t firstRow = 0;
+            for (std::uint64_t s = 0; s < file.segmentCount; ++s)
+            {
+                if (!fits(offset, sizeof(format::SegmentHeader), file.committedBytes))
+                    throw std::runtime_error("StudentFile: " + path + " is truncated");
+                const auto *segment = reinterpret_cast<const format::SegmentHeader *>(base_ + offset);
+                if (std::memcmp(segment->magic, format::segmentMagic, sizeof(segment->magic)) != 0 ||
+                    segment->headerChecksum != format::crc32(segment, offsetof(format::SegmentHeader, headerChecksum)) ||
+                    !validLayout(*segment) || !fits(offset, segment->segmentBytes, file.committedBytes))
+                    throw std::runtime_error("StudentFile: " + path + " has a corrupt segment header");
+
+                const char *start = base_ + offset;
+                segments_.push_back({firstRow, static_cast<std::size_t>(segment->rows),
+                                     reinterpret_cast<const std::int32_t *>(start + sizeof(format::SegmentHeader)),
+                                     start + segment->gradesOffset,
+                                     reinterpret_cast<const std::uint32_t *>(start + segment->nameEndsOffset),
+                                     start + segment->namesOffset,
+                                     segment});
+                firstRow += segment->rows;
+                offset += segment->segmentBytes;
+            }
+            if (firstRow != file.rowCount)
+                throw std::runtime_error("StudentFile: " + path + " row count does not match its segments");
+        }
+
+        // [begin, begin + bytes) lies within [0, end), without overflowing
+        static bool fits(std::uint64_t begin, std::uint64_t bytes, std::uint64_t end)
+        {
+            return begin <= end && bytes <= end - begin;
+        }
+
+        // The columns follow one another inside the segment, in order and suitably aligned.
+        // A checksummed header can still come from a buggy or hostile writer, and every
+        // pointer into the mapping is derived from these fields.
+        static bool validLayout(const format::SegmentHeader &segment)
+        {
+            const std::uint64_t bytes = segment.segmentBytes;
+            if (bytes < sizeof(format::SegmentHeader) || bytes % format::alignment != 0 || segment.rows > bytes)
+                return false;
+            const std::uint64_t rows = segment.rows;
+            return fits(sizeof(format::SegmentHeader), rows * sizeof(std::int32_t), segment.gradesOffset) &&
+                   fits(segment.gradesOffset, rows, segment.nameEndsOffset) &&
+                   segment.nameEndsOffset % alignof(std::uint32_t) == 0 &&
+                   fits(segment.nameEndsOffset, rows * sizeof(std::uint32_t), segment.namesOffset) &&
+                   fits(segment.namesOffset, segment.nameBytes, bytes);
+        }
+
+        const char *base_ = nullptr;
+        std::size_t size_ = 0;
+        std::vector<Segment> segments_;
+    };
+}
@@ -0,0 +1,113 @@
+#include "studentFile.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+/*
+ *   Open-to-first-query time: parsing the CSV text vs mapping the binary student file
+ *   The first query is count(grade == 'A' && age > 21).
+ *
+ *   cold: the file's pages are evicted with posix_fadvise(DONTNEED) before opening
+ *   warm: the file was just read and is still in the page cache
+ *
+ *   g++ -std=c++17 -O2 studentFileBenchmark.cpp -o studentFileBenchmark
+ *   ./studentFileBenchmark [rows]
+ */
+
+using students::StudentFile;
+using students::StudentFileWriter;
+using students::StudentTable;
+using Clock = std::chrono::steady_clock;
+
+void evict(const std::string &path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return;
+    ::fdatasync(fd); // dirty pages cannot be dropped
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    ::close(fd);
+}
+
+template <typename OpenAndQuery>
+double timeMs(OpenAndQuery openAndQuery)
+{
+    auto start = Clock::now();
+    openAndQuery();
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+int main(int argc, char **argv)
+{
+    std::size_t rows = argc > 1 ? std::stoul(argv[1]) : 10000000;
+    const std::string csvPath = "students_bench.csv";
+    const std::string binPath = "students_bench.stu";
+
+    static const char *firstNames[] = {"ahmed", "sara", "omar", "mona", "youssef", "laila", "karim", "nour"};
+    std::mt19937 rng(7);
+    StudentTable table;
+    table.reserve(rows, rows * 12);
+    for (std::size_t i = 0; i < rows; ++i)
+        table.push_back(std::string(firstNames[rng() % 8]) + "_" + std::to_string(i), 17 + static_cast<int>(rng() % 14), "ABCDF"[rng() % 5]);
+
+    {
+        std::ofstream csv(csvPath);
+        table.writeCsv(csv);
+    }
+    std::remove(binPath.c_str());
+    {
+        // Two appends, to exercise a multi-segment file
+        StudentTable first, second;
+        for (std::size_t i = 0; i < rows; ++i)
+        {
+            auto [name, age, grade] = table[i];
+            (i < rows / 2 ? first : second).push_back(name, age, grade);
+        }
+        StudentFileWriter writer(binPath, true);
+        writer.append(first);
+        writer.append(second);
+    }
+
+    std::size_t expected = table.count('A', 21);
+    std::printf("%zu rows, expected count %zu\n", rows, expected);
+
+    for (const char *mode : {"cold", "warm"})
+    {
+        bool cold = std::string(mode) == "cold";
+        std::size_t csvCount = 0, binCount = 0;
+
+        if (cold)
+            evict(csvPath);
+        double csvMs = timeMs([&]
+                              { csvCount = StudentTable::loadCsv(csvPath).count('A', 21); });
+
+        if (cold)
+            evict(binPath);
+        double binMs = timeMs([&]
+                              {
+            StudentFile file(binPath);
+            binCount = file.count('A', 21); });
+
+        std::printf("%s: parse CSV %8.1f ms   map binary %8.1f ms   (%.0fx)  [%s]\n",
+                    mode, csvMs, binMs, csvMs / binMs,
+                    csvCount == expected && binCount == expected ? "counts match" : "MISMATCH");
+    }
+
+    {
+        StudentFile file(binPath);
+        auto [name, age, grade] = file.row(rows - 1);
+        std::cout << "segments: " << file.segments().size() << ", checksums " << (file.verify() ? "ok" : "BAD")
+                  << ", last row: " << name << ", " << age << ", " << grade << std::endl;
+    }
+
+    std::remove(csvPath.c_str());
+    std::remove(binPath.c_str());
+    return 0;
+}
@@ -0,0 +1,311 @@
+#pragma once
+
+#include <charconv>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/*
+ *   StudentTable: the Student tuple from tuple.cpp stored as columns
+ *
+ *   std::vector<Student> keeps a 32-byte std::string, an int and a char (plus padding) per
+ *   row, so a scan over the grades drags every name through the cache. Here each field
+ *   is its own contiguous column:
+ *
+ *       ages_       int per row
+ *       grades_     char per row
+ *       names_      every name back to back in one string (the arena)
+ *       nameEnds_   end offset of each name in the arena (a name starts where the previous ends)
+ *
+ *   Rows are read through StudentRow, which supports get<I>, get<T> and structured
+ *   bindings just like the tuple (names come back as std::string_view).
+ */
+
+namespace students
+{
+    using Student = std::tuple<std::string, int, char>; // same schema as tuple.cpp
+
+    // grade == wantedGrade && age > olderThan over raw columns, 16 rows per step.
+    // Sets bit i of mask[i / 64] for every matching row; mask must hold (rows + 63) / 64 zeroed words.
+    inline void matchRows(const char *grades, const int *ages, std::size_t rows,
+                          char wantedGrade, int olderThan, std::uint64_t *mask)
+    {
+        std::size_t i = 0;
+#if defined(__SSE2__)
+        const __m128i gradeKey = _mm_set1_epi8(wantedGrade);
+        const __m128i ageKey = _mm_set1_epi32(olderThan);
+        for (; i + 16 <= rows; i += 16)
+        {
+            __m128i gradeHit = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(grades + i)), gradeKey);
+
+            const __m128i *block = reinterpret_cast<const __m128i *>(ages + i);
+            __m128i age0 = _mm_cmpgt_epi32(_mm_loadu_si128(block + 0), ageKey);
+            __m128i age1 = _mm_cmpgt_epi32(_mm_loadu_si128(block + 1), ageKey);
+            __m128i age2 = _mm_cmpgt_epi32(_mm_loadu_si128(block + 2), ageKey);
+            __m128i age3 = _mm_cmpgt_epi32(_mm_loadu_si128(block + 3), ageKey);
+            // 0 / -1 lanes survive signed saturation: narrow 4 x 4 ints to 16 bytes
+            __m128i ageHit = _mm_packs_epi16(_mm_packs_epi32(age0, age1), _mm_packs_epi32(age2, age3));
+
+            auto bits = static_cast<std::uint64_t>(_mm_movemask_epi8(_mm_and_si128(gradeHit, ageHit)));
+            mask[i / 64] |= bits << (i % 64);
+        }
+#endif
+        for (; i < rows; ++i)
+        {
+            std::uint64_t hit = (grades[i] == wantedGrade) & (ages[i] > olderThan);
+            mask[i / 64] |= hit << (i % 64);
+        }
+    }
+
+    class StudentTable;
+
+    // A lightweight view of one row, valid as long as the table is not modified
+    class StudentRow
+    {
+    public:
+        StudentRow(const StudentTable &table, std::size_t index) : table_(&table), index_(index) {}
+
+        std::string_view name() const;
+        int age() const;
+        char grade() const;
+
+        template <std::size_t I>
+        auto get() const
+        {
+            static_assert(I < 3, "Student has three fields");
+            if constexpr (I == 0)
+                return name();
+            else if constexpr (I == 1)
+                return age();
+            else
+                return grade();
+        }
+
+        Student toStudent() const { return Student{std::string(name()), age(), grade()}; }
+
+    private:
+        const StudentTable *table_;
+        std::size_t index_;
+    };
+
+    class StudentTable
+    {
+    public:
+        // Bit i of word i / 64 is set when row i matches
+        using Bitmask = std::vector<std::uint64_t>;
+
+        StudentTable() { nameEnds_.push_back(0); }
+
+        void reserve(std::size_t rows, std::size_t nameBytes = 0)
+        {
+            ages_.reserve(rows);
+            grades_.reserve(rows);
+            nameEnds_.reserve(rows + 1);
+            names_.reserve(nameBytes);
+        }
+
+        void push_back(std::string_view name, int age, char grade)
+        {
+            if (names_.size() + name.size() > std::numeric_limits<std::uint32_t>::max())
+                throw std::length_error("StudentTable: name arena is full");
+            names_.append(name);
+            nameEnds_.push_back(static_cast<std::uint32_t>(names_.size()));
+            ages_.push_back(age);
+            grades_.push_back(grade);
+        }
+
+        void push_back(const Student &student)
+        {
+            push_back(std::get<std::string>(student), std::get<int>(student), std::get<char>(student));
+        }
+
+        std::size_t size() const { return ages_.size(); }
+        bool empty() const { return ages_.empty(); }
+
+        StudentRow operator[](std::size_t index) const { return StudentRow(*this, index); }
+
+        StudentRow at(std::size_t index) const
+        {
+            if (index >= size())
+                throw std::out_of_range("StudentTable: row out of range");
+            return StudentRow(*this, index);
+        }
+
+        std::string_view name(std::size_t index) const
+        {
+            return std::string_view(names_).substr(nameEnds_[index], nameEnds_[index + 1] - nameEnds_[index]);
+        }
+
+        // Raw columns, for scans written outside the table
+        const std::vector<int> &ages() const { return ages_; }
+        const std::vector<char> &grades() const { return grades_; }
+        const std::string &nameArena() const { return names_; }
+        const std::vector<std::uint32_t> &nameEnds() const { return nameEnds_; }
+
+        std::size_t memoryBytes() const
+        {
+            return ages_.capacity() * sizeof(int) + grades_.capacity() + names_.capacity() +
+                   nameEnds_.capacity() * sizeof(std::uint32_t);
+        }
+
+        // CSV rows are "name,age,grade"; a first line that is not a row (a header) is skipped
+        static StudentTable fromCsv(std::string_view text)
+        {
+            StudentTable table;
+            table.reserve(text.size() / 16, text.size() / 2);
+
+            std::size_t lineNumber = 0;
+            while (!text.empty())
+            {
+                std::size_t end = text.find('\n');
+                std::string_view line = text.substr(0, end);
+                text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+                ++lineNumber;
+                if (!line.empty() && line.back() == '\r')
+                    line.remove_suffix(1);
+                if (line.empty())
+                    continue;
+
+                std::size_t firstComma = line.find(',');
+                std::size_t lastComma = line.rfind(',');
+                int age = 0;
+                bool valid = firstComma != lastComma && lastComma + 2 == line.size();
+                if (valid)
+                {
+                    auto [ptr, ec] = std::from_chars(line.data() + firstComma + 1, line.data() + lastComma, age);
+                    valid = ec == std::errc() && ptr == line.data() + lastComma;
+                }
+                if (!valid)
+                {
+                    if (lineNumber == 1)
+                        continue; // header
+                    throw std::runtime_error("StudentTable: malformed CSV line " + std::to_string(lineNumber));
+                }
+                table.push_back(line.substr(0, firstComma), age, line.back());
+            }
+            return table;
+        }
+
+        static StudentTable loadCsv(const std::string &path)
+        {
+            std::ifstream file(path, std::ios::binary);
+            if (!file.is_open())
+                throw std::runtime_error("StudentTable: cannot open " + path);
+            std::string text;
+            file.seekg(0, std::ios::end);
+            text.resize(static_cast<std::size_t>(file.tellg()));
+            file.seekg(0);
+            file.read(text.data(), static_cast<std::streamsize>(text.size()));
+            return fromCsv(text);
+        }
+
+        void writeCsv(std::ostream &out) const
+        {
+            out << "name,age,grade\n";
+            for (std::size_t i = 0; i < size(); ++i)
+                out << name(i) << ',' << ages_[i] << ',' << grades_[i] << '\n';
+        }
+
+        Bitmask match(char wantedGrade, int olderThan) const
+        {
+            Bitmask mask((size() + 63) / 64, 0);
+            matchRows(grades_.data(), ages_.data(), size(), wantedGrade, olderThan, mask.data());
+            return mask;
+        }
+
+        std::size_t count(char wantedGrade, int olderThan) const
+        {
+            std::size_t total = 0;
+            for (std::uint64_t word : match(wantedGrade, olderThan))
+                total += static_cast<std::size_t>(__builtin_popcountll(word));
+            return total;
+        }
+
+        // Row indices of the matches, in order (a selection vector)
+        std::vector<std::uint32_t> select(char wantedGrade, int olderThan) const
+        {
+            return selection(match(wantedGrade, olderThan));
+        }
+
+        static std::vector<std::uint32_t> selection(const Bitmask &mask)
+        {
+            std::vector<std::uint32_t> rows;
+            for (std::size_t word = 0; word < mask.size(); ++word)
+            {
+                for (std::uint64_t bits = mask[word]; bits != 0; bits &= bits - 1)
+                    rows.push_back(static_cast<std::uint32_t>(word * 64 + static_cast<std::size_t>(__builtin_ctzll(bits))));
+            }
+            return rows;
+        }
+
+        // Plain reductions over one column; the loops are simple enough for the auto-vectorizer
+        long long sumAges() const
+        {
+            long long total = 0;
+            for (int age : ages_)
+                total += age;
+            return total;
+        }
+
+        std::size_t countGrade(char wantedGrade) const
+        {
+            std::size_t total = 0;
+            for (char grade : grades_)
+                total += grade == wantedGrade;
+            return total;
+        }
+
+    private:
+        friend class StudentRow;
+
+        std::vector<int> ages_;
+        std::vector<char> grades_;
+        std::string names_;
+        std::vector<std::uint32_t> nameEnds_;
+    };
+
+    inline std::string_view StudentRow::name() const { return table_->name(index_); }
+    inline int StudentRow::age() const { return table_->ages_[index_]; }
+    inline char StudentRow::grade() const { return table_->grades_[index_]; }
+
+    // Free get<> so that rows read like the tuple: get<1>(row), get<int>(row), get<std::string>(row)
+    template <std::size_t I>
+    auto get(const StudentRow &row) { return row.get<I>(); }
+
+    template <typename T>
+    auto get(const StudentRow &row)
+    {
+        if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view>)
+            return row.get<0>();
+        else if constexpr (std::is_same_v<T, int>)
+            return row.get<1>();
+        else
+        {
+            static_assert(std::is_same_v<T, char>, "Student fields are std::string, int and char");
+            return row.get<2>();
+        }
+    }
+}
+
+// Structured bindings: auto [name, age, grade] = table[i];
+template <>
+struct std::tuple_size<students::StudentRow> : std::integral_constant<std::size_t, 3>
+{
+};
+
+template <std::size_t I>
+struct std::tuple_element<I, students::StudentRow>
+{
+    using type = decltype(std::declval<students::StudentRow>().get<I>());
+};
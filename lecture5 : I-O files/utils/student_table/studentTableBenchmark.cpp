@@ -0,0 +1,142 @@
+#include "studentTable.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/*
+ *   std::vector<Student> vs students::StudentTable
+ *   Scan: grade == 'A' && age > 21 (count and selection), sum of ages, CSV loading
+ *
+ *   g++ -std=c++17 -O2 studentTableBenchmark.cpp -o studentTableBenchmark
+ *   ./studentTableBenchmark [rows]
+ */
+
+using students::Student;
+using students::StudentTable;
+using Clock = std::chrono::steady_clock;
+
+template <typename Work>
+double bestOfMs(int repeats, Work work)
+{
+    double best = 1e300;
+    for (int r = 0; r < repeats; ++r)
+    {
+        auto start = Clock::now();
+        work();
+        best = std::min(best, std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+    }
+    return best;
+}
+
+std::vector<Student> makeStudents(std::size_t rows)
+{
+    static const char *firstNames[] = {"ahmed", "sara", "omar", "mona", "youssef", "laila", "karim", "nour"};
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> age(17, 30);
+    std::uniform_int_distribution<int> grade(0, 4);
+    std::uniform_int_distribution<int> name(0, 7);
+
+    std::vector<Student> students;
+    students.reserve(rows);
+    for (std::size_t i = 0; i < rows; ++i)
+        students.emplace_back(std::string(firstNames[name(rng)]) + "_" + std::to_string(i), age(rng), "ABCDF"[grade(rng)]);
+    return students;
+}
+
+int main(int argc, char **argv)
+{
+    std::size_t rows = argc > 1 ? std::stoul(argv[1]) : 10000000;
+    const char wanted = 'A';
+    const int olderThan = 21;
+
+    std::vector<Student> rowsVector = makeStudents(rows);
+    StudentTable table;
+    table.reserve(rows, rows * 12);
+    for (const auto &student : rowsVector)
+        table.push_back(student);
+
+    std::size_t vectorBytes = rowsVector.capacity() * sizeof(Student);
+    for (const auto &student : rowsVector)
+    {
+        const std::string &name = std::get<std::string>(student);
+        if (name.capacity() > 15) // longer than the small string buffer: heap allocated
+            vectorBytes += name.capacity() + 1;
+    }
+    std::printf("%zu rows: vector<Student> %.1f MB, StudentTable %.1f MB\n",
+                rows, vectorBytes / 1e6, table.memoryBytes() / 1e6);
+
+    std::size_t vectorCount = 0, tableCount = 0;
+    double vectorScan = bestOfMs(5, [&]
+                                 {
+        vectorCount = 0;
+        for (const auto &student : rowsVector)
+            vectorCount += std::get<char>(student) == wanted && std::get<int>(student) > olderThan; });
+    double tableScan = bestOfMs(5, [&]
+                                { tableCount = table.count(wanted, olderThan); });
+    std::printf("count  grade == 'A' && age > 21: vector %7.2f ms  table %7.2f ms  (%.1fx)  [%zu == %zu]\n",
+                vectorScan, tableScan, vectorScan / tableScan, vectorCount, tableCount);
+
+    std::vector<std::uint32_t> vectorSelection, tableSelection;
+    double vectorSelect = bestOfMs(5, [&]
+                                   {
+        vectorSelection.clear();
+        for (std::size_t i = 0; i < rowsVector.size(); ++i)
+            if (std::get<char>(rowsVector[i]) == wanted && std::get<int>(rowsVector[i]) > olderThan)
+                vectorSelection.push_back(static_cast<std::uint32_t>(i)); });
+    double tableSelect = bestOfMs(5, [&]
+                                  { tableSelection = table.select(wanted, olderThan); });
+    std::printf("select grade == 'A' && age > 21: vector %7.2f ms  table %7.2f ms  (%.1fx)  [%s]\n",
+                vectorSelect, tableSelect, vectorSelect / tableSelect,
+                vectorSelection == tableSelection ? "same rows" : "MISMATCH");
+
+    long long vectorSum = 0, tableSum = 0;
+    double vectorAges = bestOfMs(5, [&]
+                                 {
+        vectorSum = 0;
+        for (const auto &student : rowsVector)
+            vectorSum += std::get<int>(student); });
+    double tableAges = bestOfMs(5, [&]
+                                { tableSum = table.sumAges(); });
+    std::printf("sum of ages:                     vector %7.2f ms  table %7.2f ms  (%.1fx)  [%lld == %lld]\n",
+                vectorAges, tableAges, vectorAges / tableAges, vectorSum, tableSum);
+
+    // CSV loading: getline + stream parsing into tuples vs StudentTable::loadCsv
+    const std::string path = "students_bench.csv";
+    {
+        std::ofstream csv(path);
+        table.writeCsv(csv);
+    }
+    std::vector<Student> loadedVector;
+    double vectorLoad = bestOfMs(1, [&]
+                                 {
+        std::ifstream csv(path);
+        std::string line;
+        std::getline(csv, line); // header
+        while (std::getline(csv, line))
+        {
+            std::istringstream fields(line);
+            std::string name, age, grade;
+            std::getline(fields, name, ',');
+            std::getline(fields, age, ',');
+            std::getline(fields, grade);
+            loadedVector.emplace_back(name, std::stoi(age), grade[0]);
+        } });
+    StudentTable loadedTable;
+    double tableLoad = bestOfMs(1, [&]
+                                { loadedTable = StudentTable::loadCsv(path); });
+    std::printf("load CSV:                        vector %7.0f ms  table %7.0f ms  (%.1fx)  [%zu == %zu rows]\n",
+                vectorLoad, tableLoad, vectorLoad / tableLoad, loadedVector.size(), loadedTable.size());
+    std::remove(path.c_str());
+
+    // Row access reads like the tuple
+    auto [name, age, grade] = table[0];
+    std::cout << "row 0: " << name << ", " << age << ", " << grade
+              << " (get<int>: " << students::get<int>(table[0]) << ")" << std::endl;
+    return 0;
+}